@@ -7,6 +7,7 @@
 #include "GL/v3d_gpucolorflow.h"
 
 #include <iostream>
+#include <algorithm>
 
 #include <GL/glew.h>
 #ifdef __APPLE__
@@ -36,10 +37,13 @@ int const startLevel = 0;
 int       nIterations = 200;
 int const nOuterIterations = 4;
 float const lambdaScale = 1.0;
+int const warmStartLevel = 2; // Finest level at which an initial flow replaces the coarser levels.
 
 Image<unsigned char> leftImage, rightImage;
 Image<float> leftImageLab, rightImageLab;
 const char *outputFile;
+FlowField_sV *initialFlow = NULL;
+int initialFlowLevel = warmStartLevel;
 
 float lambda = 1.0f;
 
@@ -61,6 +65,31 @@ PyramidWithDerivativesCreator leftPyrG(false, pyrTexSpec), rightPyrG(false, pyrT
 PyramidWithDerivativesCreator leftPyrB(false, pyrTexSpec), rightPyrB(false, pyrTexSpec);
 #endif
 
+// Bilinear resampling of a flow field to w x h, with the vectors scaled to the new size.
+FlowField_sV * resampleFlow(FlowField_sV const& flow, int w, int h)
+{
+  FlowField_sV *out = new FlowField_sV(w, h);
+  float const sx = float(flow.width()) / w;
+  float const sy = float(flow.height()) / h;
+
+  for (int y = 0; y < h; ++y)
+     for (int x = 0; x < w; ++x)
+     {
+        float const fx = std::max(0.0f, std::min((x+0.5f)*sx - 0.5f, float(flow.width()-1)));
+        float const fy = std::max(0.0f, std::min((y+0.5f)*sy - 0.5f, float(flow.height()-1)));
+        int const x0 = int(fx), y0 = int(fy);
+        int const x1 = std::min(x0+1, flow.width()-1);
+        int const y1 = std::min(y0+1, flow.height()-1);
+        float const ax = fx - x0, ay = fy - y0;
+
+        out->rx(x, y) = ((1-ax)*(1-ay)*flow.x(x0, y0) + ax*(1-ay)*flow.x(x1, y0)
+                         + (1-ax)*ay*flow.x(x0, y1) + ax*ay*flow.x(x1, y1)) / sx;
+        out->ry(x, y) = ((1-ax)*(1-ay)*flow.y(x0, y0) + ax*(1-ay)*flow.y(x1, y0)
+                         + (1-ax)*ay*flow.y(x0, y1) + ax*ay*flow.y(x1, y1)) / sy;
+     }
+  return out;
+} // end resampleFlow()
+
 #ifdef USE_LAB_COLORSPACE
 inline void convertRGBImageToCIELab(Image<unsigned char> const& src, Image<float>& dst)
 {
@@ -109,6 +138,9 @@ void drawscene()
     flowEstimator->setInnerIterations(nIterations);
     flowEstimator->setOuterIterations(nOuterIterations);
     flowEstimator->setStartLevel(startLevel);
+    if (initialFlow != NULL) {
+      flowEstimator->setInitialFlow(initialFlow->data(), initialFlowLevel);
+    }
   }
   {
     ScopedTimer st("allocating pyramids"); 
@@ -198,7 +230,7 @@ int main( int argc, char** argv)
 
    if ((argc-1) < 3) {
        std::cout << "Usage: " << argv[0] << " <left image> <right image> <outFilename> "
-               "[ <lambda=" << lambda << "> [<nIterations=" << nIterations << ">] ]" << std::endl;
+               "[ <lambda=" << lambda << "> [<nIterations=" << nIterations << "> [<initialFlow (any size)>] ] ]" << std::endl;
        return -1;
    }
    
@@ -217,6 +249,31 @@ int main( int argc, char** argv)
        }
    }
 
+   if ((argc-1) >= 6) {
+       ScopedTimer st("loading initial flow");
+       try {
+           initialFlow = FlowRW_sV::load(argv[6]);
+       } catch (FlowRW_sV::FlowRWError &err) {
+           std::cerr << "Could not load the initial flow: " << err.message << std::endl;
+           initialFlow = NULL;
+       }
+       int const w = leftImage.width();
+       int const h = leftImage.height();
+       if (initialFlow != NULL && (initialFlow->width() != w || initialFlow->height() != h)) {
+           // E.g. the flow built for the small frames. It carries no detail finer than
+           // its own resolution, so the levels above that are skipped.
+           int level = 0;
+           while (level+1 < nLevels && (initialFlow->width() << (level+1)) <= w) {
+               level++;
+           }
+           initialFlowLevel = std::max(level, warmStartLevel);
+
+           FlowField_sV *resampled = resampleFlow(*initialFlow, w, h);
+           delete initialFlow;
+           initialFlow = resampled;
+       }
+   }
+
    if (leftImage.numChannels() != 3 || rightImage.numChannels() != 3) {
         std::cout << "leftImage.numChannels() = " << leftImage.numChannels() << std::endl;
         std::cout << "rightImage.numChannels() = " << rightImage.numChannels() << std::endl;
@@ -0,0 +1,232 @@
+#include "config.h"
+
+#include "Base/v3d_cpupyramid.h"
+#include "Base/v3d_imageprocessing.h"
+
+using namespace std;
+
+namespace
+{
+
+   // Same kernels as the presmoothing options of the pyramid shaders.
+   vector<float>
+   preSmoothingKernel(int filter)
+   {
+      switch (filter)
+      {
+         case 1: return V3D::binomialKernel(2);
+         case 2: return V3D::binomialKernel(4);
+         case 3: return V3D::binomialKernel(6);
+         case 4:
+         {
+            vector<float> kernel(3);
+            kernel[0] = 1.0f/8; kernel[1] = 6.0f/8; kernel[2] = 1.0f/8;
+            return kernel;
+         }
+         default: return V3D::binomialKernel(0);
+      }
+   } // end preSmoothingKernel()
+
+   // Central differences with repeated border pixels: (I[x+1] - I[x-1]) / 2
+   void
+   computeDerivatives(float const * src, int w, int h, float * dx, float * dy)
+   {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (w*h >= 128*128)
+#endif
+      for (int y = 0; y < h; ++y)
+      {
+         float const * row = src + y*w;
+         float * dxRow = dx + y*w;
+         if (w == 1)
+            dxRow[0] = 0;
+         else
+         {
+            dxRow[0] = 0.5f * (row[1] - row[0]);
+            for (int x = 1; x < w-1; ++x)
+               dxRow[x] = 0.5f * (row[x+1] - row[x-1]);
+            dxRow[w-1] = 0.5f * (row[w-1] - row[w-2]);
+         }
+
+         float const * above = src + std::max(y-1, 0)*w;
+         float const * below = src + std::min(y+1, h-1)*w;
+         float * dyRow = dy + y*w;
+         for (int x = 0; x < w; ++x)
+            dyRow[x] = 0.5f * (below[x] - above[x]);
+      } // end for (y)
+   } // end computeDerivatives()
+
+   // Filters the columns with [1 3 3 1]/8 and keeps every second row.
+   // Output row j uses the input rows 2j-1 .. 2j+2.
+   void
+   decimateRows(float const * src, int w, int h, float * dst)
+   {
+      int const H = h/2;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (w*H >= 64*64)
+#endif
+      for (int j = 0; j < H; ++j)
+      {
+         float const * r0 = src + std::max(2*j-1, 0)*w;
+         float const * r1 = src + (2*j)*w;
+         float const * r2 = src + (2*j+1)*w;
+         float const * r3 = src + std::min(2*j+2, h-1)*w;
+         float * out = dst + j*w;
+         for (int x = 0; x < w; ++x)
+            out[x] = (r0[x] + 3*r1[x] + 3*r2[x] + r3[x]) * (1.0f/8);
+      } // end for (j)
+   } // end decimateRows()
+
+   inline float
+   decimatedPixelClamped(float const * row, int w, int i)
+   {
+      return (row[std::max(2*i-1, 0)] + 3*row[2*i] + 3*row[2*i+1] + row[std::min(2*i+2, w-1)]) * (1.0f/8);
+   }
+
+   // Filters the rows with [1 3 3 1]/8 and keeps every second column.
+   void
+   decimateColumns(float const * src, int w, int h, float * dst)
+   {
+      int const W = w/2;
+      // Output columns in [1, i1) have all four taps inside the row.
+      int const i1 = std::max(1, std::min(W, (w-1)/2));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (W*h >= 64*64)
+#endif
+      for (int y = 0; y < h; ++y)
+      {
+         float const * row = src + y*w;
+         float * out = dst + y*W;
+         if (W > 0)
+            out[0] = decimatedPixelClamped(row, w, 0);
+         for (int i = 1; i < i1; ++i)
+            out[i] = (row[2*i-1] + 3*row[2*i] + 3*row[2*i+1] + row[2*i+2]) * (1.0f/8);
+         for (int i = i1; i < W; ++i)
+            out[i] = decimatedPixelClamped(row, w, i);
+      } // end for (y)
+   } // end decimateColumns()
+
+} // end namespace <>
+
+//----------------------------------------------------------------------
+
+namespace V3D
+{
+
+   void
+   CPU_PyramidWithDerivativesCreator::allocate(int w, int h, int nLevels, int preSmoothingFilter, int nChannels)
+   {
+      verify(nLevels >= 1 && (w >> (nLevels-1)) >= 1 && (h >> (nLevels-1)) >= 1,
+             "image too small for the number of pyramid levels");
+
+      _width = w;
+      _height = h;
+      _nLevels = nLevels;
+      _nChannels = nChannels;
+      _preSmoothingFilter = preSmoothingFilter;
+
+      _levels.resize(nLevels);
+      for (int level = 0; level < nLevels; ++level)
+         _levels[level].resize(w >> level, h >> level, 3*nChannels);
+
+      _source.resize(w, h, nChannels);
+      _smoothed.resize(w, h, nChannels);
+      _filtered.resize(w, h, nChannels);
+      _tmp.resize(w, h/2, 1);
+   } // end CPU_PyramidWithDerivativesCreator::allocate()
+
+   void
+   CPU_PyramidWithDerivativesCreator::deallocate()
+   {
+      _levels.clear();
+      _source.resize(0, 0, 0);
+      _smoothed.resize(0, 0, 0);
+      _filtered.resize(0, 0, 0);
+      _tmp.resize(0, 0, 0);
+      _nLevels = 0;
+   }
+
+   void
+   CPU_PyramidWithDerivativesCreator::buildPyramidForGrayscaleImage(unsigned char const * image)
+   {
+      verify(_nChannels == 1, "pyramid was allocated for a colour image");
+      std::copy(image, image + _width*_height, _source.begin());
+      this->buildLevel0(_source);
+   }
+
+   void
+   CPU_PyramidWithDerivativesCreator::buildPyramidForGrayscaleImage(float const * image)
+   {
+      verify(_nChannels == 1, "pyramid was allocated for a colour image");
+      float * dst = _source.begin();
+      for (int i = 0; i < _width*_height; ++i)
+         dst[i] = 255.0f * image[i];
+      this->buildLevel0(_source);
+   }
+
+   void
+   CPU_PyramidWithDerivativesCreator::buildPyramidForImage(Image<unsigned char> const& image)
+   {
+      verify((int)image.width() == _width && (int)image.height() == _height &&
+             (int)image.numChannels() == _nChannels, "image does not match the allocated pyramid");
+      _source.copyFrom(image);
+      this->buildLevel0(_source);
+   }
+
+   void
+   CPU_PyramidWithDerivativesCreator::buildPyramidForImage(Image<float> const& image)
+   {
+      verify((int)image.width() == _width && (int)image.height() == _height &&
+             (int)image.numChannels() == _nChannels, "image does not match the allocated pyramid");
+      for (int c = 0; c < _nChannels; ++c)
+      {
+         float const * src = image.begin(c);
+         float * dst = _source.begin(c);
+         for (int i = 0; i < _width*_height; ++i)
+            dst[i] = 255.0f * src[i];
+      }
+      this->buildLevel0(_source);
+   }
+
+   void
+   CPU_PyramidWithDerivativesCreator::buildLevel0(Image<float> const& image)
+   {
+      Image<float>& pyr = _levels[0];
+
+      if (_preSmoothingFilter > 0)
+      {
+         vector<float> const kernel = preSmoothingKernel(_preSmoothingFilter);
+         separableFilterImage(image, kernel, kernel, _smoothed, _filtered);
+      }
+      else
+         _smoothed.copyFrom(image);
+
+      for (int c = 0; c < _nChannels; ++c)
+      {
+         std::copy(_smoothed.begin(c), _smoothed.end(c), pyr.begin(3*c));
+         computeDerivatives(_smoothed.begin(c), _width, _height, pyr.begin(3*c+1), pyr.begin(3*c+2));
+      }
+
+      for (int level = 1; level < _nLevels; ++level)
+         this->buildLevel(level);
+   } // end CPU_PyramidWithDerivativesCreator::buildLevel0()
+
+   void
+   CPU_PyramidWithDerivativesCreator::buildLevel(int level)
+   {
+      // Source dimensions.
+      int const W = _width >> (level-1);
+      int const H = _height >> (level-1);
+
+      Image<float> const& src = _levels[level-1];
+      Image<float>& dst = _levels[level];
+
+      // Vertical pass first, the horizontal pass then only runs on half the rows.
+      for (int plane = 0; plane < 3*_nChannels; ++plane)
+      {
+         decimateRows(src.begin(plane), W, H, _tmp.begin());
+         decimateColumns(_tmp.begin(), W, H/2, dst.begin(plane));
+      }
+   } // end CPU_PyramidWithDerivativesCreator::buildLevel()
+
+} // end namespace V3D
@@ -0,0 +1,73 @@
+// -*- C++ -*-
+
+#include "config.h"
+
+#ifndef V3D_CPU_PYRAMID_H
+#define V3D_CPU_PYRAMID_H
+
+#include "Base/v3d_image.h"
+
+#include <vector>
+
+namespace V3D
+{
+
+   // CPU counterpart of V3D_GPU::PyramidWithDerivativesCreator.
+   //
+   // Level 0 is the pre-smoothed input image (intensities in [0, 255]) with its
+   // central-difference derivatives; each further level is half the size of the
+   // previous one and is obtained by filtering intensity and derivatives with the
+   // binomial kernel [1 3 3 1]/8 and dropping every second row and column,
+   // like the GL shaders do. Borders are handled by repeating the edge pixels.
+   //
+   // Each level is stored as one planar image with 3 planes per input channel:
+   // plane 3*c is the intensity of channel c, 3*c+1 its x derivative and
+   // 3*c+2 its y derivative. All passes run along rows and are distributed over
+   // threads with OpenMP if it is enabled.
+   struct CPU_PyramidWithDerivativesCreator
+   {
+         CPU_PyramidWithDerivativesCreator()
+            : _width(0), _height(0), _nChannels(0), _nLevels(0), _preSmoothingFilter(0)
+         { }
+
+         ~CPU_PyramidWithDerivativesCreator() { }
+
+         int numberOfLevels() const { return _nLevels; }
+         int numberOfChannels() const { return _nChannels; }
+
+         // preSmoothingFilter selects the same kernels as the GPU version:
+         // 0: none, 1: [1 2 1]/4, 2: [1 4 6 4 1]/16, 3: [1 6 15 20 15 6 1]/64, 4: [1 6 1]/8
+         void allocate(int w, int h, int nLevels, int preSmoothingFilter = 0, int nChannels = 1);
+         void deallocate();
+
+         void buildPyramidForGrayscaleImage(unsigned char const * image);
+         // Float intensities are expected in [0, 1], like for the GPU version.
+         void buildPyramidForGrayscaleImage(float const * image);
+
+         // Planar colour images with numberOfChannels() channels.
+         void buildPyramidForImage(Image<unsigned char> const& image);
+         void buildPyramidForImage(Image<float> const& image);
+
+         Image<float> const& level(int level) const { return _levels[level]; }
+
+         int width(int level) const  { return _width >> level; }
+         int height(int level) const { return _height >> level; }
+
+         float const * intensity(int level, int channel = 0) const { return _levels[level].begin(3*channel); }
+         float const * gradientX(int level, int channel = 0) const { return _levels[level].begin(3*channel+1); }
+         float const * gradientY(int level, int channel = 0) const { return _levels[level].begin(3*channel+2); }
+
+      protected:
+         void buildLevel0(Image<float> const& image);
+         void buildLevel(int level);
+
+         int _width, _height, _nChannels, _nLevels;
+         int _preSmoothingFilter;
+
+         std::vector<Image<float> > _levels;
+         Image<float> _source, _smoothed, _filtered, _tmp;
+   }; // end struct CPU_PyramidWithDerivativesCreator
+
+} // end namespace V3D
+
+#endif
@@ -276,23 +276,161 @@ namespace V3D {
    }
 
 
+   // Binomial kernel with N+1 taps, normalized to a sum of 1.
+   inline std::vector<float>
+   binomialKernel(int N)
+   {
+      std::vector<float> kernel(N+1);
+      for (int i = 0; i <= N; ++i)
+         kernel[i] = (float)choose(N, i)/(float)(1<<N);
+      return kernel;
+   }
+
+   // Filters pixel x of a row of width w, using only the taps inside the row.
    template<typename Elem>
-   inline void binomialFilterImage( const Image<Elem> &im, int Nx, int Ny, Image<Elem> &out,
-                                    Image<Elem>& temp )
+   inline float
+   filterRowPixelClipped( Elem const * row, int w, int x, std::vector<float> const& kernel )
+   {
+      int const K = kernel.size();
+      int const left = K/2;
+      int const k0 = std::max(0, left - x);
+      int const k1 = std::min(K, w - x + left);
+      float sum = 0, denom = 0;
+      for (int k = k0; k < k1; ++k)
+      {
+         sum += kernel[k] * row[x - left + k];
+         denom += kernel[k];
+      }
+      return sum / denom;
+   }
+
+   // Convolves each row with a 1-D kernel; the kernel center is at kernel.size()/2
+   // like in convolveImage(). Near the borders, the kernel is cut off and the
+   // remaining weights are re-normalized, which gives the same result as
+   // convolveImage() with a 1-row kernel. Rows are processed in parallel if
+   // OpenMP is enabled; the inner loops run over contiguous memory without
+   // bounds checks, so the compiler can vectorize them.
+   template<typename Elem, typename Elem2>
+   inline void
+   filterImageRows( const Image<Elem> &im, std::vector<float> const& kernel, Image<Elem2> &out )
    {
-      // TODO:  Use factored binomial kernels for better speed.
-      Image<float> kernelX(Nx+1,1,im.numChannels());
-      Image<float> kernelY(1,Ny+1,im.numChannels());
-      int x,y,i;
-      for(i=0; i<im.numChannels(); i++)
+      int const w = im.width();
+      int const h = im.height();
+      int const nChannels = im.numChannels();
+      int const K = kernel.size();
+      int const left = K/2;           // Taps left of the center
+      int const right = K - 1 - left; // Taps right of the center
+
+      if (out.width() != im.width() || out.height() != im.height() || out.numChannels() != im.numChannels())
+         out.resize(w, h, nChannels);
+
+      // Pixels in [x0, x1) have all taps inside the image.
+      int const x0 = std::min(left, w);
+      int const x1 = std::max(x0, w - right);
+
+#ifdef _OPENMP
+#pragma omp parallel if (w*h*nChannels >= 128*128)
+#endif
       {
-         for(x=0; x<=Nx; x++)
-            kernelX(x,0,i) = (float)choose(Nx,x)/(float)(1<<Nx);
-         for(y=0; y<=Ny; y++)
-            kernelY(0,y,i) = (float)choose(Ny,y)/(float)(1<<Ny);
+         std::vector<float> acc(w);
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+         for (int row = 0; row < h*nChannels; ++row)
+         {
+            int const y = row % h;
+            int const ch = row / h;
+            Elem const * src = im.begin(ch) + y*w;
+            Elem2 * dst = out.begin(ch) + y*w;
+
+            // Interior
+            for (int x = x0; x < x1; ++x) acc[x] = 0;
+            for (int k = 0; k < K; ++k)
+            {
+               float const weight = kernel[k];
+               Elem const * s = src - left + k;
+               for (int x = x0; x < x1; ++x)
+                  acc[x] += weight * s[x];
+            }
+            for (int x = x0; x < x1; ++x)
+               dst[x] = (Elem2)acc[x];
+
+            // Borders
+            for (int x = 0; x < x0; ++x)
+               dst[x] = (Elem2)filterRowPixelClipped(src, w, x, kernel);
+            for (int x = x1; x < w; ++x)
+               dst[x] = (Elem2)filterRowPixelClipped(src, w, x, kernel);
+         } // end for (row)
       }
-      convolveImage(im,kernelX,temp);
-      convolveImage(temp,kernelY,out);
+   } // end filterImageRows()
+
+   // Convolves each column with a 1-D kernel, see filterImageRows().
+   // Each output row is a weighted sum of input rows, so all loops run along rows.
+   template<typename Elem, typename Elem2>
+   inline void
+   filterImageColumns( const Image<Elem> &im, std::vector<float> const& kernel, Image<Elem2> &out )
+   {
+      int const w = im.width();
+      int const h = im.height();
+      int const nChannels = im.numChannels();
+      int const K = kernel.size();
+      int const top = K/2;
+
+      if (out.width() != im.width() || out.height() != im.height() || out.numChannels() != im.numChannels())
+         out.resize(w, h, nChannels);
+
+#ifdef _OPENMP
+#pragma omp parallel if (w*h*nChannels >= 128*128)
+#endif
+      {
+         std::vector<float> acc(w);
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+         for (int row = 0; row < h*nChannels; ++row)
+         {
+            int const y = row % h;
+            int const ch = row / h;
+
+            // Only the taps inside the image; re-normalize at the borders.
+            int const k0 = std::max(0, top - y);
+            int const k1 = std::min(K, h - y + top);
+            float denom = 0;
+            for (int k = k0; k < k1; ++k) denom += kernel[k];
+
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            for (int k = k0; k < k1; ++k)
+            {
+               float const weight = kernel[k] / denom;
+               Elem const * src = im.begin(ch) + (y - top + k)*w;
+               for (int x = 0; x < w; ++x)
+                  acc[x] += weight * src[x];
+            }
+
+            Elem2 * dst = out.begin(ch) + y*w;
+            for (int x = 0; x < w; ++x)
+               dst[x] = (Elem2)acc[x];
+         } // end for (row)
+      }
+   } // end filterImageColumns()
+
+   // Separable convolution with a horizontal and a vertical 1-D kernel.
+   template<typename Elem>
+   inline void
+   separableFilterImage( const Image<Elem> &im, std::vector<float> const& kernelX,
+                         std::vector<float> const& kernelY, Image<Elem> &out, Image<Elem>& temp )
+   {
+      filterImageRows(im, kernelX, temp);
+      filterImageColumns(temp, kernelY, out);
+   }
+
+   template<typename Elem>
+   inline void binomialFilterImage( const Image<Elem> &im, int Nx, int Ny, Image<Elem> &out,
+                                    Image<Elem>& temp )
+   {
+      separableFilterImage(im, binomialKernel(Nx), binomialKernel(Ny), out, temp);
    }
 
    template<typename Elem>
@@ -214,10 +214,43 @@ namespace V3D_GPU
       }
    } // end TVL1_ColorFlowEstimator_QR::deallocate()
 
+   void
+   TVL1_ColorFlowEstimator_QR::uploadInitialFlow(int level, RTT_Buffer& ubuffer)
+   {
+      // Average the flow over the pixels covered by one pixel of this level,
+      // and scale it to the pixels of this level.
+      int const scale = 1 << level;
+      int const w = _width / scale;
+      int const h = _height / scale;
+      float const norm = 1.0f / (scale * scale * scale);
+
+      vector<float> uv(4*w*h, 0.0f);
+      for (int y = 0; y < h; ++y)
+         for (int x = 0; x < w; ++x)
+         {
+            float u = 0, v = 0;
+            for (int yy = y*scale; yy < (y+1)*scale; ++yy)
+               for (int xx = x*scale; xx < (x+1)*scale; ++xx)
+               {
+                  u += _initialFlow[2*(yy*_width + xx) + 0];
+                  v += _initialFlow[2*(yy*_width + xx) + 1];
+               }
+            uv[4*(y*w + x) + 0] = norm * u;
+            uv[4*(y*w + x) + 1] = norm * v;
+         }
+
+      // RGBA is uploaded since luminance/alpha would not end up in the RG channels.
+      ubuffer.getTexture().overwriteWith(&uv[0], 4);
+   } // end TVL1_ColorFlowEstimator_QR::uploadInitialFlow()
+
    void
    TVL1_ColorFlowEstimator_QR::run(unsigned int I0_TexIDs[3], unsigned int I1_TexIDs[3])
    {
-      for (int level = _nLevels-1; level >= _startLevel; --level)
+      int const coarsestLevel = (_initialFlow != 0)
+         ? std::max(_startLevel, std::min(_initialFlowLevel, _nLevels-1))
+         : _nLevels-1;
+
+      for (int level = coarsestLevel; level >= _startLevel; --level)
       {
          RTT_Buffer * ubuffer1 = _uBuffer1Pyramid[level];
          RTT_Buffer * ubuffer2 = _uBuffer2Pyramid[level];
@@ -226,11 +259,16 @@ namespace V3D_GPU
 
          float const lambda = _lambda;
 
-         if (level == _nLevels-1)
+         if (level == coarsestLevel)
          {
             glClearColor(0, 0, 0, 0);
-            ubuffer2->activate();
-            glClear(GL_COLOR_BUFFER_BIT);
+            if (_initialFlow != 0)
+               uploadInitialFlow(level, *ubuffer2);
+            else
+            {
+               ubuffer2->activate();
+               glClear(GL_COLOR_BUFFER_BIT);
+            }
             pbuffer2->activate();
             glClear(GL_COLOR_BUFFER_BIT);
          }
@@ -72,7 +72,7 @@ namespace V3D_GPU
          };
 
          TVL1_ColorFlowEstimator_QR(int nLevels)
-            : TVL1_ColorFlowEstimatorBase(nLevels)
+            : TVL1_ColorFlowEstimatorBase(nLevels), _initialFlow(0), _initialFlowLevel(0)
          {
             _shader_uv = 0;
             _shader_p  = 0;
@@ -85,6 +85,16 @@ namespace V3D_GPU
          void allocate(int w, int h);
          void deallocate();
 
+         // Warm start: run() begins at the given level with this flow instead of
+         // zero flow at the coarsest level, the levels above are skipped.
+         // uv holds interleaved u/v in pixels of the full resolution and must stay
+         // valid until run() returns. Pass 0 to start from zero flow again.
+         void setInitialFlow(float const * uv, int level)
+         {
+            _initialFlow = uv;
+            _initialFlowLevel = level;
+         }
+
          void run(unsigned int I0_TexIDs[3], unsigned int I1_TexIDs[3]);
 
          unsigned int getFlowFieldTextureID()
@@ -98,8 +108,13 @@ namespace V3D_GPU
      }
 
       protected:
+         void uploadInitialFlow(int level, RTT_Buffer& ubuffer);
+
          Config _cfg;
 
+         float const * _initialFlow;
+         int _initialFlowLevel;
+
          GLSL_FragmentProgram *_shader_uv;
          GLSL_FragmentProgram *_shader_p;
 
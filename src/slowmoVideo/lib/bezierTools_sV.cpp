@@ -12,26 +12,21 @@ the Free Software Foundation, either version 3 of the License, or
 
 #include <cmath>
 #include <iostream>
+#include <limits>
+
+/// Maximum number of refinement steps when solving for t
+#define MAX_ITERATIONS 50
+/// Precision of t when solving x(t) = x
+#define T_EPSILON 1e-12
 
 QPointF BezierTools_sV::interpolateAtX(float x, QPointF p0, QPointF p1, QPointF p2, QPointF p3)
 {
-    float delta = 1;
-    float t = 0;
-    int iterations = 10*(p3.x()-p0.x());
-
-    for (int i = 0; i < iterations; i++) {
-        float plus  = interpolate(t+delta, p0, p1, p2, p3).x();
-        float minus = interpolate(t-delta, p0, p1, p2, p3).x();
-        float norm  = interpolate(t      , p0, p1, p2, p3).x();
-        if ((t+delta) <= 1 && fabs(plus-x) < fabs(norm-x)) {
-            t += delta;
-        } else if ((t-delta) >= 0 && fabs(minus-x) < fabs(norm-x)) {
-            t -= delta;
-        }
-        delta /= 2;
-    }
-//    std::cout << "Interpolating at t=" << t << " for x time " << 100*interpolate(t, p0, p1, p2, p3).x << ": " << interpolate(t, p0, p1, p2, p3).y << std::endl;
-    return interpolate(t, p0, p1, p2, p3);
+    return interpolateAtX(x, Polynomial(p0, p1, p2, p3));
+}
+
+QPointF BezierTools_sV::interpolateAtX(float x, const Polynomial &curve)
+{
+    return curve.at(curve.solveT(x));
 }
 
 QPointF BezierTools_sV::interpolate(float t, QPointF p0, QPointF p1, QPointF p2, QPointF p3)
@@ -42,3 +37,147 @@ QPointF BezierTools_sV::interpolate(float t, QPointF p0, QPointF p1, QPointF p2,
     p3 = p3 * 1 * pow(t,3) * pow(1-t, 0);
     return p0+p1+p2+p3;
 }
+
+
+BezierTools_sV::Polynomial::Polynomial() :
+    m_p0(std::numeric_limits<qreal>::quiet_NaN(), 0), m_p1(), m_p2(), m_p3(),
+    m_ax(0), m_bx(0), m_cx(0),
+    m_ay(0), m_by(0), m_cy(0),
+    m_linearX(false)
+{
+}
+
+BezierTools_sV::Polynomial::Polynomial(QPointF p0, QPointF p1, QPointF p2, QPointF p3) :
+    m_p0(p0), m_p1(p1), m_p2(p2), m_p3(p3)
+{
+    // B(t) = (1-t)^3 p0 + 3(1-t)^2 t p1 + 3(1-t) t^2 p2 + t^3 p3
+    m_cx = 3*(p1.x() - p0.x());
+    m_bx = 3*(p2.x() - p1.x()) - m_cx;
+    m_ax = p3.x() - p0.x() - m_cx - m_bx;
+    m_cy = 3*(p1.y() - p0.y());
+    m_by = 3*(p2.y() - p1.y()) - m_cy;
+    m_ay = p3.y() - p0.y() - m_cy - m_by;
+
+    qreal span = fabs(p3.x() - p0.x());
+    m_linearX = fabs(m_ax) <= 1e-12*span && fabs(m_bx) <= 1e-12*span;
+}
+
+bool BezierTools_sV::Polynomial::matches(QPointF p0, QPointF p1, QPointF p2, QPointF p3) const
+{
+    // Exact comparison; QPointF::operator== is fuzzy.
+    return p0.x() == m_p0.x() && p0.y() == m_p0.y()
+            && p1.x() == m_p1.x() && p1.y() == m_p1.y()
+            && p2.x() == m_p2.x() && p2.y() == m_p2.y()
+            && p3.x() == m_p3.x() && p3.y() == m_p3.y();
+}
+
+QPointF BezierTools_sV::Polynomial::at(qreal t) const
+{
+    return QPointF(((m_ax*t + m_bx)*t + m_cx)*t + m_p0.x(),
+                   ((m_ay*t + m_by)*t + m_cy)*t + m_p0.y());
+}
+
+qreal BezierTools_sV::Polynomial::solveT(qreal x) const
+{
+    const qreal x0 = m_p0.x();
+    const qreal x3 = m_p3.x();
+    const bool increasing = x3 >= x0;
+
+    if ((increasing && x <= x0) || (!increasing && x >= x0)) {
+        return 0;
+    }
+    if ((increasing && x >= x3) || (!increasing && x <= x3)) {
+        return 1;
+    }
+    if (m_linearX) {
+        return (x - x0) / (x3 - x0);
+    }
+
+    qreal t = cubicRoot(m_ax, m_bx, m_cx, x0 - x);
+    if (t < 0) {
+        t = (x - x0) / (x3 - x0);
+    }
+
+    // Newton refinement. f changes sign on [lo,hi]; steps leaving the
+    // interval are replaced by bisection, so this always converges.
+    qreal lo = 0;
+    qreal hi = 1;
+    for (int i = 0; i < MAX_ITERATIONS; i++) {
+        qreal f = ((m_ax*t + m_bx)*t + m_cx)*t + x0 - x;
+        if (f == 0) {
+            break;
+        }
+        if ((f < 0) == increasing) {
+            lo = t;
+        } else {
+            hi = t;
+        }
+        qreal df = (3*m_ax*t + 2*m_bx)*t + m_cx;
+        qreal next = (df != 0) ? t - f/df : -1;
+        if (!(next > lo && next < hi)) {
+            next = (lo + hi)/2;
+        }
+        if (fabs(next - t) < T_EPSILON) {
+            t = next;
+            break;
+        }
+        t = next;
+    }
+    return t;
+}
+
+qreal BezierTools_sV::Polynomial::cubicRoot(qreal a, qreal b, qreal c, qreal d)
+{
+    const qreal tolerance = 1e-9;
+    qreal roots[3];
+    int nRoots = 0;
+
+    qreal scale = fabs(a) + fabs(b) + fabs(c);
+    if (fabs(a) <= 1e-12*scale) {
+        if (fabs(b) <= 1e-12*scale) {
+            // Linear
+            if (c != 0) {
+                roots[nRoots++] = -d/c;
+            }
+        } else {
+            // Quadratic
+            qreal disc = c*c - 4*b*d;
+            if (disc >= 0) {
+                qreal sq = sqrt(disc);
+                roots[nRoots++] = (-c + sq)/(2*b);
+                roots[nRoots++] = (-c - sq)/(2*b);
+            }
+        }
+    } else {
+        // Cardano on the depressed cubic t = u - b/3a, u^3 + p u + q = 0
+        qreal B = b/a;
+        qreal C = c/a;
+        qreal D = d/a;
+        qreal p = C - B*B/3;
+        qreal q = 2*B*B*B/27 - B*C/3 + D;
+        qreal offset = -B/3;
+        qreal disc = q*q/4 + p*p*p/27;
+
+        if (disc > 0) {
+            qreal sq = sqrt(disc);
+            roots[nRoots++] = cbrt(-q/2 + sq) + cbrt(-q/2 - sq) + offset;
+        } else if (p == 0) {
+            roots[nRoots++] = cbrt(-q) + offset;
+        } else {
+            // Three real roots, trigonometric solution
+            qreal r = sqrt(-p/3);
+            qreal cosPhi = qMax(qreal(-1), qMin(qreal(1), -q/(2*r*r*r)));
+            qreal phi = acos(cosPhi);
+            for (int k = 0; k < 3; k++) {
+                roots[nRoots++] = 2*r*cos((phi + 2*M_PI*k)/3) + offset;
+            }
+        }
+    }
+
+    for (int i = 0; i < nRoots; i++) {
+        if (roots[i] >= -tolerance && roots[i] <= 1+tolerance) {
+            return qMax(qreal(0), qMin(qreal(1), roots[i]));
+        }
+    }
+    return -1;
+}
@@ -19,6 +19,46 @@ the Free Software Foundation, either version 3 of the License, or
 class BezierTools_sV
 {
 public:
+    /**
+      \brief Cubic bézier curve in polynomial form.
+
+      Stores the coefficients of \f$ x(t) = a_x t^3 + b_x t^2 + c_x t + d_x \f$ (and the same for y)
+      such that they only have to be calculated once per curve. The control points are kept
+      to check whether the coefficients are still valid for a curve, see matches().
+      */
+    class Polynomial
+    {
+    public:
+        /// Creates an invalid polynomial which does not match any curve.
+        Polynomial();
+        Polynomial(QPointF p0, QPointF p1, QPointF p2, QPointF p3);
+
+        /// \return \c true if the polynomial was built from these control points
+        bool matches(QPointF p0, QPointF p1, QPointF p2, QPointF p3) const;
+
+        /// Evaluates the curve at time \c t
+        QPointF at(qreal t) const;
+
+        /**
+          \brief Solves \f$ x(t) = x \f$ for \f$ t \in [0,1] \f$.
+
+          The cubic is solved analytically, and the root refined with (bracketed) Newton iterations
+          which also catch numerical problems of the closed-form solution.
+          Values of \c x outside of the curve are clamped to t=0 and t=1, respectively.
+          */
+        qreal solveT(qreal x) const;
+
+    private:
+        QPointF m_p0, m_p1, m_p2, m_p3;
+        qreal m_ax, m_bx, m_cx;
+        qreal m_ay, m_by, m_cy;
+        /// x(t) is linear (handles at 1/3 and 2/3 of the x range), t can be calculated directly
+        bool m_linearX;
+
+        /// \return A root of \f$ a t^3 + b t^2 + c t + d \f$ in [0,1], or -1 if none was found
+        static qreal cubicRoot(qreal a, qreal b, qreal c, qreal d);
+    };
+
     /**
       \brief Interpolates the bézier curve at x value \c x.
 
@@ -26,6 +66,13 @@ public:
       the y value at a given x , which may differ from the time \c t in interpolate().
       */
     static QPointF interpolateAtX(float x, QPointF p0, QPointF p1, QPointF p2, QPointF p3);
+    /**
+      \brief Interpolates the bézier curve at x value \c x.
+
+      Same as the above, but uses precalculated coefficients. Use this when evaluating
+      the same curve many times.
+      */
+    static QPointF interpolateAtX(float x, const Polynomial &curve);
     /**
       \brief Interpolates the bézier curve at time \c t.
 
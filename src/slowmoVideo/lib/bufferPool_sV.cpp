@@ -0,0 +1,136 @@
+/*
+slowmoVideo creates slow-motion videos from normal-speed videos.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "bufferPool_sV.h"
+
+#include <QtCore/QMutexLocker>
+#include <new>
+
+/// Buffers smaller than this are allocated directly; the allocator handles them well.
+#define MIN_POOLED_BYTES (64*1024)
+/// Pooled buffers are freed when they have not been requested for this number of frames.
+#define MAX_IDLE_FRAMES 2
+/// Released buffers are freed directly when the pool already holds this many bytes.
+#define MAX_POOLED_BYTES (size_t(1024)*1024*1024)
+
+BufferPool_sV* BufferPool_sV::instance()
+{
+    static BufferPool_sV pool;
+    return &pool;
+}
+
+BufferPool_sV::BufferPool_sV() :
+    m_frame(0)
+{
+}
+
+BufferPool_sV::~BufferPool_sV()
+{
+    clear();
+}
+
+void* BufferPool_sV::acquire(size_t bytes)
+{
+    if (bytes < MIN_POOLED_BYTES) {
+        return ::operator new(bytes);
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        std::multimap<size_t, Entry>::iterator it = m_free.find(bytes);
+        if (it != m_free.end()) {
+            void *buffer = it->second.buffer;
+            m_free.erase(it);
+            m_counters.reuses++;
+            m_counters.bytesReused += bytes;
+            m_counters.bytesPooled -= bytes;
+            return buffer;
+        }
+        m_counters.allocations++;
+    }
+    // Allocate outside the lock, this may take a while for large buffers.
+    return ::operator new(bytes);
+}
+
+void BufferPool_sV::release(void *buffer, size_t bytes)
+{
+    if (buffer == NULL) {
+        return;
+    }
+    if (bytes >= MIN_POOLED_BYTES) {
+        QMutexLocker locker(&m_mutex);
+        if (m_counters.bytesPooled + bytes <= MAX_POOLED_BYTES) {
+            Entry entry;
+            entry.buffer = buffer;
+            entry.frame = m_frame;
+            m_free.insert(std::make_pair(bytes, entry));
+            m_counters.bytesPooled += bytes;
+            if (m_counters.bytesPooled > m_counters.peakBytesPooled) {
+                m_counters.peakBytesPooled = m_counters.bytesPooled;
+            }
+            return;
+        }
+    }
+    ::operator delete(buffer);
+}
+
+void BufferPool_sV::endFrame()
+{
+    QMutexLocker locker(&m_mutex);
+    std::multimap<size_t, Entry>::iterator it = m_free.begin();
+    while (it != m_free.end()) {
+        if (m_frame - it->second.frame >= MAX_IDLE_FRAMES) {
+            ::operator delete(it->second.buffer);
+            m_counters.bytesPooled -= it->first;
+            m_counters.trimmed++;
+            m_free.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+    m_frame++;
+}
+
+void BufferPool_sV::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    for (std::multimap<size_t, Entry>::iterator it = m_free.begin(); it != m_free.end(); ++it) {
+        ::operator delete(it->second.buffer);
+    }
+    m_free.clear();
+    m_counters.bytesPooled = 0;
+}
+
+BufferPool_sV::Counters BufferPool_sV::counters() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_counters;
+}
+
+void BufferPool_sV::resetCounters()
+{
+    QMutexLocker locker(&m_mutex);
+    size_t pooled = m_counters.bytesPooled;
+    m_counters = Counters();
+    m_counters.bytesPooled = pooled;
+    m_counters.peakBytesPooled = pooled;
+}
+
+QString BufferPool_sV::summary() const
+{
+    Counters c = counters();
+    return QString("Buffer pool: %1 buffers allocated, %2 allocations avoided (%3 MB reused), "
+                   "%4 freed as unused, %5 MB pooled (peak %6 MB)")
+            .arg(c.allocations).arg(c.reuses)
+            .arg(c.bytesReused/(1024*1024), 0, 'f', 1)
+            .arg(c.trimmed)
+            .arg(c.bytesPooled/(1024.0*1024), 0, 'f', 1)
+            .arg(c.peakBytesPooled/(1024.0*1024), 0, 'f', 1);
+}
@@ -0,0 +1,94 @@
+/*
+slowmoVideo creates slow-motion videos from normal-speed videos.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef BUFFERPOOL_SV_H
+#define BUFFERPOOL_SV_H
+
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <cstddef>
+#include <map>
+
+/**
+  \brief Recycles large buffers between rendered frames.
+
+  Rendering a frame allocates the same temporaries each time: flow fields, source fields,
+  float images. For large frames each of these is several megabytes, and allocating them
+  anew means the memory is returned to the system and page-faulted in again for every frame.
+
+  Buffers which are released are kept in the pool and returned again by acquire() when
+  a buffer of exactly the same size is requested. endFrame() marks the end of a rendered frame;
+  buffers which have not been requested for a few frames (e.g. after the frame size changed)
+  are freed then. Small buffers are not pooled.
+
+  Buffers are aligned like memory from \c new. The pool can be used from multiple threads.
+  */
+class BufferPool_sV
+{
+public:
+    /// Pool statistics
+    struct Counters {
+        /// Number of buffers which had to be allocated
+        long allocations;
+        /// Number of requests served from the pool, i.e. allocations avoided
+        long reuses;
+        /// Bytes served from the pool
+        double bytesReused;
+        /// Number of pooled buffers freed because they were not requested again
+        long trimmed;
+        /// Bytes currently held by the pool and not in use
+        size_t bytesPooled;
+        /// Maximum of bytesPooled
+        size_t peakBytesPooled;
+        Counters() : allocations(0), reuses(0), bytesReused(0), trimmed(0), bytesPooled(0), peakBytesPooled(0) {}
+    };
+
+    /// \return The pool used by the render core
+    static BufferPool_sV* instance();
+
+    BufferPool_sV();
+    ~BufferPool_sV();
+
+    /// \return A buffer of \c bytes bytes, with undefined content
+    void* acquire(size_t bytes);
+    /// Returns a buffer to the pool. \c bytes must be the size it was acquired with.
+    void release(void *buffer, size_t bytes);
+
+    template <typename T> T* acquireArray(size_t count) { return static_cast<T*>(acquire(count*sizeof(T))); }
+    template <typename T> void releaseArray(T *buffer, size_t count) { release(buffer, count*sizeof(T)); }
+
+    /// Ends a frame and frees buffers which have not been used recently
+    void endFrame();
+    /// Frees all pooled buffers
+    void clear();
+
+    Counters counters() const;
+    void resetCounters();
+    /// \return A human-readable summary of the counters
+    QString summary() const;
+
+private:
+    struct Entry {
+        void *buffer;
+        /// Frame in which the buffer was released
+        int frame;
+    };
+
+    mutable QMutex m_mutex;
+    std::multimap<size_t, Entry> m_free;
+    int m_frame;
+    Counters m_counters;
+
+    BufferPool_sV(const BufferPool_sV &other);
+    BufferPool_sV& operator =(const BufferPool_sV &other);
+};
+
+#endif // BUFFERPOOL_SV_H
@@ -0,0 +1,130 @@
+/*
+slowmoVideo creates slow-motion videos from normal-speed videos.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "consistencyMap_sV.h"
+#include "flowField_sV.h"
+
+#include <cassert>
+#include <cmath>
+#include <fstream>
+
+const std::string ConsistencyMap_sV::m_magicNumber = "cons_sV";
+const char ConsistencyMap_sV::m_version = 1;
+
+/// Bilinear interpolation of the flow at <code>(x|y)</code>, which must lie inside the field
+static inline void sampleFlow(const FlowField_sV *flow, float x, float y, float &u, float &v)
+{
+    int x0 = int(x);
+    int y0 = int(y);
+    int x1 = x0+1 < flow->width() ? x0+1 : x0;
+    int y1 = y0+1 < flow->height() ? y0+1 : y0;
+    float dx = x-x0;
+    float dy = y-y0;
+    u = (1-dy)*((1-dx)*flow->x(x0,y0) + dx*flow->x(x1,y0)) + dy*((1-dx)*flow->x(x0,y1) + dx*flow->x(x1,y1));
+    v = (1-dy)*((1-dx)*flow->y(x0,y0) + dx*flow->y(x1,y0)) + dy*((1-dx)*flow->y(x0,y1) + dx*flow->y(x1,y1));
+}
+
+/// Round trip along \c there and back along \c back for each pixel
+static void checkRoundTrip(const FlowField_sV *there, const FlowField_sV *back, float maxError, unsigned char *out)
+{
+    const int W = there->width();
+    const int H = there->height();
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float tx = x + there->x(x,y);
+            float ty = y + there->y(x,y);
+            unsigned char c = 0;
+            if (tx >= 0 && tx <= W-1 && ty >= 0 && ty <= H-1) {
+                float u, v;
+                sampleFlow(back, tx, ty, u, v);
+                float ex = there->x(x,y) + u;
+                float ey = there->y(x,y) + v;
+                float error = std::sqrt(ex*ex + ey*ey);
+                if (error < maxError) {
+                    c = (unsigned char)(255*(1 - error/maxError) + .5f);
+                }
+            }
+            out[y*W + x] = c;
+        }
+    }
+}
+
+ConsistencyMap_sV::ConsistencyMap_sV(int width, int height) :
+    m_width(width),
+    m_height(height)
+{
+    m_data = new unsigned char[2*width*height];
+}
+
+ConsistencyMap_sV::~ConsistencyMap_sV()
+{
+    delete[] m_data;
+}
+
+ConsistencyMap_sV* ConsistencyMap_sV::fromFlow(const FlowField_sV *flowLeftRight, const FlowField_sV *flowRightLeft, float maxError)
+{
+    assert(flowLeftRight != NULL && flowRightLeft != NULL);
+    assert(flowLeftRight->width() == flowRightLeft->width());
+    assert(flowLeftRight->height() == flowRightLeft->height());
+    assert(maxError > 0);
+
+    ConsistencyMap_sV *map = new ConsistencyMap_sV(flowLeftRight->width(), flowLeftRight->height());
+    checkRoundTrip(flowLeftRight, flowRightLeft, maxError, &map->rat(Frame_Left, 0, 0));
+    checkRoundTrip(flowRightLeft, flowLeftRight, maxError, &map->rat(Frame_Right, 0, 0));
+    return map;
+}
+
+float ConsistencyMap_sV::confidence(Frame frame, float x, float y) const
+{
+    int px = int(x + .5f);
+    int py = int(y + .5f);
+    px = px < 0 ? 0 : (px >= m_width ? m_width-1 : px);
+    py = py < 0 ? 0 : (py >= m_height ? m_height-1 : py);
+    return at(frame, px, py) / 255.0f;
+}
+
+bool ConsistencyMap_sV::save(std::string filename) const
+{
+    std::ofstream file(filename.c_str(), std::ios_base::out | std::ios_base::binary);
+    file.write((char*) m_magicNumber.c_str(), m_magicNumber.length()*sizeof(char));
+    file.write((char*) &m_version, sizeof(char));
+    file.write((char*) &m_width, sizeof(int));
+    file.write((char*) &m_height, sizeof(int));
+    file.write((char*) m_data, 2*m_width*m_height);
+    file.close();
+    return !file.fail();
+}
+
+ConsistencyMap_sV* ConsistencyMap_sV::load(std::string filename) throw(ConsistencyMapError)
+{
+    std::ifstream file(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+
+    std::string magic(m_magicNumber.size(), ' ');
+    char version;
+    int width, height;
+    file.read(&magic[0], m_magicNumber.size());
+    file.read(&version, sizeof(char));
+    file.read((char*) &width, sizeof(int));
+    file.read((char*) &height, sizeof(int));
+    if (file.rdstate() != std::ios::goodbit || magic != m_magicNumber || width <= 0 || height <= 0) {
+        throw ConsistencyMapError("Not a valid consistency map: " + filename);
+    }
+    if (version != m_version) {
+        throw ConsistencyMapError("Unsupported consistency map version in " + filename);
+    }
+
+    ConsistencyMap_sV *map = new ConsistencyMap_sV(width, height);
+    file.read((char*) map->m_data, 2*width*height);
+    if (file.rdstate() != std::ios::goodbit) {
+        delete map;
+        throw ConsistencyMapError("Failed to read data from file " + filename);
+    }
+    return map;
+}
@@ -0,0 +1,83 @@
+/*
+slowmoVideo creates slow-motion videos from normal-speed videos.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CONSISTENCYMAP_SV_H
+#define CONSISTENCYMAP_SV_H
+
+#include <string>
+
+class FlowField_sV;
+
+/**
+  \brief Forward/backward consistency of the flow between two frames.
+
+  For each pixel of the left frame the forward flow is followed to the right frame, and the backward
+  flow from there should lead back to the start. The distance by which it misses is turned into a
+  confidence from 0 (inconsistent, usually occluded) to 255 (consistent). The same is done for each
+  pixel of the right frame with the backward flow. Pixels whose flow leaves the frame get confidence 0.
+
+  The map is computed once per frame pair and stored next to the flow fields, so the interpolators
+  can weight the contributions of the left and the right frame without comparing the flow for
+  each output frame.
+
+  Binary format:
+  \code
+  "cons_sV" 0x1(char) width(int) height(int)
+  left[width*height](uchar) right[width*height](uchar)
+  \endcode
+  */
+class ConsistencyMap_sV
+{
+public:
+    /// Which frame, and therefore flow, the confidence refers to
+    enum Frame { Frame_Left = 0, Frame_Right = 1 };
+
+    struct ConsistencyMapError {
+        std::string message;
+        ConsistencyMapError(std::string msg) : message(msg) {}
+    };
+
+    /** Constructor for uninitialized data */
+    ConsistencyMap_sV(int width, int height);
+    ~ConsistencyMap_sV();
+
+    /**
+      Computes the consistency map of the two flow fields, which must have the same size.
+      \param maxError Round trip error in pixels at which the confidence drops to 0
+      */
+    static ConsistencyMap_sV* fromFlow(const FlowField_sV *flowLeftRight, const FlowField_sV *flowRightLeft, float maxError = 2);
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    /// Confidence at pixel <code>(x|y)</code> of the given frame, from 0 to 255
+    unsigned char at(Frame frame, int x, int y) const { return m_data[frame*m_width*m_height + y*m_width + x]; }
+    unsigned char& rat(Frame frame, int x, int y) { return m_data[frame*m_width*m_height + y*m_width + x]; }
+    /// Confidence on [0,1] at the pixel nearest to <code>(x|y)</code>; positions outside are clamped to the border.
+    float confidence(Frame frame, float x, float y) const;
+
+    /// \return \c false if the file could not be written
+    bool save(std::string filename) const;
+    /// Throws if the file is not a consistency map or has been written by another version
+    static ConsistencyMap_sV* load(std::string filename) throw(ConsistencyMapError);
+
+private:
+    int m_width;
+    int m_height;
+    unsigned char *m_data;
+
+    static const std::string m_magicNumber;
+    static const char m_version;
+
+    ConsistencyMap_sV(const ConsistencyMap_sV &other);
+    ConsistencyMap_sV& operator =(const ConsistencyMap_sV &other);
+};
+
+#endif // CONSISTENCYMAP_SV_H
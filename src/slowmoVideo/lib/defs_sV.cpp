@@ -164,6 +164,24 @@ Fps_sV::Fps_sV(float fps) throw(Error_sV)
     }
 }
 
+/// Times closer to a frame than this (in frames) are considered to be on the frame
+#define FRAME_EPSILON 1e-6
+
+int64_t Fps_sV::toFrame(double time, bool roundUp) const
+{
+    double frame = time*num/den;
+    double nearest = floor(frame + .5);
+    if (fabs(frame - nearest) < FRAME_EPSILON) {
+        return int64_t(nearest);
+    }
+    return int64_t(roundUp ? ceil(frame) : floor(frame));
+}
+
+int64_t Fps_sV::nearestFrame(double time) const
+{
+    return int64_t(floor(time*num/den + .5));
+}
+
 QString Fps_sV::toString() const
 {
     return QString("%1/%2").arg(num).arg(den);
@@ -108,6 +108,21 @@ struct Fps_sV {
     double fps() const {
         return double(num)/den;
     }
+
+    /**
+      \brief Converts a time in seconds to a frame number.
+
+      The frame number is calculated directly from num/den, so there is no drift for long times.
+      Times which are within a small tolerance of a frame are snapped to that frame before rounding.
+      \param roundUp Round up to the next frame instead of down
+      */
+    int64_t toFrame(double time, bool roundUp = false) const;
+    /// \return The number of the frame closest to \c time
+    int64_t nearestFrame(double time) const;
+    /// \return The exact time of frame number \c frame, in seconds
+    double toTime(int64_t frame) const {
+        return double(frame)*den/num;
+    }
 };
 /// For errors related to building optical flow.
 class FlowBuildingError : public Error_sV {
@@ -12,6 +12,30 @@
 
 #include "ffmpegEncode_sV.h"
 #include <libswscale/swscale.h>
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(53,8,0)
+#include <libavutil/dict.h>
+#endif
+#ifdef HAVE_SEND_RECEIVE_API
+#include <libavutil/imgutils.h>
+#endif
+
+// Names that have been removed in newer versions
+#if LIBAVCODEC_VERSION_MAJOR >= 57
+#define CODEC_ID_NONE AV_CODEC_ID_NONE
+#define CODEC_ID_MPEG1VIDEO AV_CODEC_ID_MPEG1VIDEO
+#define CODEC_ID_MPEG2VIDEO AV_CODEC_ID_MPEG2VIDEO
+#define CODEC_ID_MPEG4 AV_CODEC_ID_MPEG4
+#endif
+#if LIBAVUTIL_VERSION_MAJOR >= 55
+#define PIX_FMT_YUV420P AV_PIX_FMT_YUV420P
+#define PIX_FMT_BGRA AV_PIX_FMT_BGRA
+#endif
+#ifndef CODEC_FLAG_GLOBAL_HEADER
+#define CODEC_FLAG_GLOBAL_HEADER AV_CODEC_FLAG_GLOBAL_HEADER
+#endif
+#ifndef AVFMT_RAWPICTURE
+#define AVFMT_RAWPICTURE 0
+#endif
 
 void setErrorMessage(VideoOut_sV *video, const char *msg)
 {
@@ -22,18 +46,35 @@ void setErrorMessage(VideoOut_sV *video, const char *msg)
     strcpy(video->errorMessage, msg);
 }
 
+void defaultEncoderSettings(EncoderSettings_sV *settings)
+{
+    settings->bitrate = 0;
+    settings->crf = -1;
+    settings->preset = NULL;
+    settings->threads = 0;
+}
+
 void prepareDefault(VideoOut_sV *video)
 {
     prepare(video, "/tmp/ffmpegTest.avi", NULL, 352, 288, 400000,
                  1, 24);
 }
 
-int open_video(VideoOut_sV *video)
+int prepare(VideoOut_sV *video, const char *filename, const char *vcodec, const int width, const int height, const int bitrate,
+             const unsigned int numerator, const unsigned int denominator)
+{
+    EncoderSettings_sV settings;
+    defaultEncoderSettings(&settings);
+    settings.bitrate = bitrate;
+    return prepareWithSettings(video, filename, vcodec, width, height, &settings, numerator, denominator);
+}
+
+int open_video(VideoOut_sV *video, const EncoderSettings_sV *settings)
 {
     AVCodec *codec;
     AVCodecContext *cc;
 
-    cc = video->streamV->codec;
+    cc = video->cc;
 
     /* find the video encoder */
     codec = avcodec_find_encoder(cc->codec_id);
@@ -49,33 +90,69 @@ int open_video(VideoOut_sV *video)
 
     /* open the codec */
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(53,8,0)
+    if (settings->crf >= 0 || settings->preset != NULL) {
+        fputs("crf and preset are not supported by this libavcodec version, ignoring them.\n", stderr);
+    }
     if (avcodec_open(cc, codec) < 0) {
 #else
-    if (avcodec_open2(cc, codec, NULL) < 0) {
+    // Private encoder options. Options not known to the encoder remain in the dictionary.
+    AVDictionary *options = NULL;
+    if (settings->crf >= 0) {
+        char crf[16];
+        sprintf(crf, "%d", settings->crf);
+        av_dict_set(&options, "crf", crf, 0);
+    }
+    if (settings->preset != NULL) {
+        av_dict_set(&options, "preset", settings->preset, 0);
+    }
+    int opened = avcodec_open2(cc, codec, &options);
+    if (opened >= 0) {
+        AVDictionaryEntry *unused = NULL;
+        while ((unused = av_dict_get(options, "", unused, AV_DICT_IGNORE_SUFFIX)) != NULL) {
+            fprintf(stderr, "Option %s=%s is not supported by %s, ignoring it.\n", unused->key, unused->value, codec->name);
+        }
+    }
+    av_dict_free(&options);
+    if (opened < 0) {
 #endif
         char s[200];
         sprintf(s, "Could not open codec %s.\n", codec->long_name);
         fputs(s, stderr);
+        setErrorMessage(video, s);
+        return 3;
+    }
+    printf("Encoding with %d thread(s).\n", cc->thread_count);
+
+#ifdef HAVE_SEND_RECEIVE_API
+    if (avcodec_parameters_from_context(video->streamV->codecpar, cc) < 0) {
+        const char *s = "Could not copy the codec parameters to the stream.\n";
+        fputs(s, stderr);
+        setErrorMessage(video, s);
         return 3;
     }
+    video->streamV->time_base = cc->time_base;
 
+    video->packet = av_packet_alloc();
+    if (video->packet == NULL) {
+        const char *s = "Could not allocate a packet.\n";
+        fputs(s, stderr);
+        setErrorMessage(video, s);
+        return 3;
+    }
+#else
     video->outbufV = NULL;
     if (!(video->fc->oformat->flags & AVFMT_RAWPICTURE)) {
-        /* allocate output buffer */
-        /* XXX: API change will be done */
-        /* buffers passed into lav* can be allocated any way you prefer,
-           as long as they're aligned enough for the architecture, and
-           they're freed appropriately (such as using av_free for buffers
-           allocated with av_malloc) */
-        // \todo av_get_picture_size?
-        video->outbufSizeV = 200000;
+        /* allocate output buffer. An encoded frame should never be larger than
+           the uncompressed picture; add some space for headers for very small frames. */
+        video->outbufSizeV = FFMAX(2*avpicture_get_size(cc->pix_fmt, cc->width, cc->height), FF_MIN_BUFFER_SIZE);
         video->outbufV = av_malloc(video->outbufSizeV);
     }
+#endif
     return 0;
 }
 
-int prepare(VideoOut_sV *video, const char *filename, const char *vcodec, const int width, const int height, const int bitrate,
-             const unsigned int numerator, const unsigned int denominator)
+int prepareWithSettings(VideoOut_sV *video, const char *filename, const char *vcodec, const int width, const int height,
+                        const EncoderSettings_sV *settings, const unsigned int numerator, const unsigned int denominator)
 {
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(53,7,1)
     // Must be called before using the avcodec library. (Done automatically in more recent versions.)
@@ -87,8 +164,16 @@ int prepare(VideoOut_sV *video, const char *filename, const char *vcodec, const
     video->filename = malloc(strlen(filename)+1);
     strcpy(video->filename, filename);
 
+    video->cc = NULL;
+    video->picture = NULL;
+#ifdef HAVE_SEND_RECEIVE_API
+    video->packet = NULL;
+#endif
+
     /* initialize libavcodec, and register all codecs and formats */
+#if LIBAVFORMAT_VERSION_INT < AV_VERSION_INT(58,9,100)
     av_register_all();
+#endif
 #if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(53,19,0)
     avformat_network_init();
 #endif
@@ -119,7 +204,9 @@ int prepare(VideoOut_sV *video, const char *filename, const char *vcodec, const
     video->format = video->fc->oformat;
     printf("Using format %s.\n", video->format->name);
 
-    /* Use the given vcodec if it is not NULL */
+    /* Use the given vcodec if it is not NULL. The output format itself is not
+       modified since it is shared (and read-only in newer versions). */
+    int codecId = video->format->video_codec;
     if (vcodec != NULL) {
         AVCodec *codec = avcodec_find_encoder_by_name(vcodec);
         if (codec == NULL) {
@@ -130,13 +217,13 @@ int prepare(VideoOut_sV *video, const char *filename, const char *vcodec, const
             return 2;
         }
         printf("Found codec: %s\n", codec->long_name);
-        video->format->video_codec = codec->id;
+        codecId = codec->id;
     }
 
     /* add the audio and video streams using the default format codecs
        and initialize the codecs */
     video->streamV = NULL;
-    if (video->format->video_codec != CODEC_ID_NONE) {
+    if (codecId != CODEC_ID_NONE) {
 
 #if LIBAVFORMAT_VERSION_INT < AV_VERSION_INT(53,10,0)
         video->streamV = av_new_stream(video->fc, 0);
@@ -150,16 +237,33 @@ int prepare(VideoOut_sV *video, const char *filename, const char *vcodec, const
             return 2;
         }
 
-        AVCodecContext *cc = video->streamV->codec;
+#ifdef HAVE_SEND_RECEIVE_API
+        video->cc = avcodec_alloc_context3(NULL);
+        if (!video->cc) {
+            const char *s = "Could not allocate the codec context.\n";
+            fputs(s, stderr);
+            setErrorMessage(video, s);
+            return 2;
+        }
+#else
+        video->cc = video->streamV->codec;
+#endif
+        AVCodecContext *cc = video->cc;
 
-        cc->codec_id = video->format->video_codec;
+        cc->codec_id = codecId;
 #if LIBAVCODEC_VERSION_INT < (52<<16 | 64<<8 | 0)
         cc->codec_type = CODEC_TYPE_VIDEO;
 #else
         cc->codec_type = AVMEDIA_TYPE_VIDEO;
 #endif
 
-        cc->bit_rate = bitrate;
+        cc->bit_rate = settings->bitrate;
+
+        /* Use frame and slice threading where the encoder supports it */
+#ifdef FF_THREAD_FRAME
+        cc->thread_count = settings->threads;
+        cc->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#endif
 
         /* resolution must be a multiple of two */
         cc->width = width;
@@ -171,6 +275,9 @@ int prepare(VideoOut_sV *video, const char *filename, const char *vcodec, const
            timebase should be 1/framerate and timestamp increments should be
            identically 1. */
         cc->time_base = (AVRational){numerator, denominator};
+#ifdef HAVE_SEND_RECEIVE_API
+        cc->framerate = (AVRational){denominator, numerator};
+#endif
 
         cc->gop_size = 12; /* emit one intra frame every ten frames */
 
@@ -234,7 +341,7 @@ int prepare(VideoOut_sV *video, const char *filename, const char *vcodec, const
     /* now that all the parameters are set, we can open the audio and
        video codecs and allocate the necessary encode buffers */
     if (video->streamV) {
-        int ret = open_video(video);
+        int ret = open_video(video, settings);
         if (ret != 0) {
             return ret;
         }
@@ -289,17 +396,37 @@ int prepare(VideoOut_sV *video, const char *filename, const char *vcodec, const
 #if LIBAVFORMAT_VERSION_INT <= AV_VERSION_INT(53,1,3)
     av_write_header(video->fc);
 #else
-    avformat_write_header(video->fc, NULL);
+    if (avformat_write_header(video->fc, NULL) < 0) {
+        const char *s = "Could not write the stream header.\n";
+        fputs(s, stderr);
+        setErrorMessage(video, s);
+        return 5;
+    }
 #endif
 
 
-    /* alloc image and output buffer */
-    video->outbufSizeV = avpicture_get_size(video->streamV->codec->pix_fmt, width, height);
-    video->outbufV = av_malloc(video->outbufSizeV);
-
+    /* alloc image */
+#ifdef HAVE_SEND_RECEIVE_API
+    video->picture = av_frame_alloc();
+    if (video->picture) {
+        video->picture->format = video->cc->pix_fmt;
+        video->picture->width = video->cc->width;
+        video->picture->height = video->cc->height;
+        if (av_frame_get_buffer(video->picture, 32) < 0) {
+            av_frame_free(&video->picture);
+        }
+    }
+#else
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(55,28,1)
     video->picture = avcodec_alloc_frame();
-    avpicture_alloc((AVPicture*)video->picture, video->streamV->codec->pix_fmt,
-                    video->streamV->codec->width, video->streamV->codec->height);
+#else
+    video->picture = av_frame_alloc();
+#endif
+    if (video->picture) {
+        avpicture_alloc((AVPicture*)video->picture, video->cc->pix_fmt,
+                        video->cc->width, video->cc->height);
+    }
+#endif
     if (!video->picture) {
         const char *s = "Could not allocate AVPicture.\n";
         fputs(s, stderr);
@@ -310,28 +437,69 @@ int prepare(VideoOut_sV *video, const char *filename, const char *vcodec, const
     return 0;
 }
 
-int eatARGB(VideoOut_sV *video, const unsigned char *data)
+#ifdef HAVE_SEND_RECEIVE_API
+/// Writes all packets the encoder has ready. \return 0 on success
+int writePackets(VideoOut_sV *video)
 {
-    fflush(stdout);
-
-    int ret = 0;
-    AVCodecContext *cc = video->streamV->codec;
+    int ret;
+    while ((ret = avcodec_receive_packet(video->cc, video->packet)) >= 0) {
+        av_packet_rescale_ts(video->packet, video->cc->time_base, video->streamV->time_base);
+        video->packet->stream_index = video->streamV->index;
+        /* write the compressed frame in the media file; this also unreferences the packet */
+        ret = av_interleaved_write_frame(video->fc, video->packet);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        return 0;
+    }
+    return ret;
+}
+#else
+/// Writes the frame in outbufV to the file (if the encoder has returned one). \return 0 on success
+int writeEncodedFrame(VideoOut_sV *video)
+{
+    AVCodecContext *cc = video->cc;
+    /* if zero size, it means the image was buffered */
+    if (video->outSize > 0) {
+        AVPacket pkt;
+        av_init_packet(&pkt);
 
-#if LIBSWSCALE_VERSION_INT < AV_VERSION_INT(0,8,0)
-    sws_scale(video->rgbConversionContext,
-              (uint8_t**)&data, video->rgbLinesize,
-              0, cc->height,
-              video->picture->data, video->picture->linesize
-              );
+        if (cc->coded_frame->pts != AV_NOPTS_VALUE) {
+            pkt.pts = av_rescale_q(cc->coded_frame->pts, cc->time_base, video->streamV->time_base);
+//                printf("pkt.pts is %d.\n", pkt.pts);
+        }
+        if(cc->coded_frame->key_frame) {
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(52,30,2)
+            pkt.flags |= PKT_FLAG_KEY;
 #else
-    sws_scale(video->rgbConversionContext,
-              &data, video->rgbLinesize,
-              0, cc->height,
-              video->picture->data, video->picture->linesize
-              );
+            pkt.flags |= AV_PKT_FLAG_KEY;
 #endif
+        }
+        pkt.stream_index = video->streamV->index;
+        pkt.data = video->outbufV;
+        pkt.size = video->outSize;
 
+        /* write the compressed frame in the media file */
+        return av_interleaved_write_frame(video->fc, &pkt);
+    }
+    return 0;
+}
+#endif
 
+/// Encodes video->picture and writes the resulting packets. \return 0 on success
+int encodePicture(VideoOut_sV *video)
+{
+    int ret = 0;
+
+#ifdef HAVE_SEND_RECEIVE_API
+    video->picture->pts = video->frameNr;
+    ret = avcodec_send_frame(video->cc, video->picture);
+    if (ret >= 0) {
+        ret = writePackets(video);
+    }
+#else
     if (video->fc->oformat->flags & AVFMT_RAWPICTURE) {
         /* raw video case. The API will change slightly in the near
            future for that */
@@ -350,97 +518,116 @@ int eatARGB(VideoOut_sV *video, const unsigned char *data)
         ret = av_interleaved_write_frame(video->fc, &pkt);
     } else {
         /* encode the image */
-        video->outSize = avcodec_encode_video(cc, video->outbufV, video->outbufSizeV, video->picture);
-        /* if zero size, it means the image was buffered */
-        if (video->outSize > 0) {
-            AVPacket pkt;
-            av_init_packet(&pkt);
-
-            if (cc->coded_frame->pts != AV_NOPTS_VALUE) {
-                pkt.pts = av_rescale_q(cc->coded_frame->pts, cc->time_base, video->streamV->time_base);
-//                printf("pkt.pts is %d.\n", pkt.pts);
-            }
-            if(cc->coded_frame->key_frame) {
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(52,30,2)
-                pkt.flags |= PKT_FLAG_KEY;
-#else
-                pkt.flags |= AV_PKT_FLAG_KEY;
-#endif
-            }
-            pkt.stream_index = video->streamV->index;
-            pkt.data = video->outbufV;
-            pkt.size = video->outSize;
-
-            /* write the compressed frame in the media file */
-            ret = av_interleaved_write_frame(video->fc, &pkt);
+        video->outSize = avcodec_encode_video(video->cc, video->outbufV, video->outbufSizeV, video->picture);
+        if (video->outSize < 0) {
+            ret = video->outSize;
         } else {
-            ret = 0;
+            ret = writeEncodedFrame(video);
         }
     }
+#endif
+
     if (ret != 0) {
-        const char *s = "Error while writing video frame (interleaved_write).\n";
+        const char *s = "Error while encoding or writing video frame.\n";
         fputs(s, stderr);
         setErrorMessage(video, s);
         return ret;
     }
-    printf("Added frame %d to %s.\n", video->frameNr, video->filename);
     video->frameNr++;
+    return 0;
+}
+
+int eatARGB(VideoOut_sV *video, const unsigned char *data)
+{
+    fflush(stdout);
+
+    int ret = 0;
+    AVCodecContext *cc = video->cc;
 
+#ifdef HAVE_SEND_RECEIVE_API
+    /* The encoder may still reference the previous picture (frame threading) */
+    ret = av_frame_make_writable(video->picture);
+    if (ret < 0) {
+        const char *s = "Could not make the picture writable.\n";
+        fputs(s, stderr);
+        setErrorMessage(video, s);
+        return ret;
+    }
+#endif
+
+#if LIBSWSCALE_VERSION_INT < AV_VERSION_INT(0,8,0)
+    sws_scale(video->rgbConversionContext,
+              (uint8_t**)&data, video->rgbLinesize,
+              0, cc->height,
+              video->picture->data, video->picture->linesize
+              );
+#else
+    sws_scale(video->rgbConversionContext,
+              &data, video->rgbLinesize,
+              0, cc->height,
+              video->picture->data, video->picture->linesize
+              );
+#endif
+
+    ret = encodePicture(video);
+    if (ret == 0) {
+        printf("Added frame %d to %s.\n", video->frameNr-1, video->filename);
+    }
     return ret;
 }
 
 void eatSample(VideoOut_sV *video)
 {
     fflush(stdout);
+#ifdef HAVE_SEND_RECEIVE_API
+    av_frame_make_writable(video->picture);
+#endif
     /* prepare a dummy image */
     /* Y */
     int x, y;
-    for(y = 0; y < video->streamV->codec->height; y++) {
-        for(x = 0; x < video->streamV->codec->width; x++) {
+    for(y = 0; y < video->cc->height; y++) {
+        for(x = 0; x < video->cc->width; x++) {
             video->picture->data[0][y * video->picture->linesize[0] + x] = x + y + video->frameNr * 3;
         }
     }
 
     /* Cb and Cr */
-    for(y = 0; y < video->streamV->codec->height/2; y++) {
-        for(x = 0; x < video->streamV->codec->width/2; x++) {
+    for(y = 0; y < video->cc->height/2; y++) {
+        for(x = 0; x < video->cc->width/2; x++) {
             video->picture->data[1][y * video->picture->linesize[1] + x] = 128 + y + video->frameNr * 2;
             video->picture->data[2][y * video->picture->linesize[2] + x] = 64 + x + video->frameNr * 5;
         }
     }
 
     /* encode the image */
-    AVCodecContext *cc = video->streamV->codec;
-    video->outSize = avcodec_encode_video(cc, video->outbufV, video->outbufSizeV, video->picture);
-    /* if zero size, it means the image was buffered */
-    if (video->outSize > 0) {
-        AVPacket pkt;
-        av_init_packet(&pkt);
+    encodePicture(video);
+}
 
-        if (cc->coded_frame->pts != AV_NOPTS_VALUE) {
-            pkt.pts = av_rescale_q(cc->coded_frame->pts, cc->time_base, video->streamV->time_base);
-            printf("pkt.pts is %ld.\n", pkt.pts);
+/// Writes the frames that the encoder has delayed (B-frames, lookahead).
+void flushEncoder(VideoOut_sV *video)
+{
+#ifdef HAVE_SEND_RECEIVE_API
+    if (avcodec_send_frame(video->cc, NULL) >= 0) {
+        if (writePackets(video) != 0) {
+            fputs("Error while writing delayed frames.\n", stderr);
         }
-        if(cc->coded_frame->key_frame) {
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(52,30,2)
-            pkt.flags |= PKT_FLAG_KEY;
+    }
 #else
-            pkt.flags |= AV_PKT_FLAG_KEY;
-#endif
+    if (video->fc->oformat->flags & AVFMT_RAWPICTURE) {
+        return;
+    }
+    while ((video->outSize = avcodec_encode_video(video->cc, video->outbufV, video->outbufSizeV, NULL)) > 0) {
+        if (writeEncodedFrame(video) != 0) {
+            fputs("Error while writing delayed frames.\n", stderr);
+            break;
         }
-        pkt.stream_index = video->streamV->index;
-        pkt.data = video->outbufV;
-        pkt.size = video->outSize;
-
-        /* write the compressed frame in the media file */
-        av_interleaved_write_frame(video->fc, &pkt);
     }
-
-    video->frameNr++;
+#endif
 }
 
 void finish(VideoOut_sV *video)
 {
+    flushEncoder(video);
 
     /* write the trailer, if any.  the trailer must be written
      * before you close the CodecContexts open when you wrote the
@@ -450,16 +637,16 @@ void finish(VideoOut_sV *video)
 
     /* close each codec */
     if (video->streamV) {
-        avcodec_close(video->streamV->codec);
+#ifdef HAVE_SEND_RECEIVE_API
+        avcodec_free_context(&video->cc);
+        av_frame_free(&video->picture);
+        av_packet_free(&video->packet);
+#else
+        avcodec_close(video->cc);
         av_free(video->picture->data[0]);
         av_free(video->picture);
         av_free(video->outbufV);
-    }
-
-    /* free the streams */
-    for(int i = 0; i < video->fc->nb_streams; i++) {
-        av_freep(&video->fc->streams[i]->codec);
-        av_freep(&video->fc->streams[i]);
+#endif
     }
 
     if (!(video->format->flags & AVFMT_NOFILE)) {
@@ -471,8 +658,16 @@ void finish(VideoOut_sV *video)
 #endif
     }
 
-    /* free the stream */
+    /* free the streams and the format context */
+#ifdef HAVE_SEND_RECEIVE_API
+    avformat_free_context(video->fc);
+#else
+    for(int i = 0; i < video->fc->nb_streams; i++) {
+        av_freep(&video->fc->streams[i]->codec);
+        av_freep(&video->fc->streams[i]);
+    }
     av_free(video->fc);
+#endif
 
     sws_freeContext(video->rgbConversionContext);
     printf("\nWrote to %s.\n", video->filename);
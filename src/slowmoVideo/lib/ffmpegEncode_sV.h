@@ -28,6 +28,23 @@
 #define MOST_LIKELY_LIBAV
 #endif
 
+// avcodec_send_frame()/avcodec_receive_packet() and AVCodecParameters
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57,37,100)
+#define HAVE_SEND_RECEIVE_API
+#endif
+
+/// Encoder settings, see prepareWithSettings().
+typedef struct EncoderSettings_sV {
+    /// Bit rate in bits/s. 0 lets the encoder decide, e.g. when crf is used.
+    int bitrate;
+    /// Constant rate factor for encoders supporting it (x264, x265, VP9), or -1.
+    int crf;
+    /// Encoder preset (x264, x265) like \c medium or \c slow, or NULL.
+    const char *preset;
+    /// Number of encoding threads; 0 uses all cores.
+    int threads;
+} EncoderSettings_sV;
+
 /// This struct can eat frames and produces videos!
 /// Variables should not be changed from the outside.
 typedef struct VideoOut_sV {
@@ -36,6 +53,7 @@ typedef struct VideoOut_sV {
     AVFormatContext *fc; ///< Video's format context
     AVOutputFormat *format; ///< Just a shortcut to fc->format
     AVStream *streamV; ///< Video output stream
+    AVCodecContext *cc; ///< Codec context of the video stream
 
     /// Current frame number that is encoded
     int frameNr;
@@ -48,15 +66,25 @@ typedef struct VideoOut_sV {
     /// Video filename
     char *filename;
 
+#ifdef HAVE_SEND_RECEIVE_API
+    /// Receives encoded packets
+    AVPacket *packet;
+#else
     int outSize;
+    /// Size of outbufV. Large enough for an uncompressed frame.
     int outbufSizeV;
+    /// Receives the encoded frame
     uint8_t *outbufV;
+#endif
 
     /// Set if an error occurs (file does not exist, for example), for more accurate information.
     char *errorMessage;
 
 } VideoOut_sV;
 
+/// Sets the default settings: No crf, no preset, encoder's default bit rate, and as many threads as cores.
+void defaultEncoderSettings(EncoderSettings_sV *settings);
+
 /// Prepares a default VideoOut_sV struct, mainly for testing purposes with eatSample().
 void prepareDefault(VideoOut_sV *video);
 /**
@@ -73,13 +101,19 @@ void prepareDefault(VideoOut_sV *video);
   */
 int prepare(VideoOut_sV *video, const char *filename, const char *vcodec, const int width, const int height, const int bitrate,
              const unsigned int numerator, const unsigned int denominator);
+/**
+  Like prepare(), but with additional encoder settings (crf, preset, threads).
+  Settings that are not supported by the encoder are ignored with a warning.
+  */
+int prepareWithSettings(VideoOut_sV *video, const char *filename, const char *vcodec, const int width, const int height,
+                        const EncoderSettings_sV *settings, const unsigned int numerator, const unsigned int denominator);
 
 /// Eats an RGB image and deposits it in the output frame.
 int eatARGB(VideoOut_sV *video, const unsigned char *data);
 /// Eats a sample image. For testing.
 void eatSample(VideoOut_sV *video);
 
-/// Finishes the produced video file.
+/// Encodes the frames that are still buffered in the encoder and finishes the produced video file.
 void finish(VideoOut_sV *video);
 
 #endif // FFMPEGENCODE_SV_H
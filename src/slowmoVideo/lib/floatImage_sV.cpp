@@ -0,0 +1,240 @@
+/*
+slowmoVideo creates slow-motion videos from normal-speed videos.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "floatImage_sV.h"
+#include "bufferPool_sV.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+
+/// Floats per alignment unit
+#define ALIGN_FLOATS (FloatImage_sV::ALIGNMENT/int(sizeof(float)))
+
+FloatImage_sV::Plane FloatImage_sV::Plane::sub(int x, int y, int w, int h) const
+{
+    Q_ASSERT(x >= 0 && y >= 0 && x+w <= width && y+h <= height);
+    Plane p;
+    p.data = data + y*stride + x;
+    p.width = w;
+    p.height = h;
+    p.stride = stride;
+    return p;
+}
+
+FloatImage_sV::FloatImage_sV() :
+    m_width(0),
+    m_height(0),
+    m_stride(0),
+    m_buffer(NULL)
+{
+    for (int c = 0; c < CHANNELS; c++) {
+        m_planes[c] = NULL;
+    }
+}
+
+FloatImage_sV::FloatImage_sV(int width, int height) :
+    m_buffer(NULL)
+{
+    allocate(width, height);
+}
+
+FloatImage_sV::FloatImage_sV(const QSize &size) :
+    m_buffer(NULL)
+{
+    allocate(size.width(), size.height());
+}
+
+FloatImage_sV::FloatImage_sV(const FloatImage_sV &other) :
+    m_buffer(NULL)
+{
+    allocate(other.m_width, other.m_height);
+    if (!other.isNull()) {
+        memcpy(m_planes[0], other.m_planes[0], CHANNELS*m_stride*m_height*sizeof(float));
+    }
+}
+
+FloatImage_sV::~FloatImage_sV()
+{
+    release();
+}
+
+FloatImage_sV& FloatImage_sV::operator =(const FloatImage_sV &other)
+{
+    if (this != &other) {
+        if (other.m_width != m_width || other.m_height != m_height) {
+            release();
+            allocate(other.m_width, other.m_height);
+        }
+        if (!other.isNull()) {
+            memcpy(m_planes[0], other.m_planes[0], CHANNELS*m_stride*m_height*sizeof(float));
+        }
+    }
+    return *this;
+}
+
+void FloatImage_sV::swap(FloatImage_sV &other)
+{
+    std::swap(m_width, other.m_width);
+    std::swap(m_height, other.m_height);
+    std::swap(m_stride, other.m_stride);
+    std::swap(m_buffer, other.m_buffer);
+    for (int c = 0; c < CHANNELS; c++) {
+        std::swap(m_planes[c], other.m_planes[c]);
+    }
+}
+
+void FloatImage_sV::allocate(int width, int height)
+{
+    Q_ASSERT(width >= 0 && height >= 0);
+    m_width = width;
+    m_height = height;
+    m_stride = (width + ALIGN_FLOATS-1) / ALIGN_FLOATS * ALIGN_FLOATS;
+
+    if (width == 0 || height == 0) {
+        m_buffer = NULL;
+        for (int c = 0; c < CHANNELS; c++) {
+            m_planes[c] = NULL;
+        }
+        return;
+    }
+
+    // Over-allocate to be able to align the start of the first plane.
+    // The plane size is a multiple of the alignment, so the other planes are aligned as well.
+    m_buffer = BufferPool_sV::instance()->acquireArray<float>(bufferSize());
+    uintptr_t misalignment = uintptr_t(m_buffer) % ALIGNMENT;
+    float *start = m_buffer;
+    if (misalignment != 0) {
+        start += (ALIGNMENT - misalignment) / sizeof(float);
+    }
+    for (int c = 0; c < CHANNELS; c++) {
+        m_planes[c] = start + c*m_stride*height;
+    }
+}
+
+int FloatImage_sV::bufferSize() const
+{
+    return CHANNELS*m_stride*m_height + ALIGN_FLOATS;
+}
+
+void FloatImage_sV::release()
+{
+    if (m_buffer != NULL) {
+        BufferPool_sV::instance()->releaseArray(m_buffer, bufferSize());
+        m_buffer = NULL;
+    }
+}
+
+FloatImage_sV::Plane FloatImage_sV::plane(Channel c)
+{
+    Plane p;
+    p.data = m_planes[c];
+    p.width = m_width;
+    p.height = m_height;
+    p.stride = m_stride;
+    return p;
+}
+
+const FloatImage_sV::Plane FloatImage_sV::plane(Channel c) const
+{
+    Plane p;
+    p.data = m_planes[c];
+    p.width = m_width;
+    p.height = m_height;
+    p.stride = m_stride;
+    return p;
+}
+
+void FloatImage_sV::pixel(int x, int y, float *rgba) const
+{
+    const int offset = y*m_stride + x;
+    for (int c = 0; c < CHANNELS; c++) {
+        rgba[c] = m_planes[c][offset];
+    }
+}
+
+void FloatImage_sV::setPixel(int x, int y, const float *rgba)
+{
+    const int offset = y*m_stride + x;
+    for (int c = 0; c < CHANNELS; c++) {
+        m_planes[c][offset] = rgba[c];
+    }
+}
+
+void FloatImage_sV::setPixel(int x, int y, float r, float g, float b, float a)
+{
+    const int offset = y*m_stride + x;
+    m_planes[Channel_Red][offset] = r;
+    m_planes[Channel_Green][offset] = g;
+    m_planes[Channel_Blue][offset] = b;
+    m_planes[Channel_Alpha][offset] = a;
+}
+
+void FloatImage_sV::fill(float r, float g, float b, float a)
+{
+    const float values[CHANNELS] = { r, g, b, a };
+    for (int c = 0; c < CHANNELS; c++) {
+        float *p = m_planes[c];
+        const int n = m_stride*m_height;
+        for (int i = 0; i < n; i++) {
+            p[i] = values[c];
+        }
+    }
+}
+
+FloatImage_sV FloatImage_sV::fromImage(const QImage &image)
+{
+    QImage argb = image;
+    if (argb.format() != QImage::Format_ARGB32 && argb.format() != QImage::Format_RGB32) {
+        argb = image.convertToFormat(QImage::Format_ARGB32);
+    }
+    const bool hasAlpha = argb.format() == QImage::Format_ARGB32;
+
+    FloatImage_sV out(argb.width(), argb.height());
+    const float scale = 1.0f/255;
+    for (int y = 0; y < out.m_height; y++) {
+        const QRgb *in = (const QRgb*) argb.constScanLine(y);
+        float *r = out.scanLine(Channel_Red, y);
+        float *g = out.scanLine(Channel_Green, y);
+        float *b = out.scanLine(Channel_Blue, y);
+        float *a = out.scanLine(Channel_Alpha, y);
+        for (int x = 0; x < out.m_width; x++) {
+            r[x] = qRed(in[x]) * scale;
+            g[x] = qGreen(in[x]) * scale;
+            b[x] = qBlue(in[x]) * scale;
+            a[x] = hasAlpha ? qAlpha(in[x]) * scale : 1;
+        }
+    }
+    return out;
+}
+
+/// Maps [0,1] to [0,255] with clamping and rounding
+static inline int toByte(float v)
+{
+    if (v <= 0) { return 0; }
+    if (v >= 1) { return 255; }
+    return int(v*255 + .5f);
+}
+
+QImage FloatImage_sV::toImage() const
+{
+    QImage out(m_width, m_height, QImage::Format_ARGB32);
+    for (int y = 0; y < m_height; y++) {
+        QRgb *line = (QRgb*) out.scanLine(y);
+        const float *r = scanLine(Channel_Red, y);
+        const float *g = scanLine(Channel_Green, y);
+        const float *b = scanLine(Channel_Blue, y);
+        const float *a = scanLine(Channel_Alpha, y);
+        for (int x = 0; x < m_width; x++) {
+            line[x] = qRgba(toByte(r[x]), toByte(g[x]), toByte(b[x]), toByte(a[x]));
+        }
+    }
+    return out;
+}
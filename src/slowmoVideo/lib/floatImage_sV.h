@@ -0,0 +1,131 @@
+/*
+slowmoVideo creates slow-motion videos from normal-speed videos.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef FLOATIMAGE_SV_H
+#define FLOATIMAGE_SV_H
+
+#include <QtCore/QSize>
+#include <QtGui/QImage>
+
+#include <cmath>
+
+/**
+  \brief Planar RGBA image with float channels on [0,1], used by the render core.
+
+  Rendering works on float values to avoid rounding each intermediate result to 8 bits
+  (e.g. when averaging many samples for motion blur) and to avoid the QColor conversions
+  per pixel and channel. The image is converted from and to QImage only when reading frames
+  and passing rendered frames to a render target.
+
+  Each channel is stored in its own plane. Rows are padded to a multiple of
+  FloatImage_sV::ALIGNMENT bytes and start at aligned addresses, so rows can be processed
+  with vector instructions. The pixel at (x|y) of a plane is at <code>data[y*stride + x]</code>.
+
+  Copying an image copies the data. The pixel buffer is taken from BufferPool_sV, so images of
+  the same size are cheap to create for each frame.
+  */
+class FloatImage_sV
+{
+public:
+    enum Channel { Channel_Red = 0, Channel_Green = 1, Channel_Blue = 2, Channel_Alpha = 3 };
+    static const int CHANNELS = 4;
+    /// Alignment of rows and planes in bytes
+    static const int ALIGNMENT = 32;
+
+    /// View on a single channel, or a rectangular part of it
+    struct Plane {
+        float *data;
+        int width;
+        int height;
+        /// Number of floats from one row to the next
+        int stride;
+
+        float* line(int y) const { return data + y*stride; }
+        float& at(int x, int y) const { return data[y*stride + x]; }
+        /// \return A view on the rectangle at (x|y) with the given size, sharing the data
+        Plane sub(int x, int y, int w, int h) const;
+    };
+
+    /// Creates a null image
+    FloatImage_sV();
+    /// Creates an image with uninitialized pixels
+    FloatImage_sV(int width, int height);
+    FloatImage_sV(const QSize &size);
+    FloatImage_sV(const FloatImage_sV &other);
+    ~FloatImage_sV();
+
+    FloatImage_sV& operator =(const FloatImage_sV &other);
+    /// Exchanges the data with \c other without copying it
+    void swap(FloatImage_sV &other);
+
+    /// Converts an image to float; images without alpha channel get an alpha of 1.
+    static FloatImage_sV fromImage(const QImage &image);
+    /// \return The image as QImage::Format_ARGB32, with values clamped to [0,1] and rounded
+    QImage toImage() const;
+
+    bool isNull() const { return m_buffer == NULL; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    QSize size() const { return QSize(m_width, m_height); }
+    /// Number of floats from one row to the next, equal for all planes
+    int stride() const { return m_stride; }
+
+    Plane plane(Channel c);
+    const Plane plane(Channel c) const;
+    float* scanLine(Channel c, int y) { return m_planes[c] + y*m_stride; }
+    const float* scanLine(Channel c, int y) const { return m_planes[c] + y*m_stride; }
+
+    float at(Channel c, int x, int y) const { return m_planes[c][y*m_stride + x]; }
+    /// Reads the pixel at (x|y) into \c rgba
+    void pixel(int x, int y, float *rgba) const;
+    /// Sets all channels of the pixel at (x|y)
+    void setPixel(int x, int y, const float *rgba);
+    void setPixel(int x, int y, float r, float g, float b, float a = 1);
+    void fill(float r, float g, float b, float a = 1);
+
+    /**
+      Bilinear interpolation of all channels at (x|y).
+      \c x should fulfil \f$ 0 \leq x < width-1 \f$, same with y, to avoid reading outside the image.
+      Not tested inside the function for efficiency reasons.
+      */
+    inline void sample(float x, float y, float *rgba) const;
+
+private:
+    int m_width;
+    int m_height;
+    int m_stride;
+    float *m_buffer;
+    float *m_planes[CHANNELS];
+
+    /// Allocates the buffer from the BufferPool_sV
+    void allocate(int width, int height);
+    void release();
+    /// Number of floats in m_buffer
+    int bufferSize() const;
+};
+
+inline void FloatImage_sV::sample(float x, float y, float *rgba) const
+{
+    const int fx = int(std::floor(x));
+    const int fy = int(std::floor(y));
+    const float dx = x - fx;
+    const float dy = y - fy;
+    const float w00 = (1-dx)*(1-dy);
+    const float w10 = dx*(1-dy);
+    const float w01 = (1-dx)*dy;
+    const float w11 = dx*dy;
+    const int offset = fy*m_stride + fx;
+    for (int c = 0; c < CHANNELS; c++) {
+        const float *p = m_planes[c] + offset;
+        rgba[c] = w00*p[0] + w10*p[1] + w01*p[m_stride] + w11*p[m_stride+1];
+    }
+}
+
+#endif // FLOATIMAGE_SV_H
@@ -12,20 +12,43 @@ the Free Software Foundation, either version 3 of the License, or
 #include "string.h"
 #include <iostream>
 
+#ifndef SV_NO_BUFFER_POOL
+#include "bufferPool_sV.h"
+#endif
+
 float FlowField_sV::nullValue = 65535;
 
+/// Flow fields of the same size are requested for every rendered frame and are therefore pooled.
+static float* allocateData(int size)
+{
+#ifdef SV_NO_BUFFER_POOL
+    return new float[size];
+#else
+    return BufferPool_sV::instance()->acquireArray<float>(size);
+#endif
+}
+static void freeData(float *data, int size)
+{
+#ifdef SV_NO_BUFFER_POOL
+    (void) size;
+    delete[] data;
+#else
+    BufferPool_sV::instance()->releaseArray(data, size);
+#endif
+}
+
 FlowField_sV::FlowField_sV(int width, int height) :
     m_width(width),
     m_height(height)
 {
-    m_data = new float[2*m_width*m_height];
+    m_data = allocateData(dataSize());
 }
 
 FlowField_sV::FlowField_sV(int width, int height, float *data, FlowField_sV::GLFormat format) :
     m_width(width),
     m_height(height)
 {
-    m_data = new float[2*m_width*m_height];
+    m_data = allocateData(dataSize());
 
     switch (format) {
     case GLFormat_RG: 
@@ -45,7 +68,7 @@ FlowField_sV::FlowField_sV(int width, int height, float *data, FlowField_sV::GLF
 
 FlowField_sV::~FlowField_sV()
 {
-    delete[] m_data;
+    freeData(m_data, dataSize());
 }
 
 float FlowField_sV::x(int x, int y) const
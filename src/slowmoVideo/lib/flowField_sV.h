@@ -47,6 +47,8 @@ public:
 
     /// Pointer to the raw data. See the class description for the accurate format.
     float* data();
+    /// Read-only pointer to the raw data.
+    const float* data() const { return m_data; }
     /// Number of elements in the data array.
     int dataSize() const { return 2*m_width*m_height; }
 
@@ -75,6 +77,9 @@ private:
     int m_width;
     int m_height;
     float *m_data;
+
+    FlowField_sV(const FlowField_sV &other);
+    FlowField_sV& operator =(const FlowField_sV &other);
 };
 
 #endif // FLOWFIELD_SV_H
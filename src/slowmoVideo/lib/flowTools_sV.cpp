@@ -1,10 +1,16 @@
 #include "flowTools_sV.h"
+
+#include <QtGui/QImage>
+#include <QtCore/QVector>
+#include <algorithm>
 #include <cmath>
 #include <cassert>
 #include <iostream>
 
 //#define DEBUG
 
+#define CLAMP(x,min,max) (  ((x) < (min)) ? (min) : ( ((x) > (max)) ? (max) : (x) )  )
+
 void FlowTools_sV::deleteRect(FlowField_sV &field, int top, int left, int bottom, int right)
 {
     for (int y = top; y <= bottom; y++) {
@@ -182,48 +188,82 @@ void FlowTools_sV::refill(FlowField_sV &field, int top, int left, int bottom, in
 
 }
 
+/// Rows are only distributed over threads if the field is large enough to pay off
+#define PARALLEL_MIN_PIXELS (128*128)
+
+/**
+  Index of the vector in \c right at the position the vector <code>(dx|dy)</code> at <code>(x|y)</code> points to,
+  or -1 if it points outside the field. The position is truncated to the pixel.
+  */
+static inline int targetIndex(int x, int y, float dx, float dy, int w, int h)
+{
+    const float px = x + dx;
+    const float py = y + dy;
+    const bool inside = px >= 0 && py >= 0 && px <= w-1 && py <= h-1;
+    // Clamped, so that the computation itself is valid even if the target is outside
+    const int ix = int(CLAMP(px, 0, w-1));
+    const int iy = int(CLAMP(py, 0, h-1));
+    return inside ? 2*(iy*w + ix) : -1;
+}
+
 void FlowTools_sV::difference(const FlowField_sV &left, const FlowField_sV &right, FlowField_sV &out)
 {
-    float dx, dy;
-    for (int y = 0; y < left.height(); y++) {
-        for (int x = 0; x < left.width(); x++) {
-            dx = left.x(x,y);
-            dy = left.y(x,y);
-            if (x+dx >= 0 && y+dy >= 0
-                    && x+dx <= left.width()-1 && y+dy <= left.height()-1) {
-                dx += right.x(x+dx, y+dy);
-                dy += right.y(x+dx, y+dy);
-            }
-            out.setX(x,y, dx);
-            out.setY(x,y, dy);
+    assert(left.width() == right.width() && left.height() == right.height());
+    assert(left.width() == out.width() && left.height() == out.height());
+
+    const int w = left.width();
+    const int h = left.height();
+    const float *l = left.data();
+    const float *r = right.data();
+    float *o = out.data();
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (w*h >= PARALLEL_MIN_PIXELS)
+#endif
+    for (int y = 0; y < h; y++) {
+        const float *lRow = l + 2*y*w;
+        float *oRow = o + 2*y*w;
+        for (int x = 0; x < w; x++) {
+            const float dx = lRow[2*x];
+            const float dy = lRow[2*x+1];
+            const int i = targetIndex(x, y, dx, dy, w, h);
+            // Vectors pointing outside have nothing to compare with and are kept.
+            const int iSafe = i < 0 ? 0 : i;
+            oRow[2*x]   = dx + (i < 0 ? 0 : r[iSafe]);
+            oRow[2*x+1] = dy + (i < 0 ? 0 : r[iSafe+1]);
         }
     }
 }
+
 void FlowTools_sV::signedDifference(const FlowField_sV &left, const FlowField_sV &right, FlowField_sV &out)
 {
-    float lx, ly;
-    float rx, ry;
-    for (int y = 0; y < left.height(); y++) {
-        for (int x = 0; x < left.width(); x++) {
-            lx = left.x(x,y);
-            ly = left.y(x,y);
-            if (x+lx >= 0 && y+ly >= 0
-                    && x+lx <= left.width()-1 && y+ly <= left.height()-1) {
-                rx = right.x(x+lx, y+ly);
-                ry = right.y(x+lx, y+ly);
-                if (fabs(lx)+fabs(ly) > fabs(rx)+fabs(ry)) {
-                    lx = fabs(lx+rx);
-                    ly = fabs(ly+ry);
-                } else {
-                    lx = -fabs(lx+rx);
-                    ly = -fabs(ly+ry);
-                }
-            } else {
-                lx = fabs(lx);
-                rx = fabs(rx);
-            }
-            out.setX(x,y, lx);
-            out.setY(x,y, ly);
+    assert(left.width() == right.width() && left.height() == right.height());
+    assert(left.width() == out.width() && left.height() == out.height());
+
+    const int w = left.width();
+    const int h = left.height();
+    const float *l = left.data();
+    const float *r = right.data();
+    float *o = out.data();
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (w*h >= PARALLEL_MIN_PIXELS)
+#endif
+    for (int y = 0; y < h; y++) {
+        const float *lRow = l + 2*y*w;
+        float *oRow = o + 2*y*w;
+        for (int x = 0; x < w; x++) {
+            const float lx = lRow[2*x];
+            const float ly = lRow[2*x+1];
+            const int i = targetIndex(x, y, lx, ly, w, h);
+            const int iSafe = i < 0 ? 0 : i;
+            const float rx = i < 0 ? 0 : r[iSafe];
+            const float ry = i < 0 ? 0 : r[iSafe+1];
+            // Positive if the left vector is longer (L1) than the right one
+            const float sign = (std::fabs(lx)+std::fabs(ly) > std::fabs(rx)+std::fabs(ry)) ? 1 : -1;
+            // With no right vector, rx = ry = 0, this gives the absolute left vector.
+            oRow[2*x]   = (i < 0 ? 1 : sign) * std::fabs(lx+rx);
+            oRow[2*x+1] = (i < 0 ? 1 : sign) * std::fabs(ly+ry);
         }
     }
 }
@@ -335,22 +375,42 @@ void FlowTools_sV::refillCorner(FlowField_sV &field, int top, int left, CornerPo
 
 
 FlowField_sV* FlowTools_sV::median(const FlowField_sV *const fa, const FlowField_sV *const fb, const FlowField_sV *const fc)
+{
+    assert(fa != NULL);
+
+    FlowField_sV *ff = new FlowField_sV(fa->width(), fa->height());
+    median(fa, fb, fc, *ff);
+    return ff;
+}
+
+void FlowTools_sV::median(const FlowField_sV *const fa, const FlowField_sV *const fb, const FlowField_sV *const fc,
+                          FlowField_sV &out)
 {
     assert(fa != NULL);
     assert(fb != NULL);
     assert(fc != NULL);
-    assert(fa->width() == fb->width() && fa->width() == fc->width());
-    assert(fa->height() == fb->height() && fa->height() == fc->height());
+    assert(fa->width() == fb->width() && fa->width() == fc->width() && fa->width() == out.width());
+    assert(fa->height() == fb->height() && fa->height() == fc->height() && fa->height() == out.height());
 
-    int w = fa->width();
-    int h = fa->height();
-    FlowField_sV *ff = new FlowField_sV(w, h);
+    const int w = fa->width();
+    const int h = fa->height();
+    const float *da = fa->data();
+    const float *db = fb->data();
+    const float *dc = fc->data();
+    float *o = out.data();
 
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (w*h >= PARALLEL_MIN_PIXELS)
+#endif
     for (int y = 0; y < h; y++) {
-        for (int x = 0; x < w; x++) {
-            float a = fa->x(x,y)*fa->x(x,y) + fa->y(x,y)*fa->y(x,y);
-            float b = fb->x(x,y)*fb->x(x,y) + fb->y(x,y)*fb->y(x,y);
-            float c = fc->x(x,y)*fc->x(x,y) + fc->y(x,y)*fc->y(x,y);
+        // All inputs of a pixel are read before its output is written, so out may be one of the inputs.
+        for (int i = 2*y*w; i < 2*(y+1)*w; i += 2) {
+            const float ax = da[i], ay = da[i+1];
+            const float bx = db[i], by = db[i+1];
+            const float cx = dc[i], cy = dc[i+1];
+            const float a = ax*ax + ay*ay;
+            const float b = bx*bx + by*by;
+            const float c = cx*cx + cy*cy;
 
             // Determine the median
             // < a b c
@@ -358,20 +418,144 @@ FlowField_sV* FlowTools_sV::median(const FlowField_sV *const fa, const FlowField
             // b ? - ?
             // c ? ? -
             // The median element has SUM == 1 for its row
-            char detA = (a < b) + (a < c);
-            char detB = (b < a) + (b < c);
-
-            if (detA == 1) {
-                ff->rx(x,y) = fa->x(x,y);
-                ff->ry(x,y) = fa->y(x,y);
-            } else if (detB == 1) {
-                ff->rx(x,y) = fb->x(x,y);
-                ff->ry(x,y) = fb->y(x,y);
+            const bool isA = (a < b) + (a < c) == 1;
+            const bool isB = (b < a) + (b < c) == 1;
+
+            o[i]   = isA ? ax : (isB ? bx : cx);
+            o[i+1] = isA ? ay : (isB ? by : cy);
+        }
+    }
+}
+
+void FlowTools_sV::median(const FlowField_sV *const *fields, int count, FlowField_sV &out)
+{
+    assert(count > 0 && count % 2 == 1 && count <= MEDIAN_MAX_FIELDS);
+    if (count == 1) {
+        if (fields[0] != &out) {
+            std::copy(fields[0]->data(), fields[0]->data() + out.dataSize(), out.data());
+        }
+        return;
+    }
+    if (count == 3) {
+        median(fields[0], fields[1], fields[2], out);
+        return;
+    }
+
+    const int w = out.width();
+    const int h = out.height();
+    const float *d[MEDIAN_MAX_FIELDS];
+    for (int k = 0; k < count; k++) {
+        assert(fields[k]->width() == w && fields[k]->height() == h);
+        d[k] = fields[k]->data();
+    }
+    float *o = out.data();
+    const int mid = count/2;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if (w*h >= PARALLEL_MIN_PIXELS)
+#endif
+    for (int y = 0; y < h; y++) {
+        float len[MEDIAN_MAX_FIELDS];
+        for (int i = 2*y*w; i < 2*(y+1)*w; i += 2) {
+            for (int k = 0; k < count; k++) {
+                len[k] = d[k][i]*d[k][i] + d[k][i+1]*d[k][i+1];
+            }
+            // The median has at most mid shorter vectors, and more than mid shorter or equally long ones.
+            // With ties, the first such field is taken.
+            int m = 0;
+            for (int k = count-1; k >= 0; k--) {
+                int less = 0, lessEqual = 0;
+                for (int j = 0; j < count; j++) {
+                    less += len[j] < len[k];
+                    lessEqual += len[j] <= len[k];
+                }
+                m = (less <= mid && lessEqual > mid) ? k : m;
+            }
+            o[i] = d[m][i];
+            o[i+1] = d[m][i+1];
+        }
+    }
+}
+
+FlowField_sV* FlowTools_sV::upsampleJointBilateral(const FlowField_sV &flow, const QImage &guide,
+                                                   float sigmaSpatial, float sigmaColour)
+{
+    assert(flow.width() > 0 && flow.height() > 0);
+    assert(guide.width() >= flow.width() && guide.height() >= flow.height());
+
+    const int W = guide.width();
+    const int H = guide.height();
+    const int w = flow.width();
+    const int h = flow.height();
+    const float sx = float(w) / W;
+    const float sy = float(h) / H;
+    const int radius = qMax(1, int(std::ceil(2*sigmaSpatial)));
+
+    // The guide at flow resolution, i.e. the colour each flow vector belongs to
+    QImage full = guide.convertToFormat(QImage::Format_RGB32);
+    QImage lowRes = full.scaled(w, h, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    // Colour weights by the sum of the absolute RGB differences
+    QVector<float> colourWeight(3*255+1);
+    for (int d = 0; d < colourWeight.size(); d++) {
+        colourWeight[d] = std::exp(-.5f*d*d / (sigmaColour*sigmaColour));
+    }
+
+    // The spatial weight is separable; nearest low resolution pixel and the weights of
+    // its neighbours (offset k-radius) for each output column
+    const int taps = 2*radius+1;
+    QVector<int> centreX(W);
+    QVector<float> spatialX(W*taps);
+    for (int x = 0; x < W; x++) {
+        // Position of the pixel centre in low resolution coordinates
+        const float fx = (x+.5f)*sx - .5f;
+        centreX[x] = int(std::floor(fx + .5f));
+        for (int k = 0; k < taps; k++) {
+            const float dx = centreX[x] + k - radius - fx;
+            spatialX[x*taps + k] = std::exp(-.5f*dx*dx / (sigmaSpatial*sigmaSpatial));
+        }
+    }
+    QVector<float> spatialY(taps);
+
+    FlowField_sV *out = new FlowField_sV(W, H);
+    for (int y = 0; y < H; y++) {
+        const QRgb *guideLine = (const QRgb*) full.constScanLine(y);
+        const float fy = (y+.5f)*sy - .5f;
+        const int cy = int(std::floor(fy + .5f));
+        for (int k = 0; k < taps; k++) {
+            const float dy = cy + k - radius - fy;
+            spatialY[k] = std::exp(-.5f*dy*dy / (sigmaSpatial*sigmaSpatial));
+        }
+
+        for (int x = 0; x < W; x++) {
+            const QRgb c = guideLine[x];
+            const int cx = centreX[x];
+            const float *wx = spatialX.constData() + x*taps;
+
+            float sumU = 0, sumV = 0, sumW = 0;
+            for (int j = qMax(0, cy-radius); j <= qMin(h-1, cy+radius); j++) {
+                const QRgb *lowResLine = (const QRgb*) lowRes.constScanLine(j);
+                const float wy = spatialY[j - (cy-radius)];
+                for (int i = qMax(0, cx-radius); i <= qMin(w-1, cx+radius); i++) {
+                    const QRgb s = lowResLine[i];
+                    const int dc = qAbs(qRed(c)-qRed(s)) + qAbs(qGreen(c)-qGreen(s)) + qAbs(qBlue(c)-qBlue(s));
+                    const float weight = wx[i - (cx-radius)] * wy * colourWeight[dc];
+                    sumU += weight * flow.x(i, j);
+                    sumV += weight * flow.y(i, j);
+                    sumW += weight;
+                }
+            }
+            if (sumW > 0) {
+                out->rx(x, y) = sumU / sumW / sx;
+                out->ry(x, y) = sumV / sumW / sy;
             } else {
-                ff->rx(x,y) = fc->x(x,y);
-                ff->ry(x,y) = fc->y(x,y);
+                // All neighbours have a very different colour; use the nearest one.
+                const int i = qBound(0, cx, w-1);
+                const int j = qBound(0, cy, h-1);
+                out->rx(x, y) = flow.x(i, j) / sx;
+                out->ry(x, y) = flow.y(i, j) / sy;
             }
         }
     }
-    return ff;
+    return out;
 }
@@ -4,6 +4,11 @@
 #include "flowField_sV.h"
 #include "kernel_sV.h"
 
+class QImage;
+
+/// Maximum number of fields FlowTools_sV::median() combines
+#define MEDIAN_MAX_FIELDS 15
+
 class FlowTools_sV
 {
 public:
@@ -12,7 +17,17 @@ public:
 
     enum CornerPosition { TopLeft, TopRight, BottomLeft, BottomRight };
 
+    /**
+      \brief Forward/backward difference: each vector of \c left plus the \c right vector at the pixel it points to.
+
+      Vectors pointing outside the field are copied unchanged. \c out must have the size of the input fields.
+      */
     static void difference(const FlowField_sV &left, const FlowField_sV &right, FlowField_sV &out);
+    /**
+      \brief Like difference(), but with absolute components that are negative where the \c right vector is longer.
+
+      Vectors pointing outside the field are copied as absolute values.
+      */
     static void signedDifference(const FlowField_sV &left, const FlowField_sV &right, FlowField_sV &out);
 
     static void deleteRect(FlowField_sV &field, int top, int left, int bottom, int right);
@@ -28,6 +43,33 @@ public:
     static void refill(FlowField_sV &field, const Kernel_sV &kernel, int top, int left, int bottom, int right);
 
     static FlowField_sV* median(FlowField_sV const * const fa, FlowField_sV const * const fb, FlowField_sV const * const fc);
+    /**
+      \brief Writes the per-pixel median (by vector length) of the three flow fields to \c out.
+
+      \c out must have the size of the input fields and may be one of them, which filters in place.
+      */
+    static void median(FlowField_sV const * const fa, FlowField_sV const * const fb, FlowField_sV const * const fc,
+                       FlowField_sV &out);
+    /**
+      \brief Per-pixel median (by vector length) of an odd number of flow fields, at most \c MEDIAN_MAX_FIELDS.
+
+      For three fields the result is the same as for median(fa, fb, fc, out). \c out may be one of the fields.
+      */
+    static void median(FlowField_sV const * const *fields, int count, FlowField_sV &out);
+
+    /**
+      \brief Upsamples a flow field built at reduced resolution to the size of \c guide.
+
+      Joint bilateral upsampling: each output pixel is a weighted average of the surrounding
+      low resolution flow vectors. The weights fall off with the distance (\c sigmaSpatial,
+      in low resolution pixels) and with the colour difference between the output pixel and the
+      low resolution pixel in the guide image (\c sigmaColour, sum of the RGB differences),
+      so flow edges follow the edges of the full resolution frame.
+      The flow vectors are scaled to full resolution pixels.
+      \param guide Full resolution frame the flow was built for (the left frame)
+      */
+    static FlowField_sV* upsampleJointBilateral(const FlowField_sV &flow, const QImage &guide,
+                                                float sigmaSpatial = 1, float sigmaColour = 30);
 
 private:
     static void refillLine(FlowField_sV &field, int startTop, int startLeft, int length, LineFillMode fillMode);
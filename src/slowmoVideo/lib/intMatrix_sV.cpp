@@ -9,6 +9,7 @@ the Free Software Foundation, either version 3 of the License, or
 */
 
 #include "intMatrix_sV.h"
+#include "bufferPool_sV.h"
 
 #include <algorithm>
 
@@ -17,13 +18,13 @@ IntMatrix_sV::IntMatrix_sV(int width, int height, int channels) :
     m_height(height),
     m_channels(channels)
 {
-    m_data = new int[width*height*m_channels];
+    m_data = BufferPool_sV::instance()->acquireArray<int>(width*height*m_channels);
     std::fill(m_data, m_data + width*height*channels, 0);
 }
 
 IntMatrix_sV::~IntMatrix_sV()
 {
-    delete[] m_data;
+    BufferPool_sV::instance()->releaseArray(m_data, m_width*m_height*m_channels);
 }
 
 int IntMatrix_sV::width() const { return m_width; }
@@ -47,10 +48,14 @@ void IntMatrix_sV::operator /=(int divisor)
 unsigned char* IntMatrix_sV::toBytesArray() const
 {
     unsigned char *arr = new unsigned char[m_width*m_height*m_channels];
+    toBytes(arr);
+    return arr;
+}
+void IntMatrix_sV::toBytes(unsigned char *bytes) const
+{
     for (int i = 0; i < m_width*m_height*m_channels; i++) {
-        arr[i] = (unsigned char) m_data[i];
+        bytes[i] = (unsigned char) m_data[i];
     }
-    return arr;
 }
 const int* IntMatrix_sV::data() const
 {
@@ -15,6 +15,7 @@ the Free Software Foundation, either version 3 of the License, or
   \brief Simple matrix that can add image data to itself.
 
   This matrix is used for shutter simulation (i.e. motion blur).
+  The data is allocated from the BufferPool_sV.
 */
 class IntMatrix_sV
 {
@@ -41,6 +42,8 @@ public:
 
     /// Converts the image to a byte array. Internal values are stored as int.
     unsigned char* toBytesArray() const;
+    /// Like toBytesArray(), but writes to a buffer of width*height*channels bytes, e.g. a QImage
+    void toBytes(unsigned char *bytes) const;
     /// Image data.
     const int* data() const;
 
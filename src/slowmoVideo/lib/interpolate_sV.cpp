@@ -9,8 +9,10 @@ the Free Software Foundation, either version 3 of the License, or
 */
 
 #include "interpolate_sV.h"
+#include "floatImage_sV.h"
 #include "flowField_sV.h"
 #include "flowTools_sV.h"
+#include "consistencyMap_sV.h"
 #include "sourceField_sV.h"
 #include "vector_sV.h"
 #include "bezierTools_sV.h"
@@ -22,108 +24,43 @@ the Free Software Foundation, either version 3 of the License, or
 #endif
 
 #include <QDebug>
-#include <QImage>
-#include <QColor>
 
 #define CLAMP1(x) ( ((x) > 1.0) ? 1.0 : (x) )
 #define CLAMP(x,min,max) (  ((x) < (min)) ? (min) : ( ((x) > (max)) ? (max) : (x) )  )
 
 #define INTERPOLATE
-//#define FIX_FLOW
 #define FIX_BORDERS
 //#define DEBUG_I
 
-enum ColorComponent { CC_Red, CC_Green, CC_Blue };
-
-
-inline
-float interpR(const QColor cols[2][2], float x, float y)
-{
-    return (1-x)*(1-y) * cols[0][0].redF()
-        + x*(1-y) * cols[1][0].redF()
-        + y*(1-x) * cols[0][1].redF()
-        + x*y * cols[1][1].redF();
-}
-
-inline
-float interpG(const QColor cols[2][2], float x, float y)
-{
-    return (1-x)*(1-y) * cols[0][0].greenF()
-        + x*(1-y) * cols[1][0].greenF()
-        + y*(1-x) * cols[0][1].greenF()
-        + x*y * cols[1][1].greenF();
-}
-
-inline
-float interpB(const QColor cols[2][2], float x, float y)
-{
-    return (1-x)*(1-y) * cols[0][0].blueF()
-        + x*(1-y) * cols[1][0].blueF()
-        + y*(1-x) * cols[0][1].blueF()
-        + x*y * cols[1][1].blueF();
-}
-
-QColor Interpolate_sV::interpolate(const QImage& in, float x, float y)
-{
-#ifdef DEBUG_I
-    if (x >= in.width()-1 || y >= in.height()-1) {
-        Q_ASSERT(false);
-    }
-#endif
-    QColor carr[2][2];
-    int floorX = floor(x);
-    int floorY = floor(y);
-    carr[0][0] = QColor(in.pixel(floorX, floorY));
-    carr[0][1] = QColor(in.pixel(floorX, floorY+1));
-    carr[1][0] = QColor(in.pixel(floorX+1, floorY));
-    carr[1][1] = QColor(in.pixel(floorX+1, floorY+1));
-
-    float dx = x - floorX;
-    float dy = y - floorY;
-    QColor out = QColor::fromRgbF(
-                                  interpR(carr, dx, dy),
-                                  interpG(carr, dx, dy),
-                                  interpB(carr, dx, dy)
-                                 );
-    return out;
-}
-
-/// validated. correct.
-QColor Interpolate_sV::blend(const QColor &left, const QColor &right, float pos)
+/// Blends two colours, validated. correct.
+static inline void blend(const float *left, const float *right, float pos, float *out)
 {
     Q_ASSERT(pos >= 0 && pos <= 1);
-
-    float r = (1-pos)*left.redF()   + pos*right.redF();
-    float g = (1-pos)*left.greenF() + pos*right.greenF();
-    float b = (1-pos)*left.blueF()  + pos*right.blueF();
-    float a = (1-pos)*left.alphaF() + pos*right.alphaF();
-    r = CLAMP(r,0.0,1.0);
-    g = CLAMP(g,0.0,1.0);
-    b = CLAMP(b,0.0,1.0);
-    a = CLAMP(a,0.0,1.0);
-    return QColor::fromRgbF(r, g, b, a);
+    for (int c = 0; c < FloatImage_sV::CHANNELS; c++) {
+        out[c] = CLAMP((1-pos)*left[c] + pos*right[c], 0.0f, 1.0f);
+    }
 }
 
-void Interpolate_sV::blend(ColorMatrix4x4 &c, const QColor &blendCol, float posX, float posY)
+/**
+  \return The blend position \c pos, shifted towards the frame whose colour comes from a consistent flow.
+  \c pos is kept if there is no consistency map or if neither side is consistent.
+  */
+static inline float consistentPos(const ConsistencyMap_sV *consistency, float pos,
+                                  float leftX, float leftY, float rightX, float rightY)
 {
-    Q_ASSERT(posX >= 0 && posX <= 1);
-    Q_ASSERT(posY >= 0 && posY <= 1);
-
-    if (c.c00.alpha() == 0) { c.c00 = blendCol; }
-    else { c.c00 = blend(c.c00, blendCol, std::sqrt((1-posX) * (1-posY))); }
-
-    if (c.c10.alpha() == 0) { c.c10 = blendCol; }
-    else { c.c10 = blend(c.c10, blendCol, std::sqrt( posX * (1-posY))); }
-
-    if (c.c01.alpha() == 0) { c.c01 = blendCol; }
-    else { c.c01 = blend(c.c01, blendCol, std::sqrt((1-posX) * posY)); }
-
-    if (c.c11.alpha() == 0) { c.c11 = blendCol; }
-    else {c.c11 = blend(c.c11, blendCol, std::sqrt(posX * posY)); }
+    if (consistency == NULL) {
+        return pos;
+    }
+    float wLeft = (1-pos) * consistency->confidence(ConsistencyMap_sV::Frame_Left, leftX, leftY);
+    float wRight = pos * consistency->confidence(ConsistencyMap_sV::Frame_Right, rightX, rightY);
+    if (wLeft + wRight < 1e-3) {
+        return pos;
+    }
+    return wRight / (wLeft + wRight);
 }
 
-
-void Interpolate_sV::twowayFlow(const QImage &left, const QImage &right, const FlowField_sV *flowForward, const FlowField_sV *flowBackward, float pos, QImage &output)
+void Interpolate_sV::twowayFlow(const FloatImage_sV &left, const FloatImage_sV &right, const FlowField_sV *flowForward, const FlowField_sV *flowBackward, float pos, FloatImage_sV &output,
+                                const ConsistencyMap_sV *consistency)
 {
 #ifdef INTERPOLATE
     const float Wmax = left.width()-1.0001; // A little less than the maximum pixel to avoid out of bounds when interpolating
@@ -131,8 +68,10 @@ void Interpolate_sV::twowayFlow(const QImage &left, const QImage &right, const F
     float posX, posY;
 #endif
 
-    QColor colOut, colLeft, colRight;
+    float colLeft[4], colRight[4];
     float r,g,b;
+    float leftX, leftY;
+    float p;
     Interpolate_sV::Movement forward, backward;
 
     for (int y = 0; y < left.height(); y++) {
@@ -148,34 +87,35 @@ void Interpolate_sV::twowayFlow(const QImage &left, const QImage &right, const F
             posY = y - pos*forward.moveY;
             posX = CLAMP(posX, 0, Wmax);
             posY = CLAMP(posY, 0, Hmax);
-            colLeft = interpolate(left, posX, posY);
+            left.sample(posX, posY, colLeft);
+            leftX = posX;
+            leftY = posY;
 
             posX = x - (1-pos)*backward.moveX;
             posY = y - (1-pos)*backward.moveY;
             posX = CLAMP(posX, 0, Wmax);
             posY = CLAMP(posY, 0, Hmax);
-            colRight = interpolate(right, posX, posY);
+            right.sample(posX, posY, colRight);
+            p = consistentPos(consistency, pos, leftX, leftY, posX, posY);
 #else
-            colLeft = QColor(left.pixel(x - pos*forward.moveX, y - pos*forward.moveY));
-            colRight = QColor(right.pixel(x - (1-pos)*backward.moveX , y - (1-pos)*backward.moveY));
+            left.pixel(x - pos*forward.moveX, y - pos*forward.moveY, colLeft);
+            right.pixel(x - (1-pos)*backward.moveX , y - (1-pos)*backward.moveY, colRight);
+            leftX = x - pos*forward.moveX;
+            leftY = y - pos*forward.moveY;
+            p = consistentPos(consistency, pos, leftX, leftY, x - (1-pos)*backward.moveX, y - (1-pos)*backward.moveY);
 #endif
-            r = (1-pos)*colLeft.redF() + pos*colRight.redF();
-            g = (1-pos)*colLeft.greenF() + pos*colRight.greenF();
-            b = (1-pos)*colLeft.blueF() + pos*colRight.blueF();
-            colOut = QColor::fromRgbF(
-                                      CLAMP1(r),
-                                      CLAMP1(g),
-                                      CLAMP1(b)
-                                      );
-            output.setPixel(x,y, colOut.rgb());
+            r = (1-p)*colLeft[0] + p*colRight[0];
+            g = (1-p)*colLeft[1] + p*colRight[1];
+            b = (1-p)*colLeft[2] + p*colRight[2];
+            output.setPixel(x,y, CLAMP1(r), CLAMP1(g), CLAMP1(b));
         }
     }
 }
 
 
-void Interpolate_sV::newTwowayFlow(const QImage &left, const QImage &right,
+void Interpolate_sV::newTwowayFlow(const FloatImage_sV &left, const FloatImage_sV &right,
                                    const FlowField_sV *flowLeftRight, const FlowField_sV *flowRightLeft,
-                                   float pos, QImage &output)
+                                   float pos, FloatImage_sV &output, const ConsistencyMap_sV *consistency)
 {
     const int W = left.width();
     const int H = left.height();
@@ -188,13 +128,6 @@ void Interpolate_sV::newTwowayFlow(const QImage &left, const QImage &right,
 
     float aspect = 1 - (.5 + std::cos(M_PI*pos)/2);
 
-#if defined(FIX_FLOW)
-    FlowField_sV diffField(flowLeftRight->width(), flowLeftRight->height());
-    FlowTools_sV::difference(*flowLeftRight, *flowRightLeft, diffField);
-    float diffSum;
-    float tmpAspect;
-#endif
-
 #ifdef FIX_BORDERS
     bool leftOk;
     bool rightOk;
@@ -202,7 +135,8 @@ void Interpolate_sV::newTwowayFlow(const QImage &left, const QImage &right,
 
 
     float fx, fy;
-    QColor colLeft, colRight;
+    float leftX, leftY;
+    float colLeft[4], colRight[4], colOut[4];
     for (int y = 0; y < H; y++) {
         for (int x = 0; x < W; x++) {
 
@@ -211,84 +145,66 @@ void Interpolate_sV::newTwowayFlow(const QImage &left, const QImage &right,
             fy = leftSourcePixel.at(x,y).fromY;
             if (fx >= 0 && fx < W-1
                     && fy >= 0 && fy < H-1) {
-                colLeft = interpolate(left, fx, fy);
+                left.sample(fx, fy, colLeft);
                 leftOk = true;
             } else {
                 fx = leftSourcePixel.at(x,y).fromX;
                 fy = leftSourcePixel.at(x,y).fromY;
                 fx = CLAMP(fx, 0, W-1.01);
                 fy = CLAMP(fy, 0, H-1.01);
-                colLeft = interpolate(left, fx, fy);
+                left.sample(fx, fy, colLeft);
                 leftOk = false;
             }
+            leftX = fx;
+            leftY = fy;
 
             fx = rightSourcePixel.at(x,y).fromX;
             fy = rightSourcePixel.at(x,y).fromY;
             if (fx >= 0 && fx < W-1
                     && fy >= 0 && fy < H-1) {
-                colRight = interpolate(right, fx, fy);
+                right.sample(fx, fy, colRight);
                 rightOk = true;
             } else {
-                colRight = qRgb(0,255,0);
+                colRight[0] = 0; colRight[1] = 1; colRight[2] = 0; colRight[3] = 1;
                 rightOk = false;
             }
 
             if (leftOk && rightOk) {
-                output.setPixel(x,y, blend(colLeft, colRight, aspect).rgba());
+                blend(colLeft, colRight, consistentPos(consistency, aspect, leftX, leftY, fx, fy), colOut);
+                output.setPixel(x,y, colOut);
             } else if (rightOk) {
-                output.setPixel(x,y, colRight.rgba());
+                output.setPixel(x,y, colRight);
 //                output.setPixel(x,y, qRgb(255, 0, 0));
             } else if (leftOk) {
-                output.setPixel(x,y, colLeft.rgba());
+                output.setPixel(x,y, colLeft);
 //                output.setPixel(x,y, qRgb(0, 255, 0));
             } else {
-                output.setPixel(x,y, colLeft.rgba());
+                output.setPixel(x,y, colLeft);
             }
 #else
             fx = leftSourcePixel.at(x,y).fromX;
             fy = leftSourcePixel.at(x,y).fromY;
             fx = CLAMP(fx, 0, W-1.01);
             fy = CLAMP(fy, 0, H-1.01);
-            colLeft = interpolate(left, fx, fy);
-
-#ifdef FIX_FLOW
-            diffSum = diffField.x(fx, fy)+diffField.y(fx, fy);
-            if (diffSum > 5) {
-                tmpAspect = 0;
-            } else if (diffSum < -5) {
-                tmpAspect = 1;
-            } else {
-                tmpAspect = aspect;
-            }
-#endif
+            left.sample(fx, fy, colLeft);
+            leftX = fx;
+            leftY = fy;
 
             fx = rightSourcePixel.at(x,y).fromX;
             fy = rightSourcePixel.at(x,y).fromY;
             fx = CLAMP(fx, 0, W-1.01);
             fy = CLAMP(fy, 0, H-1.01);
-            colRight = interpolate(right, fx, fy);
-
-#ifdef FIX_FLOW
-            diffSum = diffField.x(fx, fy)+diffField.y(fx, fy);
-            if (diffSum < 5) {
-                tmpAspect = 0;
-            } else if (diffSum > -5) {
-                tmpAspect = 1;
-            }
-#endif
+            right.sample(fx, fy, colRight);
 
-#ifdef FIX_FLOW
-            output.setPixel(x,y, blend(colLeft, colRight, tmpAspect).rgba());
-#else
-            output.setPixel(x,y, blend(colLeft, colRight, aspect).rgba());
-#endif
+            blend(colLeft, colRight, consistentPos(consistency, aspect, leftX, leftY, fx, fy), colOut);
+            output.setPixel(x,y, colOut);
 
 #endif
         }
     }
 }
 
-void Interpolate_sV::forwardFlow(const QImage &left, const FlowField_sV *flow, float pos, QImage &output)
+void Interpolate_sV::forwardFlow(const FloatImage_sV &left, const FlowField_sV *flow, float pos, FloatImage_sV &output)
 {
     qDebug() << "Interpolating flow at offset " << pos;
 #ifdef INTERPOLATE
@@ -297,8 +213,8 @@ void Interpolate_sV::forwardFlow(const QImage &left, const FlowField_sV *flow, f
     const float Hmax = left.height()-1.0001;
 #endif
 
-    QColor colOut;
-    Interpolate_sV::Movement forward;    
+    float colOut[4];
+    Interpolate_sV::Movement forward;
 
     for (int y = 0; y < left.height(); y++) {
         for (int x = 0; x < left.width(); x++) {
@@ -312,16 +228,16 @@ void Interpolate_sV::forwardFlow(const QImage &left, const FlowField_sV *flow, f
             posY = y - pos*forward.moveY;
 	    posX = CLAMP(posX, 0, Wmax);
 	    posY = CLAMP(posY, 0, Hmax);
-	    colOut = interpolate(left, posX, posY);
+	    left.sample(posX, posY, colOut);
 #else
-            colOut = QColor(left.pixel(x - pos*forward.moveX, y - pos*forward.moveY));
+            left.pixel(x - pos*forward.moveX, y - pos*forward.moveY, colOut);
 #endif
-	    output.setPixel(x,y, colOut.rgb());
+	    output.setPixel(x,y, colOut[0], colOut[1], colOut[2]);
 	}
     }
 }
 
-void Interpolate_sV::newForwardFlow(const QImage &left, const FlowField_sV *flow, float pos, QImage &output)
+void Interpolate_sV::newForwardFlow(const FloatImage_sV &left, const FlowField_sV *flow, float pos, FloatImage_sV &output)
 {
     const int W = left.width();
     const int H = left.height();
@@ -332,6 +248,7 @@ void Interpolate_sV::newForwardFlow(const QImage &left, const FlowField_sV *flow
 
     // Draw the pixels
     float fx, fy;
+    float col[4];
     for (int y = 0; y < H; y++) {
         for (int x = 0; x < W; x++) {
             // Since interpolate() uses the floor()+1 values,
@@ -341,7 +258,8 @@ void Interpolate_sV::newForwardFlow(const QImage &left, const FlowField_sV *flow
             fx = CLAMP(fx, 0, W-1.01);
             fy = field.at(x,y).fromY;
             fy = CLAMP(fy, 0, H-1.01);
-            output.setPixel(x,y, interpolate(left, fx, fy).rgba());
+            left.sample(fx, fy, col);
+            output.setPixel(x,y, col);
         }
     }
 }
@@ -360,7 +278,7 @@ void Interpolate_sV::newForwardFlow(const QImage &left, const FlowField_sV *flow
      B next (can be NULL)
   \endcode
   */
-void Interpolate_sV::bezierFlow(const QImage &prev, const QImage &right, const FlowField_sV *flowPrevCurr, const FlowField_sV *flowCurrNext, float pos, QImage &output)
+void Interpolate_sV::bezierFlow(const FloatImage_sV &prev, const FloatImage_sV &right, const FlowField_sV *flowPrevCurr, const FlowField_sV *flowCurrNext, float pos, FloatImage_sV &output)
 {
     const float Wmax = prev.width()-1.0001;
     const float Hmax = prev.height()-1.0001;
@@ -369,7 +287,7 @@ void Interpolate_sV::bezierFlow(const QImage &prev, const QImage &right, const F
     Vector_sV Ta, Sa;
     float dist;
 
-    QColor colOut;
+    float colOut[4];
 
     for (int y = 0; y < prev.height(); y++) {
         for (int x = 0; x < prev.width(); x++) {
@@ -413,14 +331,14 @@ void Interpolate_sV::bezierFlow(const QImage &prev, const QImage &right, const F
             }
 #endif
 
-            colOut = interpolate(prev, position.x(), position.y());
+            prev.sample(position.x(), position.y(), colOut);
 
 #ifdef DEBUG_I
             if (y % 4 == 1 && x % 2 == 0) {
-                colOut = right.pixel(x, y);
+                right.pixel(x, y, colOut);
             }
 #endif
-            output.setPixel(x,y, colOut.rgb());
+            output.setPixel(x,y, colOut[0], colOut[1], colOut[2]);
 
         }
     }
@@ -8,13 +8,13 @@ the Free Software Foundation, either version 3 of the License, or
 (at your option) any later version.
 */
 
-#include <QtGui/QColor>
-
-class QImage;
+class FloatImage_sV;
 class FlowField_sV;
+class ConsistencyMap_sV;
 
 /**
   \short Provides interpolation methods between frames
+  The output image must have the same size as the input images.
   \todo Half resolution for optical flow
   */
 class Interpolate_sV {
@@ -40,18 +40,16 @@ class Interpolate_sV {
       Like twowayFlow(), but uses forward and backward flow correctly. See also newForwardFlow().
       */
     /**
-      \fn interpolate(const QImage &in, float x, float y)
-      \brief Interpolates the colour at position <code>(x|y)</code>.
-
-      \c x should fulfil \f$ 0 \leq x < width-1 \f$, same with y, to avoid reading outside the image.
-      Not tested inside the function for efficiency reasons.
+      The two-way methods optionally take the ConsistencyMap_sV of the frame pair; pixels whose flow
+      is inconsistent (e.g. occluded in the other frame) then contribute less to the output.
       */
-    static void forwardFlow(const QImage& left, const FlowField_sV *flow, float pos, QImage& output);
-    static void newForwardFlow(const QImage& left, const FlowField_sV *flow, float pos, QImage& output);
-    static void twowayFlow(const QImage& left, const QImage& right, const FlowField_sV *flowForward, const FlowField_sV *flowBackward, float pos, QImage& output);
-    static void newTwowayFlow(const QImage &left, const QImage &right, const FlowField_sV *flowLeftRight, const FlowField_sV *flowRightLeft, float pos, QImage &output);
-    static void bezierFlow(const QImage& left, const QImage& right, const FlowField_sV *flowCurrPrev, const FlowField_sV *flowCurrNext, float pos, QImage &output);
-    static QColor interpolate(const QImage& in, float x, float y);
+    static void forwardFlow(const FloatImage_sV& left, const FlowField_sV *flow, float pos, FloatImage_sV& output);
+    static void newForwardFlow(const FloatImage_sV& left, const FlowField_sV *flow, float pos, FloatImage_sV& output);
+    static void twowayFlow(const FloatImage_sV& left, const FloatImage_sV& right, const FlowField_sV *flowForward, const FlowField_sV *flowBackward, float pos, FloatImage_sV& output,
+                           const ConsistencyMap_sV *consistency = NULL);
+    static void newTwowayFlow(const FloatImage_sV &left, const FloatImage_sV &right, const FlowField_sV *flowLeftRight, const FlowField_sV *flowRightLeft, float pos, FloatImage_sV &output,
+                              const ConsistencyMap_sV *consistency = NULL);
+    static void bezierFlow(const FloatImage_sV& left, const FloatImage_sV& right, const FlowField_sV *flowCurrPrev, const FlowField_sV *flowCurrNext, float pos, FloatImage_sV &output);
 
 
 private:
@@ -59,11 +57,5 @@ private:
         float moveX;
         float moveY;
     };
-    struct ColorMatrix4x4 {
-        QColor c00, c10, c01, c11;
-    };
-
-    static void blend(ColorMatrix4x4& colors, const QColor &blendCol, float posX, float posY);
-    static QColor blend(const QColor& left, const QColor& right, float pos);
 
 };
@@ -0,0 +1,186 @@
+/*
+slowmoVideo creates slow-motion videos from normal-speed videos.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "profiler_sV.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QStringList>
+#include <algorithm>
+
+Profiler_sV::Timer::Timer(Stage stage, Profiler_sV *profiler) :
+    m_stage(stage),
+    m_profiler(profiler)
+{
+    if (m_profiler->isEnabled()) {
+        m_timer.start();
+    } else {
+        m_profiler = NULL;
+    }
+}
+
+Profiler_sV::Timer::~Timer()
+{
+    if (m_profiler != NULL) {
+        m_profiler->add(m_stage, m_timer.nsecsElapsed() / 1e6);
+    }
+}
+
+Profiler_sV* Profiler_sV::instance()
+{
+    static Profiler_sV profiler;
+    return &profiler;
+}
+
+Profiler_sV::Profiler_sV() :
+    m_enabled(false)
+{
+    reset();
+}
+
+void Profiler_sV::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+void Profiler_sV::add(Stage stage, double ms)
+{
+    Q_ASSERT(stage >= 0 && stage < Stage_Count);
+    QMutexLocker locker(&m_mutex);
+    m_current[stage] += ms;
+    m_currentCalls[stage]++;
+}
+
+void Profiler_sV::endFrame()
+{
+    if (!m_enabled) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    for (int s = 0; s < Stage_Count; s++) {
+        if (m_currentCalls[s] > 0) {
+            m_samples[s].append(m_current[s]);
+            m_calls[s] += m_currentCalls[s];
+        }
+        m_current[s] = 0;
+        m_currentCalls[s] = 0;
+    }
+    m_frames++;
+}
+
+void Profiler_sV::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_frames = 0;
+    for (int s = 0; s < Stage_Count; s++) {
+        m_current[s] = 0;
+        m_currentCalls[s] = 0;
+        m_samples[s].clear();
+        m_calls[s] = 0;
+    }
+}
+
+int Profiler_sV::frames() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_frames;
+}
+
+Profiler_sV::StageSummary Profiler_sV::summarize(Stage stage, QVector<float> samples, int calls)
+{
+    Q_ASSERT(samples.size() > 0);
+    std::sort(samples.begin(), samples.end());
+
+    StageSummary s;
+    s.stage = stage;
+    s.frames = samples.size();
+    s.calls = calls;
+    s.min = samples.first();
+    s.max = samples.last();
+    s.total = 0;
+    for (int i = 0; i < samples.size(); i++) {
+        s.total += samples.at(i);
+    }
+    s.mean = s.total / samples.size();
+    // Nearest rank: the smallest value with at least 95 % of the values not larger than it
+    int rank = (95*samples.size() + 99) / 100;
+    s.p95 = samples.at(qMax(rank, 1) - 1);
+    return s;
+}
+
+QList<Profiler_sV::StageSummary> Profiler_sV::summary() const
+{
+    QMutexLocker locker(&m_mutex);
+    QList<StageSummary> list;
+    for (int s = 0; s < Stage_Count; s++) {
+        if (m_samples[s].size() > 0) {
+            list << summarize(Stage(s), m_samples[s], m_calls[s]);
+        }
+    }
+    return list;
+}
+
+QString Profiler_sV::report() const
+{
+    QList<StageSummary> list = summary();
+    QString out = QString("Render profile for %1 frames, times in ms per frame\n").arg(frames());
+    out += QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+            .arg("stage", -12).arg("frames", 7).arg("calls", 7).arg("min", 10)
+            .arg("mean", 10).arg("p95", 10).arg("max", 10).arg("total", 12);
+    for (int i = 0; i < list.size(); i++) {
+        const StageSummary &s = list.at(i);
+        out += QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                .arg(toString(s.stage), -12).arg(s.frames, 7).arg(s.calls, 7)
+                .arg(s.min, 10, 'f', 2).arg(s.mean, 10, 'f', 2).arg(s.p95, 10, 'f', 2)
+                .arg(s.max, 10, 'f', 2).arg(s.total, 12, 'f', 1);
+    }
+    return out;
+}
+
+QString Profiler_sV::toJson() const
+{
+    QList<StageSummary> list = summary();
+    QStringList stages;
+    for (int i = 0; i < list.size(); i++) {
+        const StageSummary &s = list.at(i);
+        stages << QString("    {\"stage\": \"%1\", \"frames\": %2, \"calls\": %3, \"min_ms\": %4, \"mean_ms\": %5, "
+                          "\"p95_ms\": %6, \"max_ms\": %7, \"total_ms\": %8}")
+                  .arg(toString(s.stage)).arg(s.frames).arg(s.calls)
+                  .arg(s.min, 0, 'f', 3).arg(s.mean, 0, 'f', 3).arg(s.p95, 0, 'f', 3)
+                  .arg(s.max, 0, 'f', 3).arg(s.total, 0, 'f', 3);
+    }
+    return QString("{\n  \"frames\": %1,\n  \"stages\": [\n%2\n  ]\n}\n")
+            .arg(frames()).arg(stages.join(",\n"));
+}
+
+QString Profiler_sV::toString(Stage stage)
+{
+    switch (stage) {
+    case Stage_Frame:
+        return "frame";
+    case Stage_Decode:
+        return "decode";
+    case Stage_FlowBuild:
+        return "flowBuild";
+    case Stage_FlowLoad:
+        return "flowLoad";
+    case Stage_SourceField:
+        return "sourceField";
+    case Stage_Inpaint:
+        return "inpaint";
+    case Stage_Interpolate:
+        return "interpolate";
+    case Stage_Blur:
+        return "blur";
+    case Stage_Encode:
+        return "encode";
+    default:
+        return "unknown";
+    }
+}
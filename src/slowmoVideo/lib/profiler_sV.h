@@ -0,0 +1,128 @@
+/*
+slowmoVideo creates slow-motion videos from normal-speed videos.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef PROFILER_SV_H
+#define PROFILER_SV_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+/**
+  \brief Measures how much time the stages of rendering take.
+
+  Code which belongs to a stage is measured with a Profiler_sV::Timer on the stack:
+  \code
+  {
+      Profiler_sV::Timer timer(Profiler_sV::Stage_Inpaint);
+      field.inpaint();
+  }
+  \endcode
+  The times of a stage are summed up until endFrame() is called after each rendered frame,
+  so the statistics are per rendered frame; frames in which a stage did not run are not included
+  for this stage. Stages may contain other stages (e.g. interpolating contains loading the flow),
+  the time of a stage includes the time of the stages inside.
+
+  Profiling is disabled by default; timers are then not started.
+  */
+class Profiler_sV
+{
+public:
+    enum Stage {
+        /// Whole frame, from the render task
+        Stage_Frame = 0,
+        /// Reading input frames and cached frames
+        Stage_Decode,
+        /// Calculating optical flow
+        Stage_FlowBuild,
+        /// Reading optical flow from the cache
+        Stage_FlowLoad,
+        /// Converting flow to source fields
+        Stage_SourceField,
+        /// Filling holes in source fields
+        Stage_Inpaint,
+        /// Interpolating a frame, including reading frames and flow
+        Stage_Interpolate,
+        /// Motion blur, including the interpolated frames it needs
+        Stage_Blur,
+        /// Passing the frame to the render target, i.e. encoding or waiting for the writers
+        Stage_Encode,
+        Stage_Count
+    };
+
+    /// Statistics of a stage, times in milliseconds
+    struct StageSummary {
+        Stage stage;
+        /// Number of frames in which the stage ran
+        int frames;
+        /// Number of times the stage ran
+        int calls;
+        double min;
+        double mean;
+        /// 95th percentile (nearest rank)
+        double p95;
+        double max;
+        double total;
+    };
+
+    /// Measures the time from construction to destruction for a stage
+    class Timer {
+    public:
+        Timer(Stage stage, Profiler_sV *profiler = Profiler_sV::instance());
+        ~Timer();
+    private:
+        Stage m_stage;
+        Profiler_sV *m_profiler;
+        QElapsedTimer m_timer;
+    };
+
+    /// \return The profiler used by the render core
+    static Profiler_sV* instance();
+
+    Profiler_sV();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    /// Adds \c ms milliseconds to the stage in the current frame
+    void add(Stage stage, double ms);
+    /// Ends the current frame
+    void endFrame();
+    /// Discards all measurements
+    void reset();
+
+    /// \return The number of frames ended since the last reset
+    int frames() const;
+    /// \return Statistics for all stages which ran at least once
+    QList<StageSummary> summary() const;
+    /// \return A table with the statistics
+    QString report() const;
+    /// \return The statistics as JSON object
+    QString toJson() const;
+
+    static QString toString(Stage stage);
+
+private:
+    mutable QMutex m_mutex;
+    bool m_enabled;
+    int m_frames;
+    /// Time per stage in the current frame
+    double m_current[Stage_Count];
+    int m_currentCalls[Stage_Count];
+    /// Time per stage and frame
+    QVector<float> m_samples[Stage_Count];
+    int m_calls[Stage_Count];
+
+    static StageSummary summarize(Stage stage, QVector<float> samples, int calls);
+};
+
+#endif // PROFILER_SV_H
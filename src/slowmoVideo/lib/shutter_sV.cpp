@@ -10,9 +10,8 @@ the Free Software Foundation, either version 3 of the License, or
 
 #include "flowField_sV.h"
 #include "sourceField_sV.h"
-#include "interpolate_sV.h"
-#include "intMatrix_sV.h"
 #include "shutter_sV.h"
+#include "profiler_sV.h"
 
 #include <QtCore/QStringList>
 #include <QtCore/QDebug>
@@ -25,46 +24,88 @@ the Free Software Foundation, either version 3 of the License, or
 
 #define MIN_DIST 0.01
 
+/// Reads an image (usually a cached frame) as float image
+static FloatImage_sV load(const QString &filename)
+{
+    Profiler_sV::Timer timer(Profiler_sV::Stage_Decode);
+    return FloatImage_sV::fromImage(QImage(filename));
+}
 
-QImage Shutter_sV::combine(const QStringList images)
+Shutter_sV::Accumulator::Accumulator() :
+    m_count(0)
 {
-    Q_ASSERT(images.size() > 0);
+}
 
-    QImage img(images.at(0));
-    IntMatrix_sV matrix(img.width(), img.height(), 4);
-    for (int i = 0; i < images.size(); i++) {
-        img = QImage(images.at(i));
-        matrix += img.bits();
+void Shutter_sV::Accumulator::add(const FloatImage_sV &image)
+{
+    if (m_count == 0) {
+        m_sum = image;
+    } else {
+        accumulate(m_sum, image);
     }
-    matrix /= images.size();
-
-    unsigned char *bytes = matrix.toBytesArray();
-    QImage result(matrix.width(), matrix.height(), QImage::Format_ARGB32);
-    std::copy(bytes, bytes+matrix.width()*matrix.height()*matrix.channels()+1, result.bits());
-    delete[] bytes;
+    m_count++;
+}
 
+FloatImage_sV Shutter_sV::Accumulator::average()
+{
+    Q_ASSERT(m_count > 0);
+    FloatImage_sV result;
+    result.swap(m_sum);
+    divide(result, m_count);
+    m_count = 0;
     return result;
 }
 
-QImage Shutter_sV::combine(const QList<QImage> images)
+FloatImage_sV Shutter_sV::combine(const QStringList images)
 {
     Q_ASSERT(images.size() > 0);
 
-    IntMatrix_sV matrix(images.at(0).width(), images.at(0).height(), 4);
+    Accumulator sum;
     for (int i = 0; i < images.size(); i++) {
-        matrix += images.at(i).bits();
+        sum.add(load(images.at(i)));
     }
-    matrix /= images.size();
+    return sum.average();
+}
 
-    unsigned char *bytes = matrix.toBytesArray();
-    QImage result(matrix.width(), matrix.height(), QImage::Format_ARGB32);
-    std::copy(bytes, bytes+matrix.width()*matrix.height()*matrix.channels()+1, result.bits());
-    delete[] bytes;
+FloatImage_sV Shutter_sV::combine(const QList<FloatImage_sV> &images)
+{
+    Q_ASSERT(images.size() > 0);
 
-    return result;
+    Accumulator sum;
+    for (int i = 0; i < images.size(); i++) {
+        sum.add(images.at(i));
+    }
+    return sum.average();
+}
+
+void Shutter_sV::accumulate(FloatImage_sV &sum, const FloatImage_sV &image)
+{
+    Q_ASSERT(sum.size() == image.size());
+    for (int c = 0; c < FloatImage_sV::CHANNELS; c++) {
+        for (int y = 0; y < sum.height(); y++) {
+            float *out = sum.scanLine(FloatImage_sV::Channel(c), y);
+            const float *in = image.scanLine(FloatImage_sV::Channel(c), y);
+            for (int x = 0; x < sum.width(); x++) {
+                out[x] += in[x];
+            }
+        }
+    }
 }
 
-QImage Shutter_sV::convolutionBlur(const QImage source, const FlowField_sV *flow, float length)
+void Shutter_sV::divide(FloatImage_sV &sum, int count)
+{
+    const float factor = 1.0f/count;
+    for (int c = 0; c < FloatImage_sV::CHANNELS; c++) {
+        for (int y = 0; y < sum.height(); y++) {
+            float *out = sum.scanLine(FloatImage_sV::Channel(c), y);
+            for (int x = 0; x < sum.width(); x++) {
+                out[x] *= factor;
+            }
+        }
+    }
+}
+
+FloatImage_sV Shutter_sV::convolutionBlur(const FloatImage_sV &source, const FlowField_sV *flow, float length)
 {
     Q_ASSERT(source.width() == flow->width());
     Q_ASSERT(source.height() == flow->height());
@@ -72,14 +113,14 @@ QImage Shutter_sV::convolutionBlur(const QImage source, const FlowField_sV *flow
     const float Wmax = source.width()-1.001;
     const float Hmax = source.height()-1.001;
 
-    QImage blurred(source.size(), source.format());
-    ColorStack stack;
+    FloatImage_sV blurred(source.size());
+    float sum[4], col[4];
+    int count;
     float dx, dy;
     float xf, yf;
     int samples, inc;
     for (int y = 0; y < source.height(); y++) {
         for (int x = 0; x < source.width(); x++) {
-            stack = ColorStack();
             dx = length * flow->x(x,y);
             dy = length * flow->y(x,y);
             dx = CLAMP(x+dx, 0.0, Wmax)-x;
@@ -93,18 +134,22 @@ QImage Shutter_sV::convolutionBlur(const QImage source, const FlowField_sV *flow
 
             xf = CLAMP(x, 0.0, Wmax);
             yf = CLAMP(y, 0.0, Hmax);
-            stack.add(source.pixel(x,y)); // Avoids interpolation error, and interpolation for (x,y) is not necessary anyway
+            source.pixel(x, y, sum); // Avoids interpolation error, and interpolation for (x,y) is not necessary anyway
+            count = 1;
             for (int i = 1; i <= samples; i += inc) {
                 // \todo adjust increment
-                stack.add(Interpolate_sV::interpolate(source, xf+float(i)/samples * dx, yf+float(i)/samples * dy));
+                source.sample(xf+float(i)/samples * dx, yf+float(i)/samples * dy, col);
+                for (int c = 0; c < 4; c++) { sum[c] += col[c]; }
+                count++;
             }
-            blurred.setPixel(x, y, stack.col().rgba());
+            for (int c = 0; c < 4; c++) { sum[c] /= count; }
+            blurred.setPixel(x, y, sum);
         }
     }
     return blurred;
 }
 
-QImage Shutter_sV::convolutionBlur(const QImage interpolatedAtOffset, const FlowField_sV *flow, float length, float offset)
+FloatImage_sV Shutter_sV::convolutionBlur(const FloatImage_sV &interpolatedAtOffset, const FlowField_sV *flow, float length, float offset)
 {
     Q_ASSERT(interpolatedAtOffset.width() == flow->width());
     Q_ASSERT(interpolatedAtOffset.height() == flow->height());
@@ -117,14 +162,14 @@ QImage Shutter_sV::convolutionBlur(const QImage interpolatedAtOffset, const Flow
     const float Wmax = interpolatedAtOffset.width()-1.01;
     const float Hmax = interpolatedAtOffset.height()-1.01;
 
-    QImage blurred(interpolatedAtOffset.size(), interpolatedAtOffset.format());
-    ColorStack stack;
+    FloatImage_sV blurred(interpolatedAtOffset.size());
+    float sum[4], col[4];
+    int count;
     float dx, dy;
     float xf, yf;
     int samples, inc;
     for (int y = 0; y < interpolatedAtOffset.height(); y++) {
         for (int x = 0; x < interpolatedAtOffset.width(); x++) {
-            stack = ColorStack();
             dx = -(source.at(x,y).fromX - x); // Get the optical flow vector back from the source field
             dy = -(source.at(x,y).fromY - y);
             dx = dx/offset * length; // First normalize to one frame, then adjust the length
@@ -140,32 +185,18 @@ QImage Shutter_sV::convolutionBlur(const QImage interpolatedAtOffset, const Flow
 
             xf = CLAMP(x, 0.0, Wmax);
             yf = CLAMP(y, 0.0, Hmax);
-            stack.add(interpolatedAtOffset.pixel(x,y)); // Avoids interpolation error, and interpolation for (x,y) is not necessary anyway
+            interpolatedAtOffset.pixel(x, y, sum); // Avoids interpolation error, and interpolation for (x,y) is not necessary anyway
+            count = 1;
             for (int i = 1; i <= samples; i += inc) {
                 // \todo adjust increment
-                stack.add(Interpolate_sV::interpolate(interpolatedAtOffset, xf+float(i)/samples * dx, yf+float(i)/samples * dy));
+                interpolatedAtOffset.sample(xf+float(i)/samples * dx, yf+float(i)/samples * dy, col);
+                for (int c = 0; c < 4; c++) { sum[c] += col[c]; }
+                count++;
             }
-            blurred.setPixel(x, y, stack.col().rgba());
+            for (int c = 0; c < 4; c++) { sum[c] /= count; }
+            blurred.setPixel(x, y, sum);
         }
     }
     return blurred;
 
 }
-
-Shutter_sV::ColorStack::ColorStack() :
-    r(0), g(0), b(0), a(0), count(0)
-{}
-
-void Shutter_sV::ColorStack::add(QColor col)
-{
-    r += col.redF();
-    g += col.greenF();
-    b += col.blueF();
-    a += col.alphaF();
-    ++count;
-}
-
-QColor Shutter_sV::ColorStack::col()
-{
-    return QColor::fromRgbF(r/count, g/count, b/count, a/count);
-}
@@ -11,7 +11,10 @@ the Free Software Foundation, either version 3 of the License, or
 #ifndef SHUTTER_SV_H
 #define SHUTTER_SV_H
 
-#include <QtGui/QImage>
+#include "floatImage_sV.h"
+
+#include <QtCore/QList>
+#include <QtCore/QStringList>
 
 class FlowField_sV;
 
@@ -19,24 +22,39 @@ class FlowField_sV;
 class Shutter_sV
 {
 public:
+    /**
+      \brief Averages images which are added one after another.
+
+      Only the running sum is kept in memory, so the images can be discarded right after adding them.
+      */
+    class Accumulator
+    {
+    public:
+        Accumulator();
+        /// Adds \c image to the sum. All images must have the same size.
+        void add(const FloatImage_sV &image);
+        int count() const { return m_count; }
+        /// \return The average of the added images; the accumulator is empty afterwards.
+        FloatImage_sV average();
+
+    private:
+        FloatImage_sV m_sum;
+        int m_count;
+    };
+
     /// Combines the given images to a new image by addition and division.
-    static QImage combine(const QStringList images);
-    static QImage combine(const QList<QImage> images);
+    static FloatImage_sV combine(const QStringList images);
+    static FloatImage_sV combine(const QList<FloatImage_sV> &images);
 
-    static QImage convolutionBlur(const QImage source, const FlowField_sV *flow, float length);
-    static QImage convolutionBlur(const QImage interpolatedAtOffset, const FlowField_sV *flow, float length, float offset);
+    static FloatImage_sV convolutionBlur(const FloatImage_sV &source, const FlowField_sV *flow, float length);
+    static FloatImage_sV convolutionBlur(const FloatImage_sV &interpolatedAtOffset, const FlowField_sV *flow, float length, float offset);
 
 
 private:
-
-    struct ColorStack {
-        ColorStack();
-        void add(QColor col);
-        QColor col();
-    private:
-        float r, g, b, a;
-        int count;
-    };
+    /// Adds \c image to \c sum, channel by channel
+    static void accumulate(FloatImage_sV &sum, const FloatImage_sV &image);
+    /// Divides all channels by \c count
+    static void divide(FloatImage_sV &sum, int count);
 
 };
 
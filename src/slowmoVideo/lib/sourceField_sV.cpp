@@ -10,7 +10,10 @@ the Free Software Foundation, either version 3 of the License, or
 
 #include "sourceField_sV.h"
 #include "flowField_sV.h"
+#include "bufferPool_sV.h"
+#include "profiler_sV.h"
 #include <algorithm>
+#include <memory>
 #include <cmath>
 
 #define FIX_FLOW
@@ -19,7 +22,8 @@ SourceField_sV::SourceField_sV(int width, int height) :
     m_width(width),
     m_height(height)
 {
-    m_field = new Source[width*height];
+    m_field = allocate(width*height);
+    std::uninitialized_fill(m_field, m_field+width*height, Source());
 }
 
 
@@ -27,8 +31,8 @@ SourceField_sV::SourceField_sV(const SourceField_sV &other) :
     m_width(other.m_width),
     m_height(other.m_height)
 {
-    m_field = new Source[m_width*m_height];
-    std::copy(other.m_field, other.m_field+m_width*m_height, m_field);
+    m_field = allocate(m_width*m_height);
+    std::uninitialized_copy(other.m_field, other.m_field+m_width*m_height, m_field);
 }
 
 
@@ -37,7 +41,9 @@ SourceField_sV::SourceField_sV(const FlowField_sV *flow, float pos) :
     m_width(flow->width()),
     m_height(flow->height())
 {
-    m_field = new Source[m_width*m_height];
+    Profiler_sV::Timer timer(Profiler_sV::Stage_SourceField);
+    m_field = allocate(m_width*m_height);
+    std::uninitialized_fill(m_field, m_field+m_width*m_height, Source());
 
     for (int y = 0; y < m_height; y++) {
         for (int x = 0; x < m_width; x++) {
@@ -64,11 +70,18 @@ SourceField_sV::SourceField_sV(const FlowField_sV *flow, float pos) :
 
 SourceField_sV::~SourceField_sV()
 {
-    delete[] m_field;
+    BufferPool_sV::instance()->releaseArray(m_field, m_width*m_height);
+}
+
+SourceField_sV::Source* SourceField_sV::allocate(int size)
+{
+    // Source is trivially destructible, so the memory can be handed back without destroying the elements.
+    return BufferPool_sV::instance()->acquireArray<Source>(size);
 }
 
 void SourceField_sV::inpaint()
 {
+    Profiler_sV::Timer timer(Profiler_sV::Stage_Inpaint);
     Source pos;
     SourceSum sum;
     int dist;
@@ -130,10 +143,10 @@ SourceField_sV& SourceField_sV::operator =(const SourceField_sV &other)
 {
     if (this != &other) {
         if (other.m_width != m_width || other.m_height != m_height) {
+            BufferPool_sV::instance()->releaseArray(m_field, m_width*m_height);
             m_width = other.m_width;
             m_height = other.m_height;
-            delete m_field;
-            m_field = new Source[m_width*m_height];
+            m_field = allocate(m_width*m_height);
         }
         std::copy(other.m_field, other.m_field+m_width*m_height, m_field);
     }
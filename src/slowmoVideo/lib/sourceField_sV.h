@@ -108,6 +108,9 @@ private:
     int m_width;
     int m_height;
 
+    /// Takes an uninitialized array from the BufferPool_sV; source fields are created for each rendered frame.
+    static Source* allocate(int size);
+
     struct SourceSum {
         float x;
         float y;
@@ -9,13 +9,180 @@ the Free Software Foundation, either version 3 of the License, or
 */
 
 #include "abstractFlowSource_sV.h"
+#include "project_sV.h"
+#include "abstractFrameSource_sV.h"
+#include "cacheManager_sV.h"
+#include "../lib/flowField_sV.h"
+#include "../lib/flowRW_sV.h"
+#include "../lib/flowTools_sV.h"
+#include "../lib/profiler_sV.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtGui/QImage>
 
 AbstractFlowSource_sV::AbstractFlowSource_sV(Project_sV *project) :
-    m_project(project)
+    m_project(project),
+    m_warmStart(false),
+    m_smallInit(false),
+    m_scale(1)
+{
+}
+
+const QString AbstractFlowSource_sV::consistencyPath(const uint leftFrame, const uint rightFrame, const FrameSize frameSize) const
+{
+    QFileInfo flow(flowPath(qMin(leftFrame, rightFrame), qMax(leftFrame, rightFrame), frameSize));
+    return flow.dir().absoluteFilePath(flow.completeBaseName() + ".sVcons");
+}
+
+void AbstractFlowSource_sV::setScale(float scale)
+{
+    Q_ASSERT(scale > 0 && scale <= 1);
+    m_scale = scale;
+}
+
+float AbstractFlowSource_sV::scale() const
+{
+    return m_scale;
+}
+
+void AbstractFlowSource_sV::setWarmStart(bool warmStart)
 {
+    m_warmStart = warmStart;
+}
+
+bool AbstractFlowSource_sV::warmStart() const
+{
+    return m_warmStart;
+}
+
+void AbstractFlowSource_sV::setSmallInit(bool smallInit)
+{
+    m_smallInit = smallInit;
+}
+
+bool AbstractFlowSource_sV::smallInit() const
+{
+    return m_smallInit;
+}
+
+QString AbstractFlowSource_sV::warmStartFlowPath(uint leftFrame, uint rightFrame, FrameSize frameSize)
+{
+    if (!m_warmStart) {
+        return QString();
+    }
+
+    // Frames are rendered in increasing order, so the previous pair is usually the one available.
+    // The flow has to be the one the flow builder created, at the same scale.
+    if (leftFrame > 0 && rightFrame > 0) {
+        QString path = buildFlowPath(leftFrame-1, rightFrame-1, frameSize);
+        if (QFile(path).exists()) {
+            return path;
+        }
+    }
+    int64_t count = m_project->frameSource()->framesCount();
+    if (leftFrame+1 < count && rightFrame+1 < count) {
+        QString path = buildFlowPath(leftFrame+1, rightFrame+1, frameSize);
+        if (QFile(path).exists()) {
+            return path;
+        }
+    }
+    return QString();
 }
 
 Project_sV* AbstractFlowSource_sV::project()
 {
     return m_project;
 }
+
+QString AbstractFlowSource_sV::initialFlowPath(uint leftFrame, uint rightFrame, FrameSize frameSize)
+{
+    if (m_smallInit && frameSize == FrameSize_Orig) {
+        QString path = flowPath(leftFrame, rightFrame, FrameSize_Small);
+        if (QFile(path).exists()) {
+            m_project->cacheManager()->recordAccess(path);
+            return path;
+        }
+    }
+    return warmStartFlowPath(leftFrame, rightFrame, frameSize);
+}
+
+bool AbstractFlowSource_sV::isScaled(FrameSize frameSize) const
+{
+    return frameSize == FrameSize_Orig && m_scale < 1;
+}
+
+QString AbstractFlowSource_sV::scaleTag(FrameSize frameSize) const
+{
+    if (isScaled(frameSize)) {
+        return QString("-scale%1").arg(m_scale, 0, 'f', 2);
+    }
+    return QString();
+}
+
+QString AbstractFlowSource_sV::initTag(FrameSize frameSize) const
+{
+    if (m_smallInit && frameSize == FrameSize_Orig) {
+        return "-smallInit";
+    }
+    return QString();
+}
+
+QString AbstractFlowSource_sV::warmStartTag() const
+{
+    if (m_warmStart) {
+        return "-warm";
+    }
+    return QString();
+}
+
+QString AbstractFlowSource_sV::inputFramePath(uint frame, FrameSize frameSize) throw(FlowBuildingError)
+{
+    if (!isScaled(frameSize)) {
+        return m_project->frameSource()->framePath(frame, frameSize);
+    }
+
+    QString path = m_project->getDirectory("cache/framesScaled")
+            .absoluteFilePath(QString("frame%1%2.png").arg(frame, 5, 10, QChar('0')).arg(scaleTag(frameSize)));
+    if (!QFile(path).exists()) {
+        QImage img = m_project->frameSource()->frameAt(frame, frameSize);
+        QSize size(qMax(1, qRound(img.width()*m_scale)), qMax(1, qRound(img.height()*m_scale)));
+        if (img.isNull() || !img.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation).save(path)) {
+            throw FlowBuildingError(QString("Could not create the scaled frame %1").arg(path));
+        }
+    }
+    m_project->cacheManager()->recordAccess(path);
+    return path;
+}
+
+QString AbstractFlowSource_sV::buildFlowPath(uint leftFrame, uint rightFrame, FrameSize frameSize)
+{
+    QString path = flowPath(leftFrame, rightFrame, frameSize);
+    if (isScaled(frameSize)) {
+        path = m_project->getDirectory("cache/oFlowScaled").absoluteFilePath(QFileInfo(path).fileName());
+    }
+    return path;
+}
+
+void AbstractFlowSource_sV::upsampleFlow(const QString &lowResPath, const QString &path, uint leftFrame, FrameSize frameSize) throw(FlowBuildingError)
+{
+    Profiler_sV::Timer timer(Profiler_sV::Stage_FlowBuild);
+    FlowField_sV *lowRes;
+    try {
+        lowRes = FlowRW_sV::load(lowResPath.toStdString());
+    } catch (FlowRW_sV::FlowRWError &err) {
+        throw FlowBuildingError(err.message.c_str());
+    }
+    QImage guide = m_project->frameSource()->frameAt(leftFrame, frameSize);
+    if (guide.isNull() || guide.width() < lowRes->width() || guide.height() < lowRes->height()) {
+        delete lowRes;
+        throw FlowBuildingError(QString("Cannot upsample the flow %1 with frame %2").arg(lowResPath).arg(leftFrame));
+    }
+
+    FlowField_sV *flow = FlowTools_sV::upsampleJointBilateral(*lowRes, guide);
+    FlowRW_sV::save(path.toStdString(), flow);
+    qDebug() << "Upsampled flow from " << lowRes->width() << "x" << lowRes->height() << " to " << flow->width() << "x" << flow->height();
+    delete lowRes;
+    delete flow;
+    m_project->cacheManager()->recordAccess(lowResPath);
+}
@@ -26,6 +26,37 @@ public:
     virtual FlowField_sV* buildFlow(uint leftFrame, uint rightFrame, FrameSize frameSize) throw(FlowBuildingError) = 0;
     /** \return The path to the flow file for the given frames */
     virtual const QString flowPath(const uint leftFrame, const uint rightFrame, const FrameSize frameSize = FrameSize_Orig) const = 0;
+    /** \return Short name of the flow method, used to tell apart cached files built with different methods */
+    virtual const QString identifier() const = 0;
+    /** \return The path to the ConsistencyMap_sV of the frame pair, next to the forward flow file */
+    const QString consistencyPath(const uint leftFrame, const uint rightFrame, const FrameSize frameSize = FrameSize_Orig) const;
+
+    /**
+      With warm start enabled, the flow of a frame pair is initialised with the flow of the
+      neighbouring pair (if it has already been built) and computed with fewer iterations.
+      This speeds up building the flow of a whole clip since neighbouring pairs usually move similarly.
+      The result differs from the flow built without warm start, therefore it is part of the flow file names,
+      see warmStartTag().
+      */
+    void setWarmStart(bool warmStart);
+    bool warmStart() const;
+
+    /**
+      Flow for FrameSize_Orig is built on frames scaled by \c scale (e.g. 0.5 or 0.25) and then
+      upsampled to the original size with FlowTools_sV::upsampleJointBilateral(). 1 disables scaling.
+      The scale is part of the flow file names, see scaleTag().
+      */
+    void setScale(float scale);
+    float scale() const;
+
+    /**
+      With small init enabled, the flow for FrameSize_Orig is initialised with the flow of the same pair
+      built for FrameSize_Small (e.g. while previewing), if there is one. The result then depends on whether
+      a preview has been rendered before, therefore it is disabled by default and part of the flow file names,
+      see initTag().
+      */
+    void setSmallInit(bool smallInit);
+    bool smallInit() const;
 
 public slots:
     /**
@@ -38,8 +69,40 @@ public slots:
 protected:
     Project_sV* project();
 
+    /**
+      \return The path to an existing flow file of a temporally adjacent frame pair in the same direction
+      (i.e. \c leftFrame-1 to \c rightFrame-1 or \c leftFrame+1 to \c rightFrame+1), or an empty string
+      if warm start is disabled or none has been built yet.
+      */
+    QString warmStartFlowPath(uint leftFrame, uint rightFrame, FrameSize frameSize);
+
+    /**
+      \return The flow to initialise the flow of this pair with, or an empty string.
+      For FrameSize_Orig with small init enabled this is the flow of the same pair built for FrameSize_Small,
+      which has to be upsampled by the flow builder; otherwise warmStartFlowPath().
+      */
+    QString initialFlowPath(uint leftFrame, uint rightFrame, FrameSize frameSize);
+
+    /** \return \c true if the flow for this frame size is built at a reduced scale */
+    bool isScaled(FrameSize frameSize) const;
+    /** \return Suffix for the flow file names which identifies the scale, empty if not scaled */
+    QString scaleTag(FrameSize frameSize) const;
+    /** \return Suffix for the flow file names which identifies the initialisation, empty without small init */
+    QString initTag(FrameSize frameSize) const;
+    /** \return Suffix for the flow file names which identifies warm start, empty without warm start */
+    QString warmStartTag() const;
+    /** \return Path to the frame the flow is built from; a scaled copy is created if necessary. */
+    QString inputFramePath(uint frame, FrameSize frameSize) throw(FlowBuildingError);
+    /** \return Path the flow is built to; differs from flowPath() if the flow is upsampled afterwards. */
+    QString buildFlowPath(uint leftFrame, uint rightFrame, FrameSize frameSize);
+    /** Upsamples the flow at \c lowResPath, built from \c leftFrame, and saves it to \c path. */
+    void upsampleFlow(const QString &lowResPath, const QString &path, uint leftFrame, FrameSize frameSize) throw(FlowBuildingError);
+
 private:
     Project_sV *m_project;
+    bool m_warmStart;
+    bool m_smallInit;
+    float m_scale;
 };
 
 #endif // ABSTRACTFLOWSOURCE_SV_H
@@ -9,6 +9,7 @@ the Free Software Foundation, either version 3 of the License, or
 */
 
 #include "abstractRenderTarget_sV.h"
+#include "../lib/floatImage_sV.h"
 
 AbstractRenderTarget_sV::AbstractRenderTarget_sV(RenderTask_sV *renderTask) :
     m_renderTask(renderTask)
@@ -18,3 +19,8 @@ AbstractRenderTarget_sV::AbstractRenderTarget_sV(RenderTask_sV *renderTask) :
 AbstractRenderTarget_sV::~AbstractRenderTarget_sV()
 {
 }
+
+void AbstractRenderTarget_sV::slotConsumeFrame(const FloatImage_sV &image, const int frameNumber)
+{
+    slotConsumeFrame(image.toImage(), frameNumber);
+}
@@ -15,6 +15,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include "../lib/defs_sV.hpp"
 
 class RenderTask_sV;
+class FloatImage_sV;
 
 /** \brief Should represent a render target like video or an image sequence */
 class AbstractRenderTarget_sV
@@ -33,6 +34,11 @@ public:
 public slots:
     /// Adds one frame to the output
     virtual void slotConsumeFrame(const QImage &image, const int frameNumber) = 0;
+    /**
+      Adds one frame in the float format of the render core. The default converts it to 8 bits;
+      targets which can store more than 8 bits per channel use the float values directly.
+      */
+    virtual void slotConsumeFrame(const FloatImage_sV &image, const int frameNumber);
 
 private:
     RenderTask_sV *m_renderTask;
@@ -0,0 +1,61 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "cacheKey_sV.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QDebug>
+
+const QString CacheKey_sV::manifestName = "manifest.txt";
+
+CacheKey_sV::CacheKey_sV()
+{
+}
+
+CacheKey_sV& CacheKey_sV::add(const QString &name, const QVariant &value)
+{
+    m_inputs << QPair<QString, QString>(name, value.toString());
+    return *this;
+}
+
+QString CacheKey_sV::description() const
+{
+    QStringList parts;
+    for (int i = 0; i < m_inputs.size(); i++) {
+        parts << QString("%1=%2").arg(m_inputs.at(i).first, m_inputs.at(i).second);
+    }
+    return parts.join(";");
+}
+
+QString CacheKey_sV::hash() const
+{
+    // 64 bits are plenty for the number of files in a cache directory.
+    return QCryptographicHash::hash(description().toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+}
+
+QString CacheKey_sV::fileName(const QString &prefix, const QString &suffix) const
+{
+    return QString("%1-%2.%3").arg(prefix, hash(), suffix);
+}
+
+bool CacheKey_sV::writeManifestEntry(const QDir &dir, const QString &fileName) const
+{
+    QFile manifest(dir.absoluteFilePath(manifestName));
+    if (!manifest.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "Cannot write cache manifest " << manifest.fileName();
+        return false;
+    }
+    QTextStream out(&manifest);
+    out << fileName << "\t" << description() << "\n";
+    return true;
+}
@@ -0,0 +1,65 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CACHEKEY_SV_H
+#define CACHEKEY_SV_H
+
+#include <QtCore/QDir>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QString>
+#include <QtCore/QVariant>
+
+/**
+  \brief Identifies a cached file by all inputs that were used to create it.
+
+  Cached files (interpolated frames, convolved images) are named after the hash of
+  their inputs, so changing e.g. the interpolation type or the flow lambda automatically
+  leads to a new cache entry instead of re-using a stale one.
+
+  \code
+  CacheKey_sV key;
+  key.add("pos", framePos).add("size", toString(size));
+  QString file = dir.absoluteFilePath(key.fileName("cached", "png"));
+  \endcode
+  */
+class CacheKey_sV
+{
+public:
+    /// Name of the manifest file that lists all entries of a cache directory.
+    static const QString manifestName;
+
+    CacheKey_sV();
+
+    /**
+      Adds an input to the key. The order in which inputs are added is significant.
+      Floating point values should be converted to a string with a fixed precision by the caller.
+      */
+    CacheKey_sV& add(const QString &name, const QVariant &value);
+
+    /** \return Hexadecimal hash of all inputs */
+    QString hash() const;
+    /** \return Human-readable list of all inputs, like <code>pos=1.2500;size=Small</code> */
+    QString description() const;
+    /** \return <code>prefix-hash.suffix</code> */
+    QString fileName(const QString &prefix, const QString &suffix) const;
+
+    /**
+      Adds an entry for \c fileName to the manifest in \c dir. The manifest is only informative,
+      it allows to find out which inputs a cached file was built from.
+      \return \c false if the manifest could not be written
+      */
+    bool writeManifestEntry(const QDir &dir, const QString &fileName) const;
+
+private:
+    QList<QPair<QString, QString> > m_inputs;
+};
+
+#endif // CACHEKEY_SV_H
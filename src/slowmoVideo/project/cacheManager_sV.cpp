@@ -0,0 +1,305 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "cacheManager_sV.h"
+#include "cacheKey_sV.h"
+#include "project_sV.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QSettings>
+#include <QtCore/QTextStream>
+#include <QtAlgorithms>
+#include <QDebug>
+
+CacheManager_sV::CacheManager_sV(const Project_sV *project) :
+    m_project(project),
+    m_quota(0),
+    m_policy(Policy_LRU),
+    m_usageChanged(false),
+    m_mutex(QMutex::Recursive)
+{
+    QSettings settings;
+    m_quota = settings.value("cache/quotaMB", 0).toLongLong() * 1024 * 1024;
+    m_policy = fromString(settings.value("cache/policy", "lru").toString());
+
+    loadUsage();
+}
+
+CacheManager_sV::~CacheManager_sV()
+{
+    saveUsage();
+}
+
+void CacheManager_sV::setQuota(qint64 bytes)
+{
+    Q_ASSERT(bytes >= 0);
+    QMutexLocker locker(&m_mutex);
+    m_quota = bytes;
+}
+
+void CacheManager_sV::setPolicy(Policy policy)
+{
+    QMutexLocker locker(&m_mutex);
+    m_policy = policy;
+}
+
+QStringList CacheManager_sV::directories()
+{
+    QStringList dirs;
+    dirs << evictableDirectories() << "frames/small" << "frames/orig";
+    return dirs;
+}
+
+QStringList CacheManager_sV::evictableDirectories()
+{
+    QStringList dirs;
+    dirs << "cache/oFlowSmall" << "cache/oFlowOrig" << "cache/oFlowScaled" << "cache/oFlowTemporal" << "cache/framesScaled"
+         << "cache/motionBlurSmall" << "cache/motionBlurOrig";
+    return dirs;
+}
+
+bool CacheManager_sV::isUpToDate(const QString &path, const QStringList &sources)
+{
+    QFileInfo info(path);
+    if (!info.exists()) {
+        return false;
+    }
+    for (int i = 0; i < sources.size(); i++) {
+        QFileInfo source(sources.at(i));
+        if (source.exists() && source.lastModified() > info.lastModified()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QString CacheManager_sV::toString(Policy policy)
+{
+    switch (policy) {
+    case Policy_LFU:
+        return "lfu";
+    case Policy_LRU:
+    default:
+        return "lru";
+    }
+}
+
+CacheManager_sV::Policy CacheManager_sV::fromString(const QString &policy, bool *ok)
+{
+    bool valid = true;
+    Policy p = Policy_LRU;
+    if (policy.toLower() == "lfu") {
+        p = Policy_LFU;
+    } else if (policy.toLower() != "lru") {
+        valid = false;
+    }
+    if (ok != NULL) {
+        *ok = valid;
+    }
+    return p;
+}
+
+void CacheManager_sV::recordAccess(const QString &path)
+{
+    QString relativePath = m_project->getDirectory(".", false).relativeFilePath(path);
+    QMutexLocker locker(&m_mutex);
+    Usage &usage = m_usage[relativePath];
+    usage.lastAccess = QDateTime::currentDateTime().toTime_t();
+    usage.hits++;
+    m_usageChanged = true;
+}
+
+QList<CacheManager_sV::DirectoryStats> CacheManager_sV::statistics() const
+{
+    QList<DirectoryStats> list;
+    QStringList evictable = evictableDirectories();
+    QStringList dirs = directories();
+    for (int i = 0; i < dirs.size(); i++) {
+        DirectoryStats stats;
+        stats.name = dirs.at(i);
+        stats.bytes = 0;
+        stats.files = 0;
+        stats.evictable = evictable.contains(dirs.at(i));
+
+        QDir dir = m_project->getDirectory(dirs.at(i), false);
+        if (dir.exists()) {
+            QFileInfoList files = dir.entryInfoList(QDir::Files);
+            for (int f = 0; f < files.size(); f++) {
+                stats.bytes += files.at(f).size();
+                stats.files++;
+            }
+        }
+        list << stats;
+    }
+    return list;
+}
+
+qint64 CacheManager_sV::evictableSize() const
+{
+    qint64 bytes = 0;
+    QList<DirectoryStats> stats = statistics();
+    for (int i = 0; i < stats.size(); i++) {
+        if (stats.at(i).evictable) {
+            bytes += stats.at(i).bytes;
+        }
+    }
+    return bytes;
+}
+
+QList<CacheManager_sV::Entry> CacheManager_sV::evictableEntries() const
+{
+    QMutexLocker locker(&m_mutex);
+    QList<Entry> entries;
+    QDir projectDir = m_project->getDirectory(".", false);
+    QStringList dirs = evictableDirectories();
+    for (int i = 0; i < dirs.size(); i++) {
+        QDir dir = m_project->getDirectory(dirs.at(i), false);
+        if (!dir.exists()) {
+            continue;
+        }
+        QFileInfoList files = dir.entryInfoList(QDir::Files);
+        for (int f = 0; f < files.size(); f++) {
+            if (files.at(f).fileName() == CacheKey_sV::manifestName) {
+                continue;
+            }
+            Entry entry;
+            entry.path = files.at(f).absoluteFilePath();
+            entry.relativePath = projectDir.relativeFilePath(entry.path);
+            entry.bytes = files.at(f).size();
+            entry.lastAccess = files.at(f).lastModified().toTime_t();
+            entry.hits = 0;
+            if (m_usage.contains(entry.relativePath)) {
+                Usage usage = m_usage.value(entry.relativePath);
+                entry.lastAccess = qMax(entry.lastAccess, usage.lastAccess);
+                entry.hits = usage.hits;
+            }
+            entries << entry;
+        }
+    }
+    return entries;
+}
+
+bool CacheManager_sV::lessRecentlyUsed(const Entry &a, const Entry &b)
+{
+    return a.lastAccess < b.lastAccess;
+}
+
+bool CacheManager_sV::lessFrequentlyUsed(const Entry &a, const Entry &b)
+{
+    if (a.hits == b.hits) {
+        return a.lastAccess < b.lastAccess;
+    }
+    return a.hits < b.hits;
+}
+
+int CacheManager_sV::prune(qint64 maxBytes)
+{
+    // Held while deleting, so files recorded meanwhile are not removed from the usage afterwards.
+    QMutexLocker locker(&m_mutex);
+    QList<Entry> entries = evictableEntries();
+
+    qint64 total = 0;
+    for (int i = 0; i < entries.size(); i++) {
+        total += entries.at(i).bytes;
+    }
+    if (total <= maxBytes) {
+        return 0;
+    }
+
+    if (m_policy == Policy_LFU) {
+        qStableSort(entries.begin(), entries.end(), lessFrequentlyUsed);
+    } else {
+        qStableSort(entries.begin(), entries.end(), lessRecentlyUsed);
+    }
+
+    int deleted = 0;
+    for (int i = 0; i < entries.size() && total > maxBytes; i++) {
+        if (QFile::remove(entries.at(i).path)) {
+            total -= entries.at(i).bytes;
+            m_usage.remove(entries.at(i).relativePath);
+            m_usageChanged = true;
+            deleted++;
+        } else {
+            qDebug() << "Could not remove cached file " << entries.at(i).path;
+        }
+    }
+    qDebug() << "Cache pruned: " << deleted << " files deleted, " << total << " bytes left.";
+
+    saveUsage();
+    return deleted;
+}
+
+int CacheManager_sV::enforceQuota()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_quota > 0) {
+        return prune(m_quota);
+    }
+    return 0;
+}
+
+void CacheManager_sV::loadUsage()
+{
+    QMutexLocker locker(&m_mutex);
+    m_usage.clear();
+    m_usageChanged = false;
+    // Only read; the directory is created when the usage is written.
+    m_usageFile = m_project->getDirectory("cache", false).absoluteFilePath("usage.txt");
+
+    QFile file(m_usageFile);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QStringList parts = in.readLine().split('\t');
+        if (parts.size() == 3) {
+            Usage usage;
+            usage.hits = parts.at(0).toInt();
+            usage.lastAccess = parts.at(1).toUInt();
+            m_usage.insert(parts.at(2), usage);
+        }
+    }
+}
+
+void CacheManager_sV::saveUsage()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_usageChanged) {
+        return;
+    }
+
+    QFileInfo info(m_usageFile);
+    if (!info.dir().exists()) {
+        info.dir().mkpath(".");
+    }
+    QFile file(m_usageFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qDebug() << "Cannot write cache usage to " << m_usageFile;
+        return;
+    }
+    QTextStream out(&file);
+    QHash<QString, Usage>::const_iterator it;
+    for (it = m_usage.constBegin(); it != m_usage.constEnd(); ++it) {
+        out << it.value().hits << "\t" << it.value().lastAccess << "\t" << it.key() << "\n";
+    }
+    m_usageChanged = false;
+}
+
+void CacheManager_sV::slotUpdateProjectDir()
+{
+    QMutexLocker locker(&m_mutex);
+    saveUsage();
+    loadUsage();
+}
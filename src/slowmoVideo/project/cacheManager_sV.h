@@ -0,0 +1,130 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef CACHEMANAGER_SV_H
+#define CACHEMANAGER_SV_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+class Project_sV;
+
+/**
+  \brief Keeps the size of the project's cache directories below a quota.
+
+  Optical flow fields and motion blur frames in the \c cache/ sub-directories can always be rebuilt
+  and are therefore evicted when the quota is exceeded, either least recently used (LRU) or least
+  frequently used (LFU) files first. Extracted frames in \c frames/ are only counted in the statistics
+  since the frame sources do not re-create them on demand.
+
+  Accesses are recorded by the flow sources and by MotionBlur_sV and stored in \c cache/usage.txt
+  in the project directory, such that the usage information survives e.g. a prune from slowmoRenderer.
+
+  The quota (in MiB, 0 for unlimited) and policy are read from the \c cache/quotaMB
+  and \c cache/policy settings.
+
+  Accesses are recorded from the render thread as well as from the GUI thread (e.g. by the flow examiner),
+  therefore the usage information is protected by a mutex.
+  */
+class CacheManager_sV
+{
+public:
+    enum Policy { Policy_LRU, Policy_LFU };
+
+    /// Usage of a single cache directory
+    struct DirectoryStats {
+        QString name;
+        qint64 bytes;
+        int files;
+        bool evictable;
+    };
+
+    CacheManager_sV(const Project_sV *project);
+    ~CacheManager_sV();
+
+    /** Sets the maximum size of all evictable directories in bytes. \c 0 disables the quota. */
+    void setQuota(qint64 bytes);
+    qint64 quota() const { return m_quota; }
+    void setPolicy(Policy policy);
+    Policy policy() const { return m_policy; }
+
+    /** Marks the cached file at \c path as used right now. */
+    void recordAccess(const QString &path);
+
+    /** \return Usage of each cache directory, in the order of directories(). */
+    QList<DirectoryStats> statistics() const;
+    /** \return Size of all evictable cache files in bytes */
+    qint64 evictableSize() const;
+
+    /**
+      Deletes cache files, according to the policy, until the evictable directories use at most \c maxBytes.
+      \return Number of deleted files
+      */
+    int prune(qint64 maxBytes);
+    /** Calls prune() if a quota is set and exceeded. \return Number of deleted files */
+    int enforceQuota();
+
+    /** Writes the usage information to the project directory. */
+    void saveUsage();
+
+    /// All directories that are managed, relative to the project directory
+    static QStringList directories();
+    /// Directories whose content can be deleted without losing information
+    static QStringList evictableDirectories();
+
+    /**
+      \return \c true if the cached file at \c path exists and is not older than any of the files it
+      was built from. Sources which do not exist are ignored. Used for derived files whose name does
+      not change when their sources are built again.
+      */
+    static bool isUpToDate(const QString &path, const QStringList &sources);
+
+    static QString toString(Policy policy);
+    static Policy fromString(const QString &policy, bool *ok = NULL);
+
+    /** Stores the usage information and re-reads it from the new project directory. */
+    void slotUpdateProjectDir();
+
+private:
+    struct Usage {
+        Usage() : lastAccess(0), hits(0) {}
+        uint lastAccess;
+        int hits;
+    };
+    struct Entry {
+        QString path;
+        QString relativePath;
+        qint64 bytes;
+        uint lastAccess;
+        int hits;
+    };
+
+    const Project_sV *m_project;
+    qint64 m_quota;
+    Policy m_policy;
+    bool m_usageChanged;
+    QString m_usageFile;
+
+    /// Keys are paths relative to the project directory
+    QHash<QString, Usage> m_usage;
+    /// Protects the usage, quota, and policy. Recursive since e.g. prune() calls saveUsage().
+    mutable QMutex m_mutex;
+
+    void loadUsage();
+    QList<Entry> evictableEntries() const;
+
+    static bool lessRecentlyUsed(const Entry &a, const Entry &b);
+    static bool lessFrequentlyUsed(const Entry &a, const Entry &b);
+};
+
+#endif // CACHEMANAGER_SV_H
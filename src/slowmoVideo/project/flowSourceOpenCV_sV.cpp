@@ -12,7 +12,9 @@ the Free Software Foundation, either version 3 of the License, or
 #include "flowSourceOpenCV_sV.h"
 #include "project_sV.h"
 #include "abstractFrameSource_sV.h"
+#include "cacheManager_sV.h"
 #include "../lib/flowRW_sV.h"
+#include "../lib/profiler_sV.h"
 #include "../lib/flowField_sV.h"
 
 #include "opencv2/video/tracking.hpp"
@@ -23,6 +25,10 @@ the Free Software Foundation, either version 3 of the License, or
 #include <fstream>
 using namespace cv;
 
+/// Pyramid levels and iterations when starting from an initial flow (neighbouring pair or small frames)
+#define OCV_WARMSTART_LEVELS 1
+#define OCV_WARMSTART_ITERATIONS 3
+
 FlowSourceOpenCV_sV::FlowSourceOpenCV_sV(Project_sV *project) :
     AbstractFlowSource_sV(project)
 {
@@ -110,21 +116,24 @@ const QString FlowSourceOpenCV_sV::flowPath(const uint leftFrame, const uint rig
         direction = "backward";
     }
 
-    return dir.absoluteFilePath(QString("ocv-%1-%2-%3.sVflow").arg(direction).arg(leftFrame).arg(rightFrame));
+    return dir.absoluteFilePath(QString("ocv-%1-%2-%3%4%5%6.sVflow").arg(direction).arg(leftFrame).arg(rightFrame)
+                                .arg(scaleTag(frameSize)).arg(initTag(frameSize)).arg(warmStartTag()));
 }
 FlowField_sV* FlowSourceOpenCV_sV::buildFlow(uint leftFrame, uint rightFrame, FrameSize frameSize) throw(FlowBuildingError)
 {
     QString flowFileName(flowPath(leftFrame, rightFrame, frameSize));
+    QString buildFileName(buildFlowPath(leftFrame, rightFrame, frameSize));
 
     /// \todo Check if size is equal
-    if (!QFile(flowFileName).exists()) {
+    if (!QFile(flowFileName).exists() && !QFile(buildFileName).exists()) {
 
+        Profiler_sV::Timer timer(Profiler_sV::Stage_FlowBuild);
         QTime time;
         time.start();
 
         Mat prevgray, gray, flow, cflow;
-        QString prevpath = project()->frameSource()->framePath(leftFrame, frameSize);
-        QString path = project()->frameSource()->framePath(rightFrame, frameSize);
+        QString prevpath = inputFramePath(leftFrame, frameSize);
+        QString path = inputFramePath(rightFrame, frameSize);
 //        namedWindow("flow", 1);
 
 		qDebug() << "Building flow for left frame " << leftFrame << " to right frame " << rightFrame << "; Size: " << frameSize;
@@ -139,12 +148,39 @@ FlowField_sV* FlowSourceOpenCV_sV::buildFlow(uint leftFrame, uint rightFrame, Fr
 
             if( prevgray.data ) {
                 const float pyrScale = 0.5;
-                const float levels = 3;
+                float levels = 3;
                 const float winsize = 15;
-                const float iterations = 8;
+                float iterations = 8;
                 const float polyN = 5;
                 const float polySigma = 1.2;
-                const int flags = 0;
+                int flags = 0;
+
+                QString initialPath = initialFlowPath(leftFrame, rightFrame, frameSize);
+                if (initialPath.length() > 0) {
+                    FlowField_sV *initialFlow = NULL;
+                    try {
+                        initialFlow = FlowRW_sV::load(initialPath.toStdString());
+                    } catch (FlowRW_sV::FlowRWError &err) {
+                        qDebug() << "Could not load the initial flow: " << err.message.c_str();
+                    }
+                    if (initialFlow != NULL) {
+                        // Farneback refines the given flow, so the coarse levels are not needed any more.
+                        Mat initial(initialFlow->height(), initialFlow->width(), CV_32FC2, initialFlow->data());
+                        if (initial.cols == prevgray.cols && initial.rows == prevgray.rows) {
+                            initial.copyTo(flow);
+                        } else {
+                            // Flow of the small frames: resize, and scale the vectors accordingly
+                            resize(initial, flow, prevgray.size(), 0, 0, INTER_LINEAR);
+                            multiply(flow, Scalar(float(prevgray.cols)/initial.cols, float(prevgray.rows)/initial.rows), flow);
+                        }
+                        flags |= OPTFLOW_USE_INITIAL_FLOW;
+                        levels = OCV_WARMSTART_LEVELS;
+                        iterations = OCV_WARMSTART_ITERATIONS;
+                        qDebug() << "Initialising the flow with " << initialPath;
+                    }
+                    delete initialFlow;
+                }
+
                 // TBD need sliders for all these parameters
                 calcOpticalFlowFarneback(
                     prevgray, gray,
@@ -160,7 +196,7 @@ FlowField_sV* FlowSourceOpenCV_sV::buildFlow(uint leftFrame, uint rightFrame, Fr
                     );
                 cvtColor(prevgray, cflow, CV_GRAY2BGR);
                 //drawOptFlowMap(flow, cflow, 16, 1.5, CV_RGB(0, 255, 0));
-                drawOptFlowMap(flow, cflow, 1, 1.5, CV_RGB(0, 255, 0), flowFileName.toStdString());
+                drawOptFlowMap(flow, cflow, 1, 1.5, CV_RGB(0, 255, 0), buildFileName.toStdString());
                 //imshow("flow", cflow);
                 //imwrite(argv[4],cflow);
             } else {
@@ -169,13 +205,19 @@ FlowField_sV* FlowSourceOpenCV_sV::buildFlow(uint leftFrame, uint rightFrame, Fr
             }
         }
 
-        qDebug() << "Optical flow built for " << flowFileName << " in " << time.elapsed() << " ms.";
+        qDebug() << "Optical flow built for " << buildFileName << " in " << time.elapsed() << " ms.";
 
     } else {
         qDebug().nospace() << "Re-using existing flow image for left frame " << leftFrame << " to right frame " << rightFrame << ": " << flowFileName;
     }
+    if (!QFile(flowFileName).exists()) {
+        upsampleFlow(buildFileName, flowFileName, leftFrame, frameSize);
+    }
+
+    project()->cacheManager()->recordAccess(flowFileName);
 
     try {
+        Profiler_sV::Timer timer(Profiler_sV::Stage_FlowLoad);
         return FlowRW_sV::load(flowFileName.toStdString());
     } catch (FlowRW_sV::FlowRWError &err) {
         throw FlowBuildingError(err.message.c_str());
@@ -23,6 +23,7 @@ public:
 
     virtual FlowField_sV* buildFlow(uint leftFrame, uint rightFrame, FrameSize frameSize) throw(FlowBuildingError);
     virtual const QString flowPath(const uint leftFrame, const uint rightFrame, const FrameSize frameSize = FrameSize_Orig) const;
+    virtual const QString identifier() const { return "OpenCV-Farneback"; }
 
 public slots:
     virtual void slotUpdateProjectDir();
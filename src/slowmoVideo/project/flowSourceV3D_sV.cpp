@@ -11,13 +11,20 @@ the Free Software Foundation, either version 3 of the License, or
 #include "flowSourceV3D_sV.h"
 #include "project_sV.h"
 #include "abstractFrameSource_sV.h"
+#include "cacheManager_sV.h"
 #include "../lib/flowRW_sV.h"
+#include "../lib/profiler_sV.h"
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QProcess>
 #include <QtCore/QSettings>
 #include <QtCore/QTime>
 
+/// Inner iterations of the flow builder per pyramid level
+#define V3D_ITERATIONS 100
+/// Inner iterations when starting from an initial flow (neighbouring pair or small frames)
+#define V3D_WARMSTART_ITERATIONS 40
+
 FlowSourceV3D_sV::FlowSourceV3D_sV(Project_sV *project, float lambda) :
     AbstractFlowSource_sV(project),
     m_lambda(lambda)
@@ -46,9 +53,10 @@ void FlowSourceV3D_sV::setLambda(float lambda)
 FlowField_sV* FlowSourceV3D_sV::buildFlow(uint leftFrame, uint rightFrame, FrameSize frameSize) throw(FlowBuildingError)
 {
     QString flowFileName(flowPath(leftFrame, rightFrame, frameSize));
+    QString buildFileName(buildFlowPath(leftFrame, rightFrame, frameSize));
 
     /// \todo Check if size is equal
-    if (!QFile(flowFileName).exists()) {
+    if (!QFile(flowFileName).exists() && !QFile(buildFileName).exists()) {
         QSettings settings;
         QString programLocation(settings.value("binaries/v3dFlowBuilder", "/usr/local/bin/slowmoFlowBuilder").toString());
         if (!QFile(programLocation).exists()) {
@@ -64,15 +72,25 @@ FlowField_sV* FlowSourceV3D_sV::buildFlow(uint leftFrame, uint rightFrame, Frame
 
         qDebug() << "Building flow for left frame " << leftFrame << " to right frame " << rightFrame << "; Size: " << frameSize;
 
+        QString initialFlow = initialFlowPath(leftFrame, rightFrame, frameSize);
+
         QStringList args;
-        args    << project()->frameSource()->framePath(leftFrame, frameSize)
-                << project()->frameSource()->framePath(rightFrame, frameSize)
-                << flowFileName
-                << QVariant(m_lambda).toString() << "100";
+        args    << inputFramePath(leftFrame, frameSize)
+                << inputFramePath(rightFrame, frameSize)
+                << buildFileName
+                << QVariant(m_lambda).toString();
+        if (initialFlow.length() > 0) {
+            // The flow builder skips the coarse pyramid levels when it gets an initial flow,
+            // and resamples it if it was built for the small frames.
+            args << QString::number(V3D_WARMSTART_ITERATIONS) << initialFlow;
+        } else {
+            args << QString::number(V3D_ITERATIONS);
+        }
 
         qDebug() << "Arguments: " << args;
 
 
+        Profiler_sV::Timer timer(Profiler_sV::Stage_FlowBuild);
         QTime time;
         QProcess proc;
 
@@ -83,14 +101,20 @@ FlowField_sV* FlowSourceV3D_sV::buildFlow(uint leftFrame, uint rightFrame, Frame
             qDebug() << "Failed: " << proc.readAllStandardError() << proc.readAllStandardOutput();
             throw FlowBuildingError(QString("Flow builder exited with exit code %1; For details see debugging output").arg(proc.exitCode()));
         } else {
-            qDebug() << "Optical flow built for " << flowFileName << " in " << time.elapsed() << " ms";
+            qDebug() << "Optical flow built for " << buildFileName << " in " << time.elapsed() << " ms";
             qDebug() << proc.readAllStandardError() << proc.readAllStandardOutput();
         }
     } else {
         qDebug().nospace() << "Re-using existing flow image for left frame " << leftFrame << " to right frame " << rightFrame << ": " << flowFileName;
     }
+    if (!QFile(flowFileName).exists()) {
+        upsampleFlow(buildFileName, flowFileName, leftFrame, frameSize);
+    }
+
+    project()->cacheManager()->recordAccess(flowFileName);
 
     try {
+        Profiler_sV::Timer timer(Profiler_sV::Stage_FlowLoad);
         return FlowRW_sV::load(flowFileName.toStdString());
     } catch (FlowRW_sV::FlowRWError &err) {
         throw FlowBuildingError(err.message.c_str());
@@ -156,5 +180,6 @@ const QString FlowSourceV3D_sV::flowPath(const uint leftFrame, const uint rightF
         direction = "backward";
     }
 
-    return dir.absoluteFilePath(QString("%1-lambda%4_%2-%3.sVflow").arg(direction).arg(leftFrame).arg(rightFrame).arg(m_lambda, 0, 'f', 2));
+    return dir.absoluteFilePath(QString("%1-lambda%4_%2-%3%5%6%7.sVflow").arg(direction).arg(leftFrame).arg(rightFrame).arg(m_lambda, 0, 'f', 2)
+                                .arg(scaleTag(frameSize)).arg(initTag(frameSize)).arg(warmStartTag()));
 }
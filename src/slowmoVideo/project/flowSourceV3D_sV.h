@@ -26,6 +26,7 @@ public:
 
     FlowField_sV* buildFlow(uint leftFrame, uint rightFrame, FrameSize frameSize) throw(FlowBuildingError);
     const QString flowPath(const uint leftFrame, const uint rightFrame, const FrameSize frameSize) const;
+    const QString identifier() const { return "V3D"; }
 
     static bool validateFlowBinary(const QString path);
     static QString correctFlowBinaryLocation();
@@ -0,0 +1,92 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "frameConsumerThread_sV.h"
+#include "frameQueue_sV.h"
+
+#include <QtCore/QMutexLocker>
+
+FrameConsumerThread_sV::FrameConsumerThread_sV(FrameQueue_sV *queue, Consumer *consumer) :
+    m_queue(queue),
+    m_consumer(consumer),
+    m_failed(false),
+    m_framesConsumed(0)
+{
+}
+
+bool FrameConsumerThread_sV::failed() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_failed;
+}
+
+QString FrameConsumerThread_sV::errorMessage() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_errorMessage;
+}
+
+int FrameConsumerThread_sV::framesConsumed() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_framesConsumed;
+}
+
+void FrameConsumerThread_sV::fail(const QString &message)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_failed = true;
+        m_errorMessage = message;
+    }
+    // Unblock the producer; frames rendered from now on are dropped.
+    m_queue->close();
+    m_queue->clear();
+}
+
+void FrameConsumerThread_sV::run()
+{
+    bool ended = false;
+    try {
+        m_consumer->beginConsuming();
+
+        FrameQueue_sV::Item item;
+        while (m_queue->pop(item)) {
+            if (item.floatImage != NULL) {
+                // Taken from the queue, so the frame is ours now
+                FloatImage_sV *image = item.floatImage;
+                item.floatImage = NULL;
+                try {
+                    m_consumer->consumeQueuedFrame(*image, item.frameNumber);
+                } catch (Error_sV &) {
+                    delete image;
+                    throw;
+                }
+                delete image;
+            } else {
+                m_consumer->consumeQueuedFrame(item.image, item.frameNumber);
+            }
+            QMutexLocker locker(&m_mutex);
+            m_framesConsumed++;
+        }
+
+        ended = true;
+        m_consumer->endConsuming(false);
+    } catch (Error_sV &err) {
+        fail(err.message());
+        if (!ended) {
+            try {
+                m_consumer->endConsuming(true);
+            } catch (Error_sV &) {
+                // The first error is the relevant one.
+            }
+        }
+    }
+}
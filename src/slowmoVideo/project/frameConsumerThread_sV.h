@@ -0,0 +1,78 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef FRAMECONSUMERTHREAD_SV_H
+#define FRAMECONSUMERTHREAD_SV_H
+
+#include "../lib/defs_sV.hpp"
+#include "../lib/floatImage_sV.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+
+class FrameQueue_sV;
+
+/**
+  \brief Takes frames from a FrameQueue_sV and passes them to a Consumer on a separate thread.
+
+  Used by render targets to overlap writing (encoding) frames with rendering the next ones.
+  The thread runs until the queue is closed and empty. If the consumer throws an error,
+  the queue is closed and the error is kept until it is read with errorMessage().
+  Consumers that need to run code on the consumer thread before and after the frames
+  (like starting and ending an encoder process) can do so in the begin/end hooks.
+  */
+class FrameConsumerThread_sV : public QThread
+{
+public:
+    /// Receives the frames on the consumer thread
+    class Consumer {
+    public:
+        virtual ~Consumer() {}
+        /// Called on the consumer thread before the first frame, e.g. for resources owned by that thread.
+        virtual void beginConsuming() throw(Error_sV) {}
+        /// Called for each frame in the queue, in the order they were added.
+        virtual void consumeQueuedFrame(const QImage &image, int frameNumber) throw(Error_sV) = 0;
+        /// Called for float frames; the default converts them to 8 bits.
+        virtual void consumeQueuedFrame(const FloatImage_sV &image, int frameNumber) throw(Error_sV)
+        {
+            consumeQueuedFrame(image.toImage(), frameNumber);
+        }
+        /**
+          Called on the consumer thread after the last frame.
+          \param failed \c true if consuming has failed; errors thrown in this case are ignored.
+          */
+        virtual void endConsuming(bool failed) throw(Error_sV) { Q_UNUSED(failed); }
+    };
+
+    FrameConsumerThread_sV(FrameQueue_sV *queue, Consumer *consumer);
+
+    /// \return \c true if the consumer failed. No further frames are consumed in this case.
+    bool failed() const;
+    /// \return The error message of the consumer
+    QString errorMessage() const;
+    /// \return Number of frames that have been consumed
+    int framesConsumed() const;
+
+protected:
+    void run();
+
+private:
+    void fail(const QString &message);
+
+    FrameQueue_sV *m_queue;
+    Consumer *m_consumer;
+
+    mutable QMutex m_mutex;
+    bool m_failed;
+    QString m_errorMessage;
+    int m_framesConsumed;
+};
+
+#endif // FRAMECONSUMERTHREAD_SV_H
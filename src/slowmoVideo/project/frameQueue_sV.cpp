@@ -0,0 +1,105 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "frameQueue_sV.h"
+#include "../lib/floatImage_sV.h"
+
+#include <QtCore/QMutexLocker>
+
+FrameQueue_sV::FrameQueue_sV(int capacity) :
+    m_capacity(qMax(1, capacity)),
+    m_closed(false)
+{
+}
+
+FrameQueue_sV::~FrameQueue_sV()
+{
+    clear();
+}
+
+bool FrameQueue_sV::push(const QImage &image, int frameNumber)
+{
+    Item item;
+    item.image = image;
+    item.frameNumber = frameNumber;
+    return push(item);
+}
+
+bool FrameQueue_sV::push(FloatImage_sV *image, int frameNumber)
+{
+    Item item;
+    item.floatImage = image;
+    item.frameNumber = frameNumber;
+    if (!push(item)) {
+        delete image;
+        return false;
+    }
+    return true;
+}
+
+bool FrameQueue_sV::push(const Item &item)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_queue.size() >= m_capacity && !m_closed) {
+        m_notFull.wait(&m_mutex);
+    }
+    if (m_closed) {
+        return false;
+    }
+
+    m_queue.enqueue(item);
+    m_notEmpty.wakeOne();
+    return true;
+}
+
+bool FrameQueue_sV::pop(Item &item)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_queue.isEmpty() && !m_closed) {
+        m_notEmpty.wait(&m_mutex);
+    }
+    if (m_queue.isEmpty()) {
+        return false;
+    }
+
+    item = m_queue.dequeue();
+    m_notFull.wakeOne();
+    return true;
+}
+
+void FrameQueue_sV::close()
+{
+    QMutexLocker locker(&m_mutex);
+    m_closed = true;
+    m_notEmpty.wakeAll();
+    m_notFull.wakeAll();
+}
+
+void FrameQueue_sV::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_queue.size(); i++) {
+        delete m_queue.at(i).floatImage;
+    }
+    m_queue.clear();
+    m_notFull.wakeAll();
+}
+
+int FrameQueue_sV::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_queue.size();
+}
+
+bool FrameQueue_sV::isClosed() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_closed;
+}
@@ -0,0 +1,93 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef FRAMEQUEUE_SV_H
+#define FRAMEQUEUE_SV_H
+
+#include <QtCore/QMutex>
+#include <QtCore/QQueue>
+#include <QtCore/QWaitCondition>
+#include <QtGui/QImage>
+
+class FloatImage_sV;
+
+/**
+  \brief Bounded queue for passing rendered frames to another thread.
+
+  push() blocks while the queue is full, so a slow consumer (like a video encoder)
+  slows down rendering instead of letting the queue grow without limit.
+  pop() blocks until a frame is available or the queue has been closed.
+
+  Frames are either 8-bit QImages or, for targets that write the float data of the render core,
+  FloatImage_sV frames. Those are passed by pointer to avoid copying them, the queue owns them
+  until they have been taken with pop().
+  */
+class FrameQueue_sV
+{
+public:
+    /// A frame together with its output frame number
+    struct Item {
+        QImage image;
+        /// Float frame, or \c NULL if the frame is \c image
+        FloatImage_sV *floatImage;
+        int frameNumber;
+
+        Item() : floatImage(NULL), frameNumber(0) {}
+    };
+
+    /// \param capacity Maximum number of frames in the queue, must be >= 1
+    FrameQueue_sV(int capacity);
+    /// Deletes the float frames which have not been taken.
+    ~FrameQueue_sV();
+
+    /**
+      Adds a frame to the queue. Blocks while the queue is full.
+      \return \c false if the queue has been closed, the frame is then dropped.
+      */
+    bool push(const QImage &image, int frameNumber);
+    /**
+      Like push(const QImage&, int) for a float frame. The queue takes ownership of \c image,
+      it is deleted if the queue has been closed.
+      */
+    bool push(FloatImage_sV *image, int frameNumber);
+
+    /**
+      Takes the next frame from the queue. Blocks while the queue is empty.
+      \return \c false if the queue has been closed and all frames have been taken.
+      The caller owns \c item.floatImage.
+      */
+    bool pop(Item &item);
+
+    /**
+      Closes the queue. Remaining frames can still be taken with pop(),
+      further calls to push() fail. Wakes up all waiting threads.
+      */
+    void close();
+
+    /// Removes all frames from the queue without consuming them.
+    void clear();
+
+    int size() const;
+    int capacity() const { return m_capacity; }
+    bool isClosed() const;
+
+private:
+    const int m_capacity;
+    QQueue<Item> m_queue;
+    bool m_closed;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+
+    bool push(const Item &item);
+};
+
+#endif // FRAMEQUEUE_SV_H
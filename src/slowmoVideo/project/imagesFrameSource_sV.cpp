@@ -10,6 +10,7 @@ the Free Software Foundation, either version 3 of the License, or
 
 #include "imagesFrameSource_sV.h"
 #include "project_sV.h"
+#include "../lib/profiler_sV.h"
 
 #include <QtCore/QFileInfo>
 #include <QtCore/QDebug>
@@ -130,6 +131,7 @@ const Fps_sV* ImagesFrameSource_sV::fps() const
 
 QImage ImagesFrameSource_sV::frameAt(const uint frame, const FrameSize frameSize)
 {
+    Profiler_sV::Timer timer(Profiler_sV::Stage_Decode);
     if (int(frame) < m_imagesList.size()) {
         return QImage(framePath(frame, frameSize));
     } else {
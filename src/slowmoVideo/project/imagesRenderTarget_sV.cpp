@@ -9,15 +9,27 @@ the Free Software Foundation, either version 3 of the License, or
 */
 
 #include "imagesRenderTarget_sV.h"
+#include "frameQueue_sV.h"
 
+#include <QtCore/QObject>
+#include <QtCore/QThread>
 #include <QtCore/QDebug>
 
+/// Frames waiting for a writer, per writer thread
+#define QUEUE_SIZE_PER_THREAD 2
+
 ImagesRenderTarget_sV::ImagesRenderTarget_sV(RenderTask_sV *parentRenderTask) :
-    AbstractRenderTarget_sV(parentRenderTask)
+    AbstractRenderTarget_sV(parentRenderTask),
+    m_writerThreads(0),
+    m_queue(NULL)
 {
     m_targetDir = QDir::temp();
     m_filenamePattern = "rendered-%1.jpg";
 }
+ImagesRenderTarget_sV::~ImagesRenderTarget_sV()
+{
+    stopWriters();
+}
 
 void ImagesRenderTarget_sV::setTargetDir(const QDir dir)
 {
@@ -33,18 +45,98 @@ bool ImagesRenderTarget_sV::setFilenamePattern(const QString pattern)
     return false;
 }
 
+void ImagesRenderTarget_sV::setWriterThreads(int threads)
+{
+    Q_ASSERT(threads >= 0);
+    m_writerThreads = threads;
+}
+
+void ImagesRenderTarget_sV::openRenderTarget() throw(Error_sV)
+{
+    startWriters();
+}
+
+void ImagesRenderTarget_sV::startWriters() throw(Error_sV)
+{
+    stopWriters();
+
+    if (!m_targetDir.exists() && !m_targetDir.mkpath(".")) {
+        throw Error_sV(QObject::tr("Output directory %1 could not be created.").arg(m_targetDir.absolutePath()));
+    }
+
+    int threads = m_writerThreads;
+    if (threads == 0) {
+        threads = qMax(1, QThread::idealThreadCount());
+    }
+    m_queue = new FrameQueue_sV(QUEUE_SIZE_PER_THREAD*threads);
+    for (int i = 0; i < threads; i++) {
+        FrameConsumerThread_sV *writer = new FrameConsumerThread_sV(m_queue, this);
+        writer->start();
+        m_writers << writer;
+    }
+    qDebug() << "Writing images with " << threads << " threads.";
+}
+
 void ImagesRenderTarget_sV::slotConsumeFrame(const QImage &image, const int frameNumber)
 {
-    if (!m_targetDir.exists()) {
-        m_targetDir.mkpath(".");
+    if (m_queue == NULL) {
+        // Rendering has been continued after closing the target
+        startWriters();
+    }
+    // Blocks while all writers are busy.
+    if (!m_queue->push(image, frameNumber)) {
+        throw Error_sV(stopWriters());
+    }
+}
+
+void ImagesRenderTarget_sV::queueFrame(const FloatImage_sV &image, int frameNumber)
+{
+    if (m_queue == NULL) {
+        startWriters();
     }
-    QString path = m_targetDir.absoluteFilePath(m_filenamePattern.arg(frameNumber+1, 5, 10, QChar::fromAscii('0')));
+    if (!m_queue->push(new FloatImage_sV(image), frameNumber)) {
+        throw Error_sV(stopWriters());
+    }
+}
+
+QString ImagesRenderTarget_sV::framePath(int frameNumber) const
+{
+    return m_targetDir.absoluteFilePath(m_filenamePattern.arg(frameNumber+1, 5, 10, QChar::fromAscii('0')));
+}
+
+void ImagesRenderTarget_sV::consumeQueuedFrame(const QImage &image, int frameNumber) throw(Error_sV)
+{
+    QString path = framePath(frameNumber);
 
-    bool ok;
-    ok = image.save(path);
-    if (!ok) {
-        qDebug() << "  Writing image to " << path << " failed!";
-    } else {
-        qDebug() << "  Saved frame number " << frameNumber << " to " << path;
+    if (!image.save(path)) {
+        throw Error_sV(QObject::tr("Writing frame %1 to %2 failed!").arg(frameNumber).arg(path));
+    }
+    qDebug() << "  Saved frame number " << frameNumber << " to " << path;
+}
+
+QString ImagesRenderTarget_sV::stopWriters()
+{
+    QString error;
+    if (m_queue != NULL) {
+        m_queue->close();
+    }
+    for (int i = 0; i < m_writers.size(); i++) {
+        m_writers.at(i)->wait();
+        if (error.length() == 0 && m_writers.at(i)->failed()) {
+            error = m_writers.at(i)->errorMessage();
+        }
+        delete m_writers.at(i);
+    }
+    m_writers.clear();
+    delete m_queue;
+    m_queue = NULL;
+    return error;
+}
+
+void ImagesRenderTarget_sV::closeRenderTarget() throw(Error_sV)
+{
+    QString error = stopWriters();
+    if (error.length() > 0) {
+        throw Error_sV(error);
     }
 }
@@ -12,25 +12,66 @@ the Free Software Foundation, either version 3 of the License, or
 #define IMAGESRENDERTARGET_SV_H
 
 #include "abstractRenderTarget_sV.h"
+#include "frameConsumerThread_sV.h"
 
 #include <QtCore/QDir>
+#include <QtCore/QList>
 
 class RenderTask_sV;
+class FrameQueue_sV;
 
-class ImagesRenderTarget_sV : public AbstractRenderTarget_sV
+/**
+  \brief Saves frames as image sequence.
+
+  Compressing images (especially PNG) takes longer than rendering many frames, therefore
+  the images are compressed and written by a pool of writer threads. They take the frames
+  from a bounded queue; if they cannot keep up, slotConsumeFrame() waits.
+  */
+class ImagesRenderTarget_sV : public AbstractRenderTarget_sV, public FrameConsumerThread_sV::Consumer
 {
 public:
     ImagesRenderTarget_sV(RenderTask_sV *parentRenderTask);
+    virtual ~ImagesRenderTarget_sV();
 
     void setTargetDir(const QDir dir);
     bool setFilenamePattern(const QString pattern);
+    /// Number of writer threads. 0 (default) uses one thread per core. Takes effect when opening the target.
+    void setWriterThreads(int threads);
+
+    void openRenderTarget() throw(Error_sV);
+    /// Waits until all images are written. Throws an error if an image could not be saved.
+    void closeRenderTarget() throw(Error_sV);
+
+    /// Saves a frame; called on one of the writer threads.
+    void consumeQueuedFrame(const QImage &image, int frameNumber) throw(Error_sV);
 
 public slots:
+    /// Queues the frame for writing. Throws an Error_sV if a previous image could not be saved.
     void slotConsumeFrame(const QImage &image, const int frameNumber);
 
+protected:
+    /// \return The file the frame is written to
+    QString framePath(int frameNumber) const;
+    /**
+      Queues a copy of a float frame for consumeQueuedFrame(const FloatImage_sV&, int), for targets
+      writing the float data. Throws an Error_sV like slotConsumeFrame().
+      */
+    void queueFrame(const FloatImage_sV &image, int frameNumber);
+
 private:
     QDir m_targetDir;
     QString m_filenamePattern;
+
+    int m_writerThreads;
+    FrameQueue_sV *m_queue;
+    QList<FrameConsumerThread_sV*> m_writers;
+
+    void startWriters() throw(Error_sV);
+    /**
+      Stops the writer threads after writing the remaining frames.
+      \return The first error message of the writers, or an empty string if there was no error
+      */
+    QString stopWriters();
 };
 
 #endif // IMAGESRENDERTARGET_SV_H
@@ -1,23 +1,26 @@
 #include "interpolator_sV.h"
 #include "abstractFrameSource_sV.h"
 #include "../lib/flowField_sV.h"
+#include "../lib/consistencyMap_sV.h"
 #include "../lib/interpolate_sV.h"
+#include "../lib/profiler_sV.h"
 #include <QtCore/QObject>
 
 #define MIN_FRAME_DIST .001
 
-QImage Interpolator_sV::interpolate(Project_sV *pr, float frame, const RenderPreferences_sV &prefs)
+FloatImage_sV Interpolator_sV::interpolate(Project_sV *pr, float frame, const RenderPreferences_sV &prefs)
                             throw(FlowBuildingError, InterpolationError)
 {
+    Profiler_sV::Timer timer(Profiler_sV::Stage_Interpolate);
     if (frame > pr->frameSource()->framesCount()) {
         throw InterpolationError(QObject::tr("Requested frame %1: Not within valid range. (%2 frames)")
                                  .arg(frame).arg(pr->frameSource()->framesCount()));
     }
     if (frame-floor(frame) > MIN_FRAME_DIST) {
 
-        QImage left = pr->frameSource()->frameAt(floor(frame), prefs.size);
-        QImage right = pr->frameSource()->frameAt(floor(frame)+1, prefs.size);
-        QImage out(left.size(), QImage::Format_ARGB32);
+        FloatImage_sV left = FloatImage_sV::fromImage(pr->frameSource()->frameAt(floor(frame), prefs.size));
+        FloatImage_sV right = FloatImage_sV::fromImage(pr->frameSource()->frameAt(floor(frame)+1, prefs.size));
+        FloatImage_sV out(left.size());
 
         /// Position between two frames, on [0 1]
         const float pos = frame-floor(frame);
@@ -34,7 +37,9 @@ QImage Interpolator_sV::interpolate(Project_sV *pr, float frame, const RenderPre
                 Q_ASSERT(false);
             }
 
-            Interpolate_sV::twowayFlow(left, right, forwardFlow, backwardFlow, pos, out);
+            ConsistencyMap_sV *consistency = pr->requestConsistencyMap(floor(frame), floor(frame)+1, prefs.size, forwardFlow, backwardFlow);
+            Interpolate_sV::twowayFlow(left, right, forwardFlow, backwardFlow, pos, out, consistency);
+            delete consistency;
             delete forwardFlow;
             delete backwardFlow;
 
@@ -50,7 +55,9 @@ QImage Interpolator_sV::interpolate(Project_sV *pr, float frame, const RenderPre
                 Q_ASSERT(false);
             }
 
-            Interpolate_sV::newTwowayFlow(left, right, forwardFlow, backwardFlow, pos, out);
+            ConsistencyMap_sV *consistency = pr->requestConsistencyMap(floor(frame), floor(frame)+1, prefs.size, forwardFlow, backwardFlow);
+            Interpolate_sV::newTwowayFlow(left, right, forwardFlow, backwardFlow, pos, out, consistency);
+            delete consistency;
             delete forwardFlow;
             delete backwardFlow;
 
@@ -98,6 +105,6 @@ QImage Interpolator_sV::interpolate(Project_sV *pr, float frame, const RenderPre
         return out;
     } else {
         qDebug() << "No interpolation necessary.";
-        return pr->frameSource()->frameAt(floor(frame), prefs.size);
+        return FloatImage_sV::fromImage(pr->frameSource()->frameAt(floor(frame), prefs.size));
     }
 }
@@ -3,11 +3,12 @@
 
 #include "renderPreferences_sV.h"
 #include "project_sV.h"
+#include "../lib/floatImage_sV.h"
 
 class Interpolator_sV
 {
 public:
-    static QImage interpolate(Project_sV *project, float frame, const RenderPreferences_sV& prefs)
+    static FloatImage_sV interpolate(Project_sV *project, float frame, const RenderPreferences_sV& prefs)
                              throw(FlowBuildingError, InterpolationError);
 };
 
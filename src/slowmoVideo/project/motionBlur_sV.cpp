@@ -13,9 +13,12 @@ the Free Software Foundation, either version 3 of the License, or
 #include "abstractFrameSource_sV.h"
 #include "abstractFlowSource_sV.h"
 #include "interpolator_sV.h"
+#include "projectPreferences_sV.h"
+#include "cacheManager_sV.h"
 #include "renderTask_sV.h"
 #include "../lib/flowField_sV.h"
 #include "../lib/shutter_sV.h"
+#include "../lib/profiler_sV.h"
 
 #define MAX_CONV_FRAMES 5
 
@@ -30,9 +33,10 @@ MotionBlur_sV::MotionBlur_sV(Project_sV *project) :
     createDirectories();
 }
 
-QImage MotionBlur_sV::blur(float startFrame, float endFrame, float replaySpeed, RenderPreferences_sV prefs)
+FloatImage_sV MotionBlur_sV::blur(float startFrame, float endFrame, float replaySpeed, RenderPreferences_sV prefs)
 throw(RangeTooSmallError_sV)
 {
+    Profiler_sV::Timer timer(Profiler_sV::Stage_Blur);
     if (prefs.motionblur == MotionblurType_Nearest) {
         return nearest(startFrame, prefs);
     } else if (prefs.motionblur == MotionblurType_Convolving) {
@@ -46,12 +50,12 @@ throw(RangeTooSmallError_sV)
     }
 }
 
-QImage MotionBlur_sV::nearest(float startFrame, const RenderPreferences_sV &prefs)
+FloatImage_sV MotionBlur_sV::nearest(float startFrame, const RenderPreferences_sV &prefs)
 {
-    return m_project->frameSource()->frameAt(startFrame, prefs.size);
+    return FloatImage_sV::fromImage(m_project->frameSource()->frameAt(startFrame, prefs.size));
 }
 
-QImage MotionBlur_sV::fastBlur(float startFrame, float endFrame, const RenderPreferences_sV &prefs) throw(RangeTooSmallError_sV)
+FloatImage_sV MotionBlur_sV::fastBlur(float startFrame, float endFrame, const RenderPreferences_sV &prefs) throw(RangeTooSmallError_sV)
 {
     float low, high;
     if (startFrame < endFrame) {
@@ -94,7 +98,7 @@ QImage MotionBlur_sV::fastBlur(float startFrame, float endFrame, const RenderPre
 }
 
 /// \todo fixed distance as additional option
-QImage MotionBlur_sV::slowmoBlur(float startFrame, float endFrame, const RenderPreferences_sV &prefs)
+FloatImage_sV MotionBlur_sV::slowmoBlur(float startFrame, float endFrame, const RenderPreferences_sV &prefs)
 {
     float low, high;
     if (startFrame < endFrame) {
@@ -122,7 +126,7 @@ QImage MotionBlur_sV::slowmoBlur(float startFrame, float endFrame, const RenderP
     return Shutter_sV::combine(frameList);
 }
 
-QImage MotionBlur_sV::convolutionBlur(float startFrame, float endFrame, float replaySpeed, const RenderPreferences_sV &prefs)
+FloatImage_sV MotionBlur_sV::convolutionBlur(float startFrame, float endFrame, float replaySpeed, const RenderPreferences_sV &prefs)
 {
     float low, high;
     if (startFrame < endFrame) {
@@ -137,7 +141,7 @@ QImage MotionBlur_sV::convolutionBlur(float startFrame, float endFrame, float re
         if (floor(low) < m_project->frameSource()->framesCount()-1) {
             qDebug() << "Small shutter." << startFrame << endFrame;
             FlowField_sV *field = m_project->requestFlow(floor(low), floor(low)+1, prefs.size);
-            QImage blur = Shutter_sV::convolutionBlur(Interpolator_sV::interpolate(m_project, startFrame, prefs),
+            FloatImage_sV blur = Shutter_sV::convolutionBlur(Interpolator_sV::interpolate(m_project, startFrame, prefs),
                                                       field,
                                                       high-low,
                                                       low-floor(low));
@@ -146,11 +150,12 @@ QImage MotionBlur_sV::convolutionBlur(float startFrame, float endFrame, float re
         } else {
             /// \todo Convolve last frame as well
             qDebug() << "No shutter, at the last frame.";
-            return m_project->frameSource()->frameAt(floor(low), prefs.size);
+            return FloatImage_sV::fromImage(m_project->frameSource()->frameAt(floor(low), prefs.size));
         }
     }
 
-    QList<QImage> images;
+    // The blurred frames are added up right away instead of keeping all of them in memory.
+    Shutter_sV::Accumulator blurred;
     FlowField_sV *field;
     int start = floor(low);
     int end = std::min((int64_t)ceil(high), m_project->frameSource()->framesCount()-2);
@@ -162,19 +167,19 @@ QImage MotionBlur_sV::convolutionBlur(float startFrame, float endFrame, float re
         if (low-start > .1) {
             qDebug() << "First part: " << start << low;
             field = m_project->requestFlow(start, start+1, prefs.size);
-            images << Shutter_sV::convolutionBlur(Interpolator_sV::interpolate(m_project, startFrame, prefs),
-                                                  field,
-                                                  floor(low)+1 - low,
-                                                  low-floor(low));
+            blurred.add(Shutter_sV::convolutionBlur(Interpolator_sV::interpolate(m_project, startFrame, prefs),
+                                                    field,
+                                                    floor(low)+1 - low,
+                                                    low-floor(low)));
             delete field;
             start++;
         }
         if (end-high > .1) {
             qDebug() << "Last part: " << end-1 << high;
             field = m_project->requestFlow(end-1, end, prefs.size);
-            images << Shutter_sV::convolutionBlur(m_project->frameSource()->frameAt(end-1, prefs.size),
-                                                  field,
-                                                  1 + high-end);
+            blurred.add(Shutter_sV::convolutionBlur(FloatImage_sV::fromImage(m_project->frameSource()->frameAt(end-1, prefs.size)),
+                                                    field,
+                                                    1 + high-end));
             delete field;
             end--;
         }
@@ -192,33 +197,37 @@ QImage MotionBlur_sV::convolutionBlur(float startFrame, float endFrame, float re
         qDebug() << "Parts scaled to " << start << end << " with increment " << inc;
     }
     for (int f = start; f <= end; f += inc) {
-        QString name = QString("%1/convolved-%2+%3.png").arg(cacheDir(prefs.size).absolutePath()).arg(f).arg(inc);
+        CacheKey_sV key = cacheKey("convolved", prefs);
+        key.add("frame", f).add("inc", inc);
+        QString name = cacheDir(prefs.size).absoluteFilePath(key.fileName("convolved", "png"));
         if (replaySpeed < 2) {
             if (QFileInfo(name).exists()) {
                 qDebug() << "Using convolved image from cache: " << name;
-                images << QImage(name);
+                m_project->cacheManager()->recordAccess(name);
+                blurred.add(FloatImage_sV::fromImage(QImage(name)));
                 continue;
             }
         }
         field = m_project->requestFlow(f, f+1, prefs.size);
-        images << Shutter_sV::convolutionBlur(m_project->frameSource()->frameAt(f, prefs.size),
-                                              field,
-                                              inc);
+        FloatImage_sV convolved = Shutter_sV::convolutionBlur(FloatImage_sV::fromImage(m_project->frameSource()->frameAt(f, prefs.size)),
+                                                              field,
+                                                              inc);
+#ifdef DEBUG
+        convolved.toImage().save(QString("/tmp/mblur-%1.png").arg(blurred.count()));
+#endif
+        blurred.add(convolved);
         if (replaySpeed < 2) {
             qDebug() << "Caching convolved image: " << name;
-            images.last().save(name);
+            if (convolved.toImage().save(name)) {
+                key.writeManifestEntry(cacheDir(prefs.size), QFileInfo(name).fileName());
+                m_project->cacheManager()->recordAccess(name);
+            }
         }
 
         delete field;
     }
 
-#ifdef DEBUG
-    for (int i = 0; i < images.size(); i++) {
-        images.at(i).save(QString("/tmp/mblur-%1.png").arg(i));
-    }
-#endif
-
-    return Shutter_sV::combine(images);
+    return blurred.average();
 }
 
 QDir MotionBlur_sV::cacheDir(FrameSize size) const
@@ -235,29 +244,44 @@ QDir MotionBlur_sV::cacheDir(FrameSize size) const
     }
 }
 
+CacheKey_sV MotionBlur_sV::cacheKey(const QString &type, const RenderPreferences_sV &prefs) const
+{
+    CacheKey_sV key;
+    key.add("type", type)
+       .add("size", toString(prefs.size))
+       .add("interpolation", toString(prefs.interpolation))
+       .add("flow", m_project->flowSource()->identifier())
+       .add("lambda", QString::number(m_project->preferences()->flowV3DLambda(), 'f', 2))
+       .add("flowScale", QString::number(m_project->preferences()->flowScale(), 'f', 2))
+       .add("flowInit", m_project->preferences()->flowSmallInit() ? "small" : "none")
+       .add("flowWarmStart", m_project->preferences()->flowWarmStart() ? "on" : "off")
+       .add("temporalMedian", QString::number(m_project->preferences()->flowTemporalMedian()))
+       .add("blend", "consistency")
+       .add("source", m_project->cacheRevision());
+    return key;
+}
+
 QString MotionBlur_sV::cachedFramePath(float framePos, const RenderPreferences_sV &prefs, bool highPrecision)
 {
-    int precision = 2;
-    if (highPrecision) { precision = 2; } /// \todo check precision
-    int width = 5+1 + precision;
-    QString name = QString("%2/cached%1.png").arg(framePos, width, 'f', precision, '0');
-    if (prefs.size == FrameSize_Small) {
-        name = name.arg(m_dirCacheSmall.absolutePath());
-    } else if (prefs.size == FrameSize_Orig) {
-        name = name.arg(m_dirCacheOrig.absolutePath());
-    } else {
-        qDebug() << "MotionBlur: Frame size " << toString(prefs.size) << " given, not supported!";
-        Q_ASSERT(false);
-    }
     if (fabs(framePos-int(framePos)) < MOTIONBLUR_PRECISION_LIMIT) {
-        name = m_project->frameSource()->framePath(uint(framePos), prefs.size);
-    } else {
-        if (!QFileInfo(name).exists()) {
-            qDebug() << name << " does not exist yet. Interpolating and saving to cache.";
-            QImage frm = Interpolator_sV::interpolate(m_project, framePos, prefs);
-            frm.save(name);
+        return m_project->frameSource()->framePath(uint(framePos), prefs.size);
+    }
+
+    int precision = 3;
+    if (highPrecision) { precision = 4; }
+    CacheKey_sV key = cacheKey("cached", prefs);
+    key.add("pos", QString::number(framePos, 'f', precision));
+
+    QDir dir = cacheDir(prefs.size);
+    QString name = dir.absoluteFilePath(key.fileName("cached", "png"));
+    if (!QFileInfo(name).exists()) {
+        qDebug() << name << " does not exist yet. Interpolating and saving to cache.";
+        QImage frm = Interpolator_sV::interpolate(m_project, framePos, prefs).toImage();
+        if (frm.save(name)) {
+            key.writeManifestEntry(dir, QFileInfo(name).fileName());
         }
     }
+    m_project->cacheManager()->recordAccess(name);
     return name;
 }
 
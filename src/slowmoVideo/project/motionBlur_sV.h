@@ -12,8 +12,9 @@ the Free Software Foundation, either version 3 of the License, or
 #define MOTIONBLUR_SV_H
 
 #include <QtCore/QDir>
-#include <QtGui/QImage>
 #include "renderPreferences_sV.h"
+#include "../lib/floatImage_sV.h"
+#include "cacheKey_sV.h"
 class Project_sV;
 
 /// Thrown if the frame range is too small for motion blur to still make sense
@@ -27,6 +28,10 @@ public:
 
 /**
   \brief Renders motion blur
+
+  Interpolated and convolved frames are cached in the project directory. Cached files are named
+  after a CacheKey_sV containing all inputs (frame position, size, interpolation type, flow method
+  and lambda, frame source), so they can safely be kept across renderings with different settings.
   \todo Force fast blurring for a segment?
   \todo Use .jpg for cached frames?
   */
@@ -39,25 +44,25 @@ public:
       Selects either fastBlur() or slowmoBlur(), depending on the replay speed.
       \param replaySpeed Must be >= 0
       */
-    QImage blur(float startFrame, float endFrame, float replaySpeed, RenderPreferences_sV prefs) throw(RangeTooSmallError_sV);
+    FloatImage_sV blur(float startFrame, float endFrame, float replaySpeed, RenderPreferences_sV prefs) throw(RangeTooSmallError_sV);
 
     /**
       Blurs frames using cached frames on fixed, coarse-grained intervals.
       If the replay speed is high enough, it does not matter if frame 1.424242 or frame 1.5 is used
       together with other frames for rendering motion blur. That way calculation can be sped up a little bit.
       */
-    QImage fastBlur(float startFrame, float endFrame, const RenderPreferences_sV &prefs) throw(RangeTooSmallError_sV);
+    FloatImage_sV fastBlur(float startFrame, float endFrame, const RenderPreferences_sV &prefs) throw(RangeTooSmallError_sV);
 
     /**
       Blurs frames that are re-played at very low speed, such that fastBlur() cannot be used.
       The blurred parts of the image still need to move slowly, rounding frames to interpolate to 0.5
       would not work therefore.
       */
-    QImage slowmoBlur(float startFrame, float endFrame, const RenderPreferences_sV& prefs);
+    FloatImage_sV slowmoBlur(float startFrame, float endFrame, const RenderPreferences_sV& prefs);
 
-    QImage convolutionBlur(float startFrame, float endFrame, float replaySpeed, const RenderPreferences_sV& prefs);
+    FloatImage_sV convolutionBlur(float startFrame, float endFrame, float replaySpeed, const RenderPreferences_sV& prefs);
 
-    QImage nearest(float startFrame, const RenderPreferences_sV& prefs);
+    FloatImage_sV nearest(float startFrame, const RenderPreferences_sV& prefs);
 
     /**
       \fn setSlowmoSamples();
@@ -88,6 +93,8 @@ private:
     float m_slowmoMaxFrameDist;
 
     QString cachedFramePath(float framePos, const RenderPreferences_sV &prefs, bool highPrecision = false);
+    /** \return Key with all inputs that are common to cached frames and convolved images */
+    CacheKey_sV cacheKey(const QString &type, const RenderPreferences_sV &prefs) const;
     void createDirectories();
 
     QDir cacheDir(FrameSize size) const;
@@ -70,19 +70,16 @@ qreal NodeList_sV::totalTime() const
 {
     return endTime()-startTime();
 }
-qreal NodeList_sV::sourceTime(qreal targetTime) const
+qreal NodeList_sV::sourceTime(qreal targetTime, int *hint) const
 {
     qreal srcTime = -1;
-    int index = find(targetTime);
+    int index = find(targetTime, hint);
     if (index >= 0) {
         if (m_list.size() > index+1) {
             if (m_list.at(index).rightCurveType() == CurveType_Bezier
                     && m_list.at(index+1).leftCurveType() == CurveType_Bezier) {
-                srcTime = BezierTools_sV::interpolateAtX(targetTime,
-                                                         m_list.at(index).toQPointF(),
-                                                         m_list.at(index).toQPointF()+m_list.at(index).rightNodeHandle(),
-                                                         m_list.at(index+1).toQPointF()+m_list.at(index+1).leftNodeHandle(),
-                                                         m_list.at(index+1).toQPointF()).y();
+                const BezierTools_sV::Polynomial &curve = m_segments.at(index).bezier();
+                srcTime = BezierTools_sV::interpolateAtX(targetTime, curve).y();
             } else {
                 float ratio = (targetTime-m_list[index].x())/(m_list[index+1].x()-m_list[index].x());
                 srcTime = m_list[index].y() + ratio*( m_list[index+1].y()-m_list[index].y() );
@@ -156,6 +153,7 @@ bool NodeList_sV::add(Node_sV node)
     qDebug() << "After adding: \n" << *this;
 #endif
 
+    updateCurves();
     validate();
     return add;
 }
@@ -174,6 +172,7 @@ uint NodeList_sV::deleteSelected()
             i++;
         }
     }
+    updateCurves();
     validate();
     return counter;
 }
@@ -193,6 +192,7 @@ void NodeList_sV::deleteNode(int index)
             m_list[index].setLeftCurveType(CurveType_Linear);
         }
     }
+    updateCurves();
     validate();
 }
 
@@ -319,6 +319,7 @@ void NodeList_sV::moveSelected(const Node_sV &time)
             m_list[i].move(newTime);
         }
     }
+    updateCurves();
 }
 void NodeList_sV::shift(qreal after, qreal by)
 {
@@ -340,6 +341,7 @@ void NodeList_sV::shift(qreal after, qreal by)
             m_list[pos].move(Node_sV(by, 0));
         }
     }
+    updateCurves();
     if (!validate()) {
         qDebug() << "Invalid node configuration! (This should not happen.)";
     }
@@ -350,6 +352,7 @@ void NodeList_sV::confirmMove()
     for (int i = 0; i < m_list.size(); i++) {
         m_list[i].confirmMove();
     }
+    updateCurves();
     validate();
 }
 void NodeList_sV::abortMove()
@@ -359,6 +362,7 @@ void NodeList_sV::abortMove()
             m_list[i].abortMove();
         }
     }
+    updateCurves();
 }
 
 void NodeList_sV::moveHandle(const NodeHandle_sV *handle, Node_sV relPos)
@@ -397,6 +401,8 @@ void NodeList_sV::moveHandle(const NodeHandle_sV *handle, Node_sV relPos)
 
         currentNode->setRightNodeHandle(relPos.x(), relPos.y());
     }
+    updateCurve(nodeIndex-1);
+    updateCurve(nodeIndex);
     validate();
 }
 
@@ -439,6 +445,7 @@ void NodeList_sV::fixHandles(int leftIndex)
         }
         m_list[leftIndex].setRightNodeHandle(leftHandle, m_list.at(leftIndex).rightNodeHandle().y());
         m_list[leftIndex+1].setLeftNodeHandle(rightHandle, m_list.at(leftIndex+1).leftNodeHandle().y());
+        updateCurve(leftIndex);
     }
 }
 void NodeList_sV::setSpeed(qreal segmentTime, qreal speed)
@@ -470,12 +477,32 @@ void NodeList_sV::setSpeed(qreal segmentTime, qreal speed)
     } else {
         qDebug() << "Outside segment.";
     }
+    updateCurves();
     validate();
 }
 
 
 
 
+void NodeList_sV::updateCurve(int leftIndex)
+{
+    if (leftIndex >= 0 && leftIndex+1 < m_list.size() && leftIndex < m_segments.size()) {
+        const Node_sV &left = m_list.at(leftIndex);
+        const Node_sV &right = m_list.at(leftIndex+1);
+        m_segments[leftIndex].setBezier(left.toQPointF(), left.toQPointF()+left.rightNodeHandle(),
+                                        right.toQPointF()+right.leftNodeHandle(), right.toQPointF());
+    }
+}
+void NodeList_sV::updateCurves()
+{
+    for (int i = 0; i+1 < m_list.size(); i++) {
+        updateCurve(i);
+    }
+}
+
+
+
+
 ////////// Access
 
 int NodeList_sV::indexOf(const Node_sV *node) const
@@ -483,24 +510,34 @@ int NodeList_sV::indexOf(const Node_sV *node) const
     return m_list.indexOf(*node);
 }
 
-int NodeList_sV::find(qreal time) const
+int NodeList_sV::find(qreal time, int *hint) const
 {
-    int pos;
-    for (
-         pos = 0;
-         m_list.size() > (pos+1) && m_list.at(pos+1).x() <= time;
-         pos++
-         ) {}
-    if (m_list.size() == 0 || (pos == 0 && time < m_list[0].x())) {
+    // Sequential access (rendering, drawing the curve) usually hits the same
+    // or the next segment as the previous call, so try these first.
+    // The hint is validated on every use, a stale value only costs the binary search.
+    if (hint != NULL) {
+        for (int pos = *hint; pos >= 0 && pos <= *hint+1 && pos < m_list.size(); pos++) {
+            if (m_list.at(pos).x() <= time && (pos+1 == m_list.size() || time < m_list.at(pos+1).x())) {
+                *hint = pos;
+                return pos;
+            }
+        }
+    }
+
+    int pos = upperBound(time, true) - 1;
+    if (pos < 0) {
 #ifdef DEBUG_NL
         if (m_list.size() > 0) {
             std::cout.precision(30);
             std::cout << "find(): time: " << time << ", left boundary: " << m_list[0].x()
                       << ", unmoved: " << m_list[0].xUnmoved()
-                      << ", diff: " << m_list[pos].x()-time << std::endl;
+                      << ", diff: " << m_list[0].x()-time << std::endl;
         }
 #endif
-        pos = -1;
+        return -1;
+    }
+    if (hint != NULL) {
+        *hint = pos;
     }
     return pos;
 }
@@ -517,17 +554,26 @@ int NodeList_sV::find(QPointF pos, qreal tdelta) const
 
 void NodeList_sV::findBySegment(qreal tx, int &leftIndex_out, int &rightIndex_out) const
 {
-    for (int i = 0; i < m_list.size(); i++) {
-        leftIndex_out = i-1;
-        rightIndex_out = i;
-        if (m_list.at(i).xUnmoved() > tx) {
-            break;
-        }
-        if (i == m_list.size()-1) {
-            leftIndex_out = i;
-            rightIndex_out = -1;
+    int right = upperBound(tx, false);
+    leftIndex_out = right-1;
+    rightIndex_out = (right < m_list.size()) ? right : -1;
+}
+
+int NodeList_sV::upperBound(qreal time, bool useMoved) const
+{
+    int first = 0;
+    int count = m_list.size();
+    while (count > 0) {
+        int step = count/2;
+        int mid = first + step;
+        if ((useMoved ? m_list.at(mid).x() : m_list.at(mid).xUnmoved()) <= time) {
+            first = mid+1;
+            count -= step+1;
+        } else {
+            count = step;
         }
     }
+    return first;
 }
 
 QList<NodeList_sV::PointerWithDistance> NodeList_sV::objectsNear(QPointF pos, qreal tmaxdist) const
@@ -535,8 +581,17 @@ QList<NodeList_sV::PointerWithDistance> NodeList_sV::objectsNear(QPointF pos, qr
     qreal maxdist2 = std::pow(tmaxdist, 2);
 
     QList<PointerWithDistance> objects;
+    if (m_list.size() == 0) {
+        return objects;
+    }
+
+    // Nodes are sorted, and handles cannot reach past the neighbouring nodes (see validate()),
+    // so only nodes within the search radius plus one neighbour on each side need to be checked.
+    int from = qMax(0, upperBound(pos.x() - tmaxdist, true) - 2);
+    int to = qMin(m_list.size()-1, upperBound(pos.x() + tmaxdist, true));
+
     qreal dist;
-    for (int i = 0; i < m_list.size(); i++) {
+    for (int i = from; i <= to; i++) {
 
         dist = dist2(m_list.at(i).toQPointF()  -  pos);
         if (dist <= maxdist2) {
@@ -555,11 +610,11 @@ QList<NodeList_sV::PointerWithDistance> NodeList_sV::objectsNear(QPointF pos, qr
                 objects << PointerWithDistance(&m_list[i].rightNodeHandle(), dist, PointerWithDistance::Handle);
             }
         }
-        if (i > 0) {
-            if (m_list.at(i-1).x() < pos.x() && m_list.at(i).x() > pos.x()) {
-                objects << PointerWithDistance(&m_segments.at(i-1), std::pow(sourceTime(pos.x()) - pos.y(), 2), PointerWithDistance::Segment);
-            }
-        }
+    }
+
+    int left = find(pos.x());
+    if (left >= 0 && left+1 < m_list.size() && m_list.at(left).x() < pos.x()) {
+        objects << PointerWithDistance(&m_segments.at(left), std::pow(sourceTime(pos.x()) - pos.y(), 2), PointerWithDistance::Segment);
     }
 
     qSort(objects);
@@ -572,16 +627,20 @@ qreal NodeList_sV::dist2(QPointF point) const
 
 int NodeList_sV::nodeAfter(qreal time) const
 {
-    int pos = 0;
-    while (m_list.size() > pos) {
-        if (m_list.at(pos).xUnmoved() >= time) {
-            break;
+    // First node with xUnmoved() >= time
+    int first = 0;
+    int count = m_list.size();
+    while (count > 0) {
+        int step = count/2;
+        int mid = first + step;
+        if (m_list.at(mid).xUnmoved() < time) {
+            first = mid+1;
+            count -= step+1;
+        } else {
+            count = step;
         }
-        pos++;
-    }
-    if (pos >= m_list.size()) {
-        pos = -1;
     }
+    int pos = (first < m_list.size()) ? first : -1;
     Q_ASSERT(pos < 0 || m_list.at(pos).xUnmoved() >= time);
     return pos;
 }
@@ -60,7 +60,7 @@ public:
 
     void setMaxY(qreal time); ///< Sets the maximum y value that is allowed, usually the duration of the input.
 
-    qreal sourceTime(qreal targetTime) const; ///< Calculates the source time in seconds for the given output time.
+    qreal sourceTime(qreal targetTime, int *hint = NULL) const; ///< Calculates the source time in seconds for the given output time. See find() for \c hint.
     qreal startTime(bool useMoved = false) const; ///< Time of the first node. useMoved uses the unconfirmed position of the node while it is moved.
     qreal endTime(bool useMoved = false) const; ///< Time of the rightmost node. See totalTime() for the curve length.
     qreal totalTime() const; ///< Length of the curve, ignores space (startTime())at the beginning.
@@ -103,6 +103,12 @@ public:
 
     void setSpeed(qreal segmentTime, qreal speed);
 
+    /**
+      Recalculates the bézier polynomials of all segments. The methods above do this themselves,
+      it is only required after nodes or handles have been changed directly through operator[].
+      */
+    void updateCurves();
+
 
 
     /**
@@ -113,8 +119,12 @@ public:
     /**
       @return The position of the node whose target time (x()) is <= time,
       or -1 if there is no such node.
+      Uses a binary search. For sequential lookups (like for all frames of a rendering) the caller
+      can keep the last result in \c hint, which is checked first and updated, such that they are
+      answered in constant time. The hint belongs to the caller, so lookups from different threads
+      do not interfere.
       */
-    int find(qreal time) const;
+    int find(qreal time, int *hint = NULL) const;
 
     /**
       @return The position of the first node in the list which is within a radius
@@ -161,6 +171,11 @@ private:
     SegmentList_sV m_segments;
     const float m_minDist;
 
+    /// Recalculates the bézier polynomial of the segment right of node \c leftIndex, see Segment_sV::bezier()
+    void updateCurve(int leftIndex);
+
+    /// \return The index of the first node with a time > \c time, or size() if there is none.
+    int upperBound(qreal time, bool useMoved) const;
     qreal bezierSourceTime(qreal targetTime, QPointF p0, QPointF p1, QPointF p2, QPointF p3) const;
     inline qreal dist2(QPointF point) const;
 };
@@ -0,0 +1,208 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "pipeRenderTarget_sV.h"
+#include "renderTask_sV.h"
+#include "frameQueue_sV.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QProcess>
+#include <QtCore/QSettings>
+#include <QDebug>
+
+/// Default number of frames waiting for the encoder
+#define DEFAULT_QUEUE_SIZE 4
+/// Number of characters of the encoder output that are kept for error messages
+#define LOG_SIZE 2000
+/// Time in ms the encoder may take to start
+#define START_TIMEOUT 10000
+
+PipeRenderTarget_sV::PipeRenderTarget_sV(RenderTask_sV *parentRenderTask) :
+    AbstractRenderTarget_sV(parentRenderTask),
+    m_width(0),
+    m_height(0),
+    m_queueSize(DEFAULT_QUEUE_SIZE),
+    m_queue(NULL),
+    m_writer(NULL),
+    m_process(NULL)
+{
+    QSettings settings;
+    m_executable = settings.value("binaries/ffmpeg", "ffmpeg").toString();
+}
+PipeRenderTarget_sV::~PipeRenderTarget_sV()
+{
+    stopWriter();
+}
+
+void PipeRenderTarget_sV::setExecutable(const QString &executable)
+{
+    m_executable = executable;
+}
+void PipeRenderTarget_sV::setArguments(const QStringList &arguments)
+{
+    m_arguments = arguments;
+}
+void PipeRenderTarget_sV::setTargetFile(const QString &filename)
+{
+    m_filename = filename;
+}
+void PipeRenderTarget_sV::setQueueSize(int frames)
+{
+    Q_ASSERT(frames > 0);
+    m_queueSize = frames;
+}
+
+QStringList PipeRenderTarget_sV::commandLine() const
+{
+    // QImage::Format_ARGB32 is stored as 32-bit integers 0xAARRGGBB.
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    const QString pixelFormat = "bgra";
+#else
+    const QString pixelFormat = "argb";
+#endif
+
+    QStringList args;
+    args << "-f" << "rawvideo"
+         << "-pix_fmt" << pixelFormat
+         << "-s" << QString("%1x%2").arg(m_width).arg(m_height)
+         << "-r" << QString("%1/%2").arg(renderTask()->fps().num).arg(renderTask()->fps().den)
+         << "-i" << "-";
+    args << m_arguments;
+    if (m_filename.length() > 0) {
+        args << "-y" << m_filename;
+    }
+    return args;
+}
+
+void PipeRenderTarget_sV::openRenderTarget() throw(Error_sV)
+{
+    if (m_executable.length() == 0) {
+        throw Error_sV(QObject::tr("No encoder executable given."));
+    }
+    QSize size = renderTask()->resolution();
+    m_width = size.width();
+    m_height = size.height();
+
+    stopWriter();
+    m_log.clear();
+    m_queue = new FrameQueue_sV(m_queueSize);
+    m_writer = new FrameConsumerThread_sV(m_queue, this);
+    m_writer->start();
+}
+
+void PipeRenderTarget_sV::slotConsumeFrame(const QImage &image, const int frameNumber)
+{
+    if (m_queue == NULL) {
+        throw Error_sV(QObject::tr("Pipe render target has not been opened, cannot add frame %1.").arg(frameNumber));
+    }
+    // Blocks while the encoder is busy with previous frames.
+    if (!m_queue->push(image, frameNumber)) {
+        throw Error_sV(stopWriter());
+    }
+}
+
+void PipeRenderTarget_sV::beginConsuming() throw(Error_sV)
+{
+    Q_ASSERT(m_process == NULL);
+    QStringList args = commandLine();
+    qDebug() << "Starting encoder " << m_executable << args;
+
+    m_process = new QProcess();
+    m_process->setProcessChannelMode(QProcess::MergedChannels);
+    m_process->start(m_executable, args);
+    if (!m_process->waitForStarted(START_TIMEOUT)) {
+        throw Error_sV(QObject::tr("Encoder %1 could not be started:\n%2")
+                       .arg(m_executable).arg(m_process->errorString()));
+    }
+}
+
+void PipeRenderTarget_sV::consumeQueuedFrame(const QImage &image, int frameNumber) throw(Error_sV)
+{
+    Q_ASSERT(m_process != NULL);
+    if (image.width() != m_width || image.height() != m_height) {
+        throw Error_sV(QObject::tr("Frame %1 has size %2x%3 instead of %4x%5.")
+                       .arg(frameNumber).arg(image.width()).arg(image.height()).arg(m_width).arg(m_height));
+    }
+
+    // Rows of 32-bit images are not padded, so the image can be written in one go.
+    QImage argb = image;
+    if (argb.format() != QImage::Format_ARGB32 && argb.format() != QImage::Format_RGB32) {
+        argb = image.convertToFormat(QImage::Format_ARGB32);
+    }
+
+    qint64 written = m_process->write((const char*) argb.constBits(), argb.byteCount());
+    bool ok = (written == argb.byteCount());
+    while (ok && m_process->bytesToWrite() > 0) {
+        ok = m_process->waitForBytesWritten(-1);
+    }
+    // Also prevents the encoder from blocking on a full output pipe.
+    readLog();
+    if (!ok) {
+        throw Error_sV(QObject::tr("Frame %1 could not be written to the encoder (%2).\n%3")
+                       .arg(frameNumber).arg(m_process->errorString()).arg(m_log));
+    }
+}
+
+void PipeRenderTarget_sV::endConsuming(bool failed) throw(Error_sV)
+{
+    if (m_process == NULL) {
+        return;
+    }
+    QString error;
+    m_process->closeWriteChannel();
+    if (failed) {
+        m_process->kill();
+    }
+    m_process->waitForFinished(-1);
+    readLog();
+    if (!failed && (m_process->exitStatus() != QProcess::NormalExit || m_process->exitCode() != 0)) {
+        error = QObject::tr("Encoder %1 failed with exit code %2.\n%3")
+                .arg(m_executable).arg(m_process->exitCode()).arg(m_log);
+    }
+    delete m_process;
+    m_process = NULL;
+
+    if (error.length() > 0) {
+        throw Error_sV(error);
+    }
+}
+
+void PipeRenderTarget_sV::readLog()
+{
+    m_log.append(QString::fromLocal8Bit(m_process->readAll()));
+    if (m_log.length() > LOG_SIZE) {
+        m_log = m_log.right(LOG_SIZE);
+    }
+}
+
+QString PipeRenderTarget_sV::stopWriter()
+{
+    QString error;
+    if (m_writer != NULL) {
+        m_queue->close();
+        m_writer->wait();
+        if (m_writer->failed()) {
+            error = m_writer->errorMessage();
+        }
+        delete m_writer;
+        m_writer = NULL;
+    }
+    delete m_queue;
+    m_queue = NULL;
+    return error;
+}
+
+void PipeRenderTarget_sV::closeRenderTarget() throw(Error_sV)
+{
+    QString error = stopWriter();
+    if (error.length() > 0) {
+        throw Error_sV(error);
+    }
+}
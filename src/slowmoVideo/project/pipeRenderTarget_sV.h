@@ -0,0 +1,89 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef PIPERENDERTARGET_SV_H
+#define PIPERENDERTARGET_SV_H
+
+#include "abstractRenderTarget_sV.h"
+#include "frameConsumerThread_sV.h"
+
+#include <QtCore/QStringList>
+
+class QProcess;
+class RenderTask_sV;
+class FrameQueue_sV;
+
+/**
+  \brief Streams raw frames to an external encoder process like ffmpeg.
+
+  The frames are written as raw BGRA video to the process' standard input, such that any
+  encoder and filter of the installed ffmpeg/avconv can be used without intermediate image files.
+  The command line is
+  <pre>&lt;executable&gt; -f rawvideo -pix_fmt bgra -s WxH -r num/den -i - &lt;arguments&gt; -y &lt;target file&gt;</pre>
+  where the target file is omitted if it is empty (e.g. if the arguments already contain the output).
+
+  Like VideoRenderTarget_sV, frames are written on a separate thread through a bounded queue.
+  The process is started and ended on that thread as well.
+  */
+class PipeRenderTarget_sV : public AbstractRenderTarget_sV, public FrameConsumerThread_sV::Consumer
+{
+public:
+    PipeRenderTarget_sV(RenderTask_sV *parentRenderTask);
+    virtual ~PipeRenderTarget_sV();
+
+    /// Encoder executable. Default is the ffmpeg binary from the settings (\c binaries/ffmpeg).
+    void setExecutable(const QString &executable);
+    /// Output arguments for the encoder, like <code>-c:v libx264 -crf 18</code>
+    void setArguments(const QStringList &arguments);
+    /// Output file, appended to the arguments
+    void setTargetFile(const QString &filename);
+    /// Number of rendered frames that may wait for the encoder. Takes effect when opening the target.
+    void setQueueSize(int frames);
+
+    /// \return The arguments the encoder is started with
+    QStringList commandLine() const;
+
+    void openRenderTarget() throw(Error_sV);
+    /// Waits until all frames are written and the encoder has finished. Throws an error if it failed.
+    void closeRenderTarget() throw(Error_sV);
+
+    /// Starts the encoder process; called on the writer thread.
+    void beginConsuming() throw(Error_sV);
+    /// Writes a frame to the encoder; called on the writer thread.
+    void consumeQueuedFrame(const QImage &image, int frameNumber) throw(Error_sV);
+    /// Closes the encoder's input and waits for it to finish; called on the writer thread.
+    void endConsuming(bool failed) throw(Error_sV);
+
+public slots:
+    /// Queues the frame for writing. Throws an Error_sV if the encoder has failed or the target is not open.
+    void slotConsumeFrame(const QImage &image, const int frameNumber);
+
+private:
+    QString m_executable;
+    QStringList m_arguments;
+    QString m_filename;
+
+    int m_width;
+    int m_height;
+
+    int m_queueSize;
+    FrameQueue_sV *m_queue;
+    FrameConsumerThread_sV *m_writer;
+
+    /// Owned by the writer thread
+    QProcess *m_process;
+    /// Last lines of the encoder output, for error messages
+    QString m_log;
+
+    void readLog();
+    QString stopWriter();
+};
+
+#endif // PIPERENDERTARGET_SV_H
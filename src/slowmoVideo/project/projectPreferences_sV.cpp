@@ -14,7 +14,11 @@ ProjectPreferences_sV::ProjectPreferences_sV() :
     m_imagesOutputDir(QDir::homePath()),
     m_imagesFilenamePattern("rendered-%1.jpg"),
     m_videoFilename("/tmp/rendered.mpg"),
-    m_flowV3DLambda(20.0)
+    m_flowV3DLambda(20.0),
+    m_flowWarmStart(false),
+    m_flowScale(1),
+    m_flowSmallInit(false),
+    m_flowTemporalMedian(1)
 {
 }
 
@@ -65,4 +69,8 @@ QString& ProjectPreferences_sV::videoFilename() { return m_videoFilename; }
 QString& ProjectPreferences_sV::videoCodec() { return m_vcodec; }
 
 float& ProjectPreferences_sV::flowV3DLambda() { return m_flowV3DLambda; }
+bool& ProjectPreferences_sV::flowWarmStart() { return m_flowWarmStart; }
+float& ProjectPreferences_sV::flowScale() { return m_flowScale; }
+bool& ProjectPreferences_sV::flowSmallInit() { return m_flowSmallInit; }
+int& ProjectPreferences_sV::flowTemporalMedian() { return m_flowTemporalMedian; }
 
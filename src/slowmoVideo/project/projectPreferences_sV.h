@@ -33,6 +33,14 @@ public:
     QString& videoCodec();
 
     float& flowV3DLambda();
+    /// Initialise the flow of a frame pair from the flow of the neighbouring pair, see AbstractFlowSource_sV::warmStartFlowPath()
+    bool& flowWarmStart();
+    /// Scale at which the flow for the original frame size is built, see AbstractFlowSource_sV::setScale()
+    float& flowScale();
+    /// Initialise the flow of the original size with the flow of the small size, see AbstractFlowSource_sV::setSmallInit()
+    bool& flowSmallInit();
+    /// Number of frame pairs the flow is median filtered over, 1 for no filtering, see TemporalFlowFilter_sV
+    int& flowTemporalMedian();
 
 
 private:
@@ -59,6 +67,10 @@ private:
     QString m_vcodec;
 
     float m_flowV3DLambda;
+    bool m_flowWarmStart;
+    float m_flowScale;
+    bool m_flowSmallInit;
+    int m_flowTemporalMedian;
 
 
 };
@@ -12,18 +12,25 @@ the Free Software Foundation, either version 3 of the License, or
 #include "projectPreferences_sV.h"
 #include "videoFrameSource_sV.h"
 #include "emptyFrameSource_sV.h"
+#include "imagesFrameSource_sV.h"
+#include "cacheKey_sV.h"
+#include "cacheManager_sV.h"
 #include "flowSourceV3D_sV.h"
 #include "flowSourceOpenCV_sV.h"
 #include "interpolator_sV.h"
+#include "temporalFlowFilter_sV.h"
 #include "motionBlur_sV.h"
 #include "nodeList_sV.h"
 #include "renderTask_sV.h"
+#include "renderPlan_sV.h"
 #include "shutterFunction_sV.h"
 #include "shutterFunctionList_sV.h"
 #include "../lib/shutter_sV.h"
 #include "../lib/interpolate_sV.h"
 #include "../lib/flowRW_sV.h"
 #include "../lib/flowField_sV.h"
+#include "../lib/consistencyMap_sV.h"
+#include "../lib/profiler_sV.h"
 
 #include <cmath>
 
@@ -61,8 +68,10 @@ Project_sV::Project_sV(QString projectDir) :
 void Project_sV::init()
 {
     m_preferences = new ProjectPreferences_sV();
+    m_cacheManager = new CacheManager_sV(this);
     m_frameSource = new EmptyFrameSource_sV(this);
     m_flowSource = new FlowSourceV3D_sV(this);
+    m_temporalFilter = new TemporalFlowFilter_sV(this);
     m_motionBlur = new MotionBlur_sV(this);
 
     QSettings settings;
@@ -84,8 +93,10 @@ Project_sV::~Project_sV()
 {
     delete m_preferences;
     delete m_frameSource;
+    delete m_temporalFilter;
     delete m_flowSource;
     delete m_motionBlur;
+    delete m_cacheManager;
     delete m_tags;
     delete m_nodes;
     delete m_renderTask;
@@ -97,6 +108,8 @@ void Project_sV::reloadFlowSource()
     Q_ASSERT(m_flowSource != NULL);
 
     delete m_flowSource;
+    // The buffered flow fields have been built by the previous flow source
+    m_temporalFilter->clear();
 
     QSettings settings;
     if (settings.value("preferences/flowMethod", "V3D").toString() == "V3D") {
@@ -117,6 +130,7 @@ void Project_sV::setProjectDir(QString projectDir)
     m_frameSource->slotUpdateProjectDir();
     m_flowSource->slotUpdateProjectDir();
     m_motionBlur->slotUpdateProjectDir();
+    m_cacheManager->slotUpdateProjectDir();
 }
 
 void Project_sV::setProjectFilename(QString filename)
@@ -137,6 +151,7 @@ void Project_sV::loadFrameSource(AbstractFrameSource_sV *frameSource)
     } else {
         m_frameSource = frameSource;
     }
+    m_temporalFilter->clear();
     m_nodes->setMaxY(m_frameSource->maxTime());
 }
 
@@ -171,68 +186,49 @@ QImage Project_sV::render(qreal outTime, RenderPreferences_sV prefs)
         Q_ASSERT(false);
     }
 
-    float sourceTime = m_nodes->sourceTime(outTime);
-    if (sourceTime < 0) {
-        sourceTime = 0;
-    }
-    if (sourceTime > m_frameSource->maxTime()) {
-        sourceTime = m_frameSource->maxTime();
-    }
-
-    float sourceFrame = sourceTimeToFrame(sourceTime);
-
-    int leftIndex = m_nodes->find(outTime);
-    if (leftIndex < 0) {
-        qDebug() << "left node is not here!";
-        Q_ASSERT(false);
-    }
-    if (leftIndex == m_nodes->size()-1) {
-        // outTime is at the very end of the node.
-        // Take next to last node to still have a right node.
-        leftIndex--;
-    }
-
-    const Node_sV *leftNode = &(*m_nodes)[leftIndex];
-    const Node_sV *rightNode = &(*m_nodes)[leftIndex+1];
+    return render(RenderPlan_sV::planFrame(this, outTime, prefs.fps()), prefs);
+}
 
-    ShutterFunction_sV *shutterFunction = m_shutterFunctions->function(leftNode->shutterFunctionID());
+QImage Project_sV::render(const RenderPlan_sV::Frame &frame, RenderPreferences_sV prefs)
+{
+    return renderFloat(frame, prefs).toImage();
+}
 
-    if (shutterFunction != NULL) {
-        float dy = 0;
-        if (outTime+1/prefs.fps().fps() <= m_nodes->endTime()) {
-            dy = m_nodes->sourceTime(outTime+1/prefs.fps().fps()) - sourceTime;
-        } else {
-            dy = sourceTime - m_nodes->sourceTime(outTime-1/prefs.fps().fps());
-        }
-        float replaySpeed = fabs(dy)*prefs.fps().fps();
-        float shutter = shutterFunction->evaluate(
-                    (outTime-leftNode->x())/(rightNode->x()-leftNode->x()), // x on [0,1]
-                    outTime, // t
-                    prefs.fps().fps(), // FPS
-                    sourceFrame, // y
-                    dy // dy to next frame
-                    );
-        qDebug() << "Shutter value for output time " << outTime << " is " << shutter;
-        if (shutter > 0) {
+FloatImage_sV Project_sV::renderFloat(const RenderPlan_sV::Frame &frame, RenderPreferences_sV prefs)
+{
+    if (frame.hasShutter) {
+        qDebug() << "Shutter value for output time " << frame.outTime << " is " << frame.shutter;
+        if (frame.shutter > 0) {
             try {
-                return m_motionBlur->blur(sourceFrame, sourceFrame+shutter*prefs.fps().fps(),
-                                          replaySpeed,
+                return m_motionBlur->blur(frame.sourceFrame, frame.sourceFrame+frame.shutter*prefs.fps().fps(),
+                                          frame.replaySpeed,
                                           prefs);
             } catch (RangeTooSmallError_sV &err) {}
         }
     }
-    return Interpolator_sV::interpolate(this, sourceFrame, prefs);
+    return Interpolator_sV::interpolate(this, frame.sourceFrame, prefs);
 }
 
 FlowField_sV* Project_sV::requestFlow(int leftFrame, int rightFrame, const FrameSize frameSize) throw(FlowBuildingError)
+{
+    if (m_preferences->flowTemporalMedian() > 1 && dynamic_cast<EmptyFrameSource_sV*>(m_frameSource) == NULL) {
+        // The filter names its files after the source flow, which depends on the flow settings.
+        updateFlowSource();
+        m_temporalFilter->setWindow(m_preferences->flowTemporalMedian());
+        return m_temporalFilter->buildFlow(leftFrame, rightFrame, frameSize);
+    }
+    return requestSourceFlow(leftFrame, rightFrame, frameSize);
+}
+
+FlowField_sV* Project_sV::requestSourceFlow(int leftFrame, int rightFrame, const FrameSize frameSize) throw(FlowBuildingError)
 {
     Q_ASSERT(leftFrame < m_frameSource->framesCount());
     Q_ASSERT(rightFrame < m_frameSource->framesCount());
     if (dynamic_cast<EmptyFrameSource_sV*>(m_frameSource) == NULL) {
 
-        FlowSourceV3D_sV *v3d;
-        if ((v3d = dynamic_cast<FlowSourceV3D_sV*>(m_flowSource)) != NULL) {
-            v3d->setLambda(m_preferences->flowV3DLambda());
+        updateFlowSource();
+
+        if (dynamic_cast<FlowSourceV3D_sV*>(m_flowSource) != NULL) {
             try {
                 return m_flowSource->buildFlow(leftFrame, rightFrame, frameSize);
             } catch (FlowBuildingError err) {
@@ -241,6 +237,7 @@ FlowField_sV* Project_sV::requestFlow(int leftFrame, int rightFrame, const Frame
                 qDebug() << "Failed attempts so far: " << m_v3dFailCounter;
                 delete m_flowSource;
                 m_flowSource = new FlowSourceOpenCV_sV (this);
+                updateFlowSource();
                 return m_flowSource->buildFlow(leftFrame, rightFrame, frameSize);
             }
         }
@@ -250,6 +247,75 @@ FlowField_sV* Project_sV::requestFlow(int leftFrame, int rightFrame, const Frame
     }
 }
 
+void Project_sV::updateFlowSource()
+{
+    m_flowSource->setWarmStart(m_preferences->flowWarmStart());
+    m_flowSource->setScale(m_preferences->flowScale());
+    m_flowSource->setSmallInit(m_preferences->flowSmallInit());
+
+    FlowSourceV3D_sV *v3d;
+    if ((v3d = dynamic_cast<FlowSourceV3D_sV*>(m_flowSource)) != NULL) {
+        v3d->setLambda(m_preferences->flowV3DLambda());
+    }
+}
+
+ConsistencyMap_sV* Project_sV::requestConsistencyMap(int leftFrame, int rightFrame, const FrameSize frameSize,
+                                                     const FlowField_sV *flowLeftRight, const FlowField_sV *flowRightLeft)
+{
+    QString path = m_flowSource->consistencyPath(leftFrame, rightFrame, frameSize);
+    QStringList flowPaths;
+    if (m_preferences->flowTemporalMedian() > 1) {
+        path = m_temporalFilter->consistencyPath(leftFrame, rightFrame, frameSize);
+        flowPaths << m_temporalFilter->flowPath(leftFrame, rightFrame, frameSize)
+                  << m_temporalFilter->flowPath(rightFrame, leftFrame, frameSize);
+    } else {
+        flowPaths << m_flowSource->flowPath(leftFrame, rightFrame, frameSize)
+                  << m_flowSource->flowPath(rightFrame, leftFrame, frameSize);
+    }
+    // The flow may have been built again (e.g. after it was evicted) since the map was saved.
+    if (CacheManager_sV::isUpToDate(path, flowPaths)) {
+        try {
+            Profiler_sV::Timer timer(Profiler_sV::Stage_FlowLoad);
+            ConsistencyMap_sV *map = ConsistencyMap_sV::load(path.toStdString());
+            if (map->width() == flowLeftRight->width() && map->height() == flowLeftRight->height()) {
+                m_cacheManager->recordAccess(path);
+                return map;
+            }
+            delete map;
+        } catch (ConsistencyMap_sV::ConsistencyMapError &err) {
+            qDebug() << "Could not load the consistency map: " << err.message.c_str();
+        }
+    }
+
+    Profiler_sV::Timer timer(Profiler_sV::Stage_FlowBuild);
+    ConsistencyMap_sV *map = ConsistencyMap_sV::fromFlow(flowLeftRight, flowRightLeft);
+    if (map->save(path.toStdString())) {
+        m_cacheManager->recordAccess(path);
+    } else {
+        qDebug() << "Cannot write consistency map to " << path;
+    }
+    return map;
+}
+
+QString Project_sV::cacheRevision() const
+{
+    CacheKey_sV key;
+    key.add("source", m_frameSource->metaObject()->className());
+    if (dynamic_cast<const VideoFrameSource_sV*>(m_frameSource) != NULL) {
+        key.add("file", dynamic_cast<const VideoFrameSource_sV*>(m_frameSource)->videoFile());
+    } else if (dynamic_cast<const ImagesFrameSource_sV*>(m_frameSource) != NULL) {
+        QStringList files = dynamic_cast<const ImagesFrameSource_sV*>(m_frameSource)->inputFiles();
+        key.add("files", files.size());
+        if (files.size() > 0) {
+            key.add("first", files.first());
+            key.add("last", files.last());
+        }
+    }
+    key.add("frames", QString::number(m_frameSource->framesCount()));
+    key.add("fps", m_frameSource->fps()->toString());
+    return key.hash();
+}
+
 inline
 qreal Project_sV::sourceTimeToFrame(qreal time) const
 {
@@ -260,28 +326,13 @@ qreal Project_sV::sourceTimeToFrame(qreal time) const
 qreal Project_sV::snapToFrame(const qreal time, bool roundUp, const Fps_sV &fps, int *out_framesBeforeHere)
 {
     Q_ASSERT(time >= 0);
-    int frameCount = 0;
-    double snapTime = 0;
-    double frameLength;
-    frameLength = 1.0/fps.fps();
-
-    while (snapTime < time) {
-        snapTime += frameLength;
-        frameCount++;
-    }
-
-    // snapTime is now >= time
-
-    if (!roundUp && snapTime != time) {
-        snapTime -= frameLength;
-        frameCount--;
-    }
+    int64_t frameCount = fps.toFrame(time, roundUp);
 
     if (out_framesBeforeHere != NULL) {
-        *out_framesBeforeHere = frameCount;
+        *out_framesBeforeHere = int(frameCount);
     }
 
-    return snapTime;
+    return fps.toTime(frameCount);
 }
 qreal Project_sV::snapToOutFrame(qreal time, bool roundUp, const Fps_sV &fps, int *out_framesBeforeHere) const
 {
@@ -290,7 +341,7 @@ qreal Project_sV::snapToOutFrame(qreal time, bool roundUp, const Fps_sV &fps, in
     }
     time -= m_nodes->startTime();
     if (time < 0) { time = 0; }
-    float snapped = snapToFrame(time, roundUp, fps, out_framesBeforeHere) + m_nodes->startTime();
+    qreal snapped = snapToFrame(time, roundUp, fps, out_framesBeforeHere) + m_nodes->startTime();
     return snapped;
 }
 qreal Project_sV::toOutTime(QString timeExpression, const Fps_sV &fps) const throw(Error_sV)
@@ -14,6 +14,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include "tag_sV.h"
 #include "nodeList_sV.h"
 #include "renderPreferences_sV.h"
+#include "renderPlan_sV.h"
 #include "../lib/defs_sV.hpp"
 extern "C" {
 #include "../lib/videoInfo_sV.h"
@@ -28,10 +29,14 @@ class ProjectPreferences_sV;
 class Flow_sV;
 class AbstractFrameSource_sV;
 class AbstractFlowSource_sV;
+class TemporalFlowFilter_sV;
 class MotionBlur_sV;
+class CacheManager_sV;
 class ShutterFunctionList_sV;
 class RenderTask_sV;
 class FlowField_sV;
+class ConsistencyMap_sV;
+class FloatImage_sV;
 class QSignalMapper;
 class QProcess;
 class QRegExp;
@@ -73,6 +78,7 @@ public:
     QList<Tag_sV> *tags() const { return m_tags; }
     ShutterFunctionList_sV* shutterFunctions() { return m_shutterFunctions; }
     MotionBlur_sV *motionBlur() { return m_motionBlur; }
+    CacheManager_sV *cacheManager() { return m_cacheManager; }
 
     /** \see replaceRenderTask() */
     RenderTask_sV *renderTask() { return m_renderTask; }
@@ -84,6 +90,7 @@ public:
       \brief Snaps in the given time on a grid given by the number of frames per second.
       This allows to, for example, render from 0 to 3.2 seconds and then from 3.2 to 5 seconds
       to images with the same effect as rendering all at once. Always starts from 0!
+      The frame is calculated directly with Fps_sV::toFrame(), so this also works for long times.
       \param time Time to snap in
       \param roundUp To chose between rounding up or down
       \param fps Frames per second to use.
@@ -106,9 +113,32 @@ public:
 
     const QDir getDirectory(const QString &name, bool createIfNotExists = true) const;
 
+    /**
+      \brief Identifies the input frames of this project for cache keys.
+      Changes when a different video or image sequence is loaded, such that cached files
+      built from the previous frame source are not re-used.
+      */
+    QString cacheRevision() const;
+
     QImage render(qreal outTime, RenderPreferences_sV prefs);
+    /** Renders a frame whose source position and shutter have already been calculated, e.g. by a RenderPlan_sV. */
+    QImage render(const RenderPlan_sV::Frame &frame, RenderPreferences_sV prefs);
+    /** Like render(), but returns the frame in the float format of the render core, without rounding it to 8 bits. */
+    FloatImage_sV renderFloat(const RenderPlan_sV::Frame &frame, RenderPreferences_sV prefs);
 
+    /**
+      \return The flow field from \c leftFrame to \c rightFrame, temporally filtered by TemporalFlowFilter_sV
+      if the \c flowTemporalMedian preference is larger than 1.
+      */
     FlowField_sV* requestFlow(int leftFrame, int rightFrame, const FrameSize frameSize) throw(FlowBuildingError);
+    /** \return The flow field from \c leftFrame to \c rightFrame as built by the flow source, without filtering */
+    FlowField_sV* requestSourceFlow(int leftFrame, int rightFrame, const FrameSize frameSize) throw(FlowBuildingError);
+    /**
+      \return The forward/backward consistency of the flow between \c leftFrame and \c rightFrame = leftFrame+1.
+      It is computed from the given flow fields once and then read from the flow cache.
+      */
+    ConsistencyMap_sV* requestConsistencyMap(int leftFrame, int rightFrame, const FrameSize frameSize,
+                                             const FlowField_sV *flowLeftRight, const FlowField_sV *flowRightLeft);
 
     /**
       \brief Searches for objects near the given \c pos.
@@ -132,7 +162,9 @@ private:
 
     AbstractFrameSource_sV *m_frameSource;
     AbstractFlowSource_sV *m_flowSource;
+    TemporalFlowFilter_sV *m_temporalFilter;
     MotionBlur_sV *m_motionBlur;
+    CacheManager_sV *m_cacheManager;
 
     NodeList_sV *m_nodes;
     QList<Tag_sV> *m_tags;
@@ -140,6 +172,8 @@ private:
     ShutterFunctionList_sV *m_shutterFunctions;
 
     qreal sourceTimeToFrame(qreal time) const;
+    /// Passes the flow settings from the preferences to the flow source
+    void updateFlowSource();
 
     void init();
 
@@ -0,0 +1,159 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "rawRenderTarget_sV.h"
+#include "../lib/floatImage_sV.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QObject>
+#include <QtCore/QtEndian>
+#include <QtCore/QDebug>
+
+#include <cstring>
+
+RawRenderTarget_sV::RawRenderTarget_sV(RenderTask_sV *parentRenderTask) :
+    ImagesRenderTarget_sV(parentRenderTask),
+    m_format(Format_PFM)
+{
+    setFilenamePattern("rendered-%1.pfm");
+}
+
+void RawRenderTarget_sV::setFormat(Format format)
+{
+    m_format = format;
+}
+
+RawRenderTarget_sV::Format RawRenderTarget_sV::fromString(const QString &format, bool *ok)
+{
+    bool valid = true;
+    Format f = Format_PFM;
+    if (format.toLower() == "ppm16" || format.toLower() == "ppm") {
+        f = Format_PPM16;
+    } else if (format.toLower() == "pam16" || format.toLower() == "pam") {
+        f = Format_PAM16;
+    } else if (format.toLower() != "pfm") {
+        valid = false;
+    }
+    if (ok != NULL) {
+        *ok = valid;
+    }
+    return f;
+}
+
+/// Clamps to [0,1]
+static inline float clamp01(float v)
+{
+    if (v <= 0) { return 0; }
+    if (v >= 1) { return 1; }
+    return v;
+}
+
+QByteArray RawRenderTarget_sV::encode(const QImage &image, Format format)
+{
+    return encode(FloatImage_sV::fromImage(image), format);
+}
+
+QByteArray RawRenderTarget_sV::encode(const FloatImage_sV &image, Format format)
+{
+    const int width = image.width();
+    const int height = image.height();
+
+    QByteArray header;
+    int channels;
+    int bytesPerChannel;
+    switch (format) {
+    case Format_PFM:
+        // The sign of the scale indicates the byte order of the floats
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        header = QString("PF\n%1 %2\n-1.0\n").arg(width).arg(height).toAscii();
+#else
+        header = QString("PF\n%1 %2\n1.0\n").arg(width).arg(height).toAscii();
+#endif
+        channels = 3;
+        bytesPerChannel = sizeof(float);
+        break;
+    case Format_PPM16:
+        header = QString("P6\n%1 %2\n65535\n").arg(width).arg(height).toAscii();
+        channels = 3;
+        bytesPerChannel = 2;
+        break;
+    case Format_PAM16:
+    default:
+        header = QString("P7\nWIDTH %1\nHEIGHT %2\nDEPTH 4\nMAXVAL 65535\nTUPLTYPE RGB_ALPHA\nENDHDR\n")
+                .arg(width).arg(height).toAscii();
+        channels = 4;
+        bytesPerChannel = 2;
+        break;
+    }
+
+    QByteArray data;
+    data.resize(header.size() + width*height*channels*bytesPerChannel);
+    memcpy(data.data(), header.constData(), header.size());
+    uchar *out = (uchar*) data.data() + header.size();
+
+    if (format == Format_PFM) {
+        float rgb[3];
+        for (int y = 0; y < height; y++) {
+            // PFM rows are stored from bottom to top
+            const float *r = image.scanLine(FloatImage_sV::Channel_Red, height-1-y);
+            const float *g = image.scanLine(FloatImage_sV::Channel_Green, height-1-y);
+            const float *b = image.scanLine(FloatImage_sV::Channel_Blue, height-1-y);
+            for (int x = 0; x < width; x++) {
+                rgb[0] = clamp01(r[x]);
+                rgb[1] = clamp01(g[x]);
+                rgb[2] = clamp01(b[x]);
+                // The data is not aligned after the text header
+                memcpy(out, rgb, sizeof(rgb));
+                out += sizeof(rgb);
+            }
+        }
+    } else {
+        // 16-bit Netpbm samples are big endian
+        for (int y = 0; y < height; y++) {
+            const float *line[FloatImage_sV::CHANNELS];
+            for (int c = 0; c < channels; c++) {
+                line[c] = image.scanLine(FloatImage_sV::Channel(c), y);
+            }
+            for (int x = 0; x < width; x++) {
+                for (int c = 0; c < channels; c++) {
+                    qToBigEndian<quint16>(quint16(clamp01(line[c][x])*65535 + .5f), out);
+                    out += 2;
+                }
+            }
+        }
+    }
+    return data;
+}
+
+void RawRenderTarget_sV::slotConsumeFrame(const FloatImage_sV &image, const int frameNumber)
+{
+    queueFrame(image, frameNumber);
+}
+
+void RawRenderTarget_sV::consumeQueuedFrame(const QImage &image, int frameNumber) throw(Error_sV)
+{
+    save(encode(image, m_format), frameNumber);
+}
+
+void RawRenderTarget_sV::consumeQueuedFrame(const FloatImage_sV &image, int frameNumber) throw(Error_sV)
+{
+    save(encode(image, m_format), frameNumber);
+}
+
+void RawRenderTarget_sV::save(const QByteArray &data, int frameNumber) throw(Error_sV)
+{
+    QString path = framePath(frameNumber);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+            || file.write(data) != data.size()) {
+        throw Error_sV(QObject::tr("Writing frame %1 to %2 failed: %3").arg(frameNumber).arg(path).arg(file.errorString()));
+    }
+    qDebug() << "  Saved frame number " << frameNumber << " to " << path;
+}
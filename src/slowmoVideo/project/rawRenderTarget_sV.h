@@ -0,0 +1,64 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef RAWRENDERTARGET_SV_H
+#define RAWRENDERTARGET_SV_H
+
+#include "imagesRenderTarget_sV.h"
+
+#include <QtCore/QByteArray>
+
+/**
+  \brief Saves frames as uncompressed high bit depth image sequence.
+
+  For compositing tools which expect more than 8 bits per channel, and to avoid the
+  compression cost when the frames are read by another local tool anyway.
+  Supported are the simple Netpbm-like formats:
+  \li \c PFM: 32-bit float RGB, values on [0,1]
+  \li \c PPM16: 16-bit RGB
+  \li \c PAM16: 16-bit RGBA
+
+  Frames are written by the writer threads of ImagesRenderTarget_sV. The render task passes them
+  in the float format of the render core, so the additional bits are not lost by rounding to 8 bits first.
+  */
+class RawRenderTarget_sV : public ImagesRenderTarget_sV
+{
+public:
+    enum Format { Format_PFM, Format_PPM16, Format_PAM16 };
+
+    RawRenderTarget_sV(RenderTask_sV *parentRenderTask);
+
+    void setFormat(Format format);
+    Format format() const { return m_format; }
+
+    /// Saves a frame; called on one of the writer threads.
+    void consumeQueuedFrame(const QImage &image, int frameNumber) throw(Error_sV);
+    void consumeQueuedFrame(const FloatImage_sV &image, int frameNumber) throw(Error_sV);
+
+    /// \return The image in the given format, including the header. Values are clamped to [0,1].
+    static QByteArray encode(const FloatImage_sV &image, Format format);
+    static QByteArray encode(const QImage &image, Format format);
+
+    /// \return The format for a name like \c pfm or \c ppm16, \c ok is set to \c false if it is unknown
+    static Format fromString(const QString &format, bool *ok = NULL);
+
+    using ImagesRenderTarget_sV::slotConsumeFrame;
+
+public slots:
+    /// Queues the float frame for writing, without converting it to 8 bits.
+    void slotConsumeFrame(const FloatImage_sV &image, const int frameNumber);
+
+private:
+    Format m_format;
+
+    void save(const QByteArray &data, int frameNumber) throw(Error_sV);
+};
+
+#endif // RAWRENDERTARGET_SV_H
@@ -0,0 +1,183 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "renderPlan_sV.h"
+#include "project_sV.h"
+#include "nodeList_sV.h"
+#include "abstractFrameSource_sV.h"
+#include "shutterFunction_sV.h"
+#include "shutterFunctionList_sV.h"
+
+#include <cmath>
+
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+#include <QDebug>
+
+RenderPlan_sV::RenderPlan_sV(Project_sV *project, qreal startTime, qreal endTime, const Fps_sV &fps) :
+    m_fps(fps),
+    m_firstFrame(0)
+{
+    const NodeList_sV *nodes = project->nodes();
+    if (nodes->size() < 2) {
+        return;
+    }
+
+    const qreal curveStart = nodes->startTime();
+    const qreal curveEnd = nodes->endTime();
+    const double frameLength = 1/fps.fps();
+
+    startTime = qMax(startTime, curveStart);
+    endTime = qMin(endTime, curveEnd);
+
+    m_firstFrame = fps.toFrame(startTime - curveStart, false);
+    int n = fps.toFrame(endTime - curveStart, false) - m_firstFrame + 1;
+    if (n <= 0) {
+        return;
+    }
+
+    // Source times for all frames and for the frame after the last one (needed for dy).
+    QVector<qreal> outTimes(n+1);
+    QVector<qreal> sourceTimes(n+1);
+    int hint = 0;
+    for (int i = 0; i <= n; i++) {
+        outTimes[i] = qMin(curveStart + fps.toTime(m_firstFrame+i), curveEnd);
+        sourceTimes[i] = nodes->sourceTime(outTimes[i], &hint);
+    }
+
+    m_frames.resize(n);
+    int leftNode = nodes->find(outTimes[0]);
+    for (int i = 0; i < n; i++) {
+        // Output times are increasing, so the left node only moves to the right.
+        while (leftNode+1 < nodes->size() && nodes->at(leftNode+1).x() <= outTimes[i]) {
+            leftNode++;
+        }
+
+        Frame &frame = m_frames[i];
+        frame.frameNumber = m_firstFrame + i;
+        frame.outTime = outTimes[i];
+        if (outTimes[i] + frameLength <= curveEnd) {
+            complete(project, frame, sourceTimes[i], sourceTimes[i+1], false, leftNode, fps);
+        } else {
+            qreal previous = (i > 0) ? sourceTimes[i-1] : nodes->sourceTime(outTimes[i] - frameLength);
+            complete(project, frame, sourceTimes[i], previous, true, leftNode, fps);
+        }
+    }
+}
+
+RenderPlan_sV::Frame RenderPlan_sV::planFrame(Project_sV *project, qreal outTime, const Fps_sV &fps)
+{
+    const NodeList_sV *nodes = project->nodes();
+    const double frameLength = 1/fps.fps();
+
+    Frame frame;
+    frame.frameNumber = fps.nearestFrame(outTime - nodes->startTime());
+    frame.outTime = outTime;
+
+    qreal sourceTime = nodes->sourceTime(outTime);
+    if (outTime + frameLength <= nodes->endTime()) {
+        complete(project, frame, sourceTime, nodes->sourceTime(outTime + frameLength), false, nodes->find(outTime), fps);
+    } else {
+        complete(project, frame, sourceTime, nodes->sourceTime(outTime - frameLength), true, nodes->find(outTime), fps);
+    }
+    return frame;
+}
+
+void RenderPlan_sV::complete(Project_sV *project, Frame &frame, qreal rawSourceTime, qreal otherSourceTime,
+                             bool backwards, int leftNode, const Fps_sV &fps)
+{
+    const NodeList_sV *nodes = project->nodes();
+
+    float sourceTime = rawSourceTime;
+    if (sourceTime < 0) {
+        sourceTime = 0;
+    }
+    if (sourceTime > project->frameSource()->maxTime()) {
+        sourceTime = project->frameSource()->maxTime();
+    }
+    frame.sourceTime = sourceTime;
+    frame.sourceFrame = sourceTime * project->frameSource()->fps()->fps();
+
+    if (backwards) {
+        frame.dy = sourceTime - otherSourceTime;
+    } else {
+        frame.dy = otherSourceTime - sourceTime;
+    }
+    frame.replaySpeed = fabs(frame.dy) * fps.fps();
+
+    if (leftNode == nodes->size()-1) {
+        // The frame is at the very end of the curve.
+        // Take the next to last node to still have a right node.
+        leftNode--;
+    }
+    frame.leftNode = leftNode;
+    frame.hasShutter = false;
+    frame.shutter = 0;
+
+    if (leftNode < 0) {
+        qDebug() << "No left node for output time " << frame.outTime;
+        Q_ASSERT(false);
+        return;
+    }
+
+    const Node_sV &left = nodes->at(leftNode);
+    const Node_sV &right = nodes->at(leftNode+1);
+    ShutterFunction_sV *shutterFunction = project->shutterFunctions()->function(left.shutterFunctionID());
+    if (shutterFunction != NULL) {
+        frame.hasShutter = true;
+        frame.shutter = shutterFunction->evaluate(
+                    (frame.outTime-left.x())/(right.x()-left.x()), // x on [0,1]
+                    frame.outTime, // t
+                    fps.fps(), // FPS
+                    frame.sourceFrame, // y
+                    frame.dy // dy to next frame
+                    );
+    }
+}
+
+const RenderPlan_sV::Frame* RenderPlan_sV::frameAt(int frameNumber) const
+{
+    int index = frameNumber - m_firstFrame;
+    if (index < 0 || index >= m_frames.size()) {
+        return NULL;
+    }
+    return &m_frames.at(index);
+}
+
+QString RenderPlan_sV::toCsv() const
+{
+    QString csv;
+    QTextStream out(&csv);
+    out.setRealNumberPrecision(8);
+    out << "frame,outTime,sourceTime,sourceFrame,dy,replaySpeed,shutter,leftNode\n";
+    for (int i = 0; i < m_frames.size(); i++) {
+        const Frame &f = m_frames.at(i);
+        out << f.frameNumber << "," << f.outTime << "," << f.sourceTime << "," << f.sourceFrame << ","
+            << f.dy << "," << f.replaySpeed << ",";
+        if (f.hasShutter) {
+            out << f.shutter;
+        }
+        out << "," << f.leftNode << "\n";
+    }
+    out.flush();
+    return csv;
+}
+
+bool RenderPlan_sV::exportCsv(const QString &filename) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qDebug() << "Cannot write render plan to " << filename;
+        return false;
+    }
+    QTextStream out(&file);
+    out << toCsv();
+    return true;
+}
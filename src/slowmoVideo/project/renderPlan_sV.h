@@ -0,0 +1,88 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef RENDERPLAN_SV_H
+#define RENDERPLAN_SV_H
+
+#include "../lib/defs_sV.hpp"
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+class Project_sV;
+
+/**
+  \brief Precomputed source positions and shutter lengths for a range of output frames.
+
+  Rendering a frame requires the source time at the frame and at the next frame (for the replay speed),
+  and the shutter function's value. The plan calculates these values for all frames of a rendering
+  range in a single pass, such that RenderTask_sV only needs to look them up.
+
+  Frames are numbered like in RenderTask_sV, starting with 0 at the first node.
+  */
+class RenderPlan_sV
+{
+public:
+    /// Everything that is needed to render an output frame except for the images
+    struct Frame {
+        int frameNumber;
+        qreal outTime;
+        float sourceTime;
+        float sourceFrame;
+        /// Source time delta to the next output frame
+        float dy;
+        /// Replay speed relative to the input; 1 is normal speed
+        float replaySpeed;
+        /// Shutter length in seconds, 0 if no shutter function is used
+        float shutter;
+        /// \c true if the segment has a shutter function
+        bool hasShutter;
+        /// Index of the node left of this frame
+        int leftNode;
+    };
+
+    /**
+      Builds the plan for all output frames between \c startTime and \c endTime.
+      */
+    RenderPlan_sV(Project_sV *project, qreal startTime, qreal endTime, const Fps_sV &fps);
+
+    /**
+      Calculates a single frame without building a whole plan.
+      */
+    static Frame planFrame(Project_sV *project, qreal outTime, const Fps_sV &fps);
+
+    /** \return The frame with the given number, or \c NULL if it is not part of this plan */
+    const Frame* frameAt(int frameNumber) const;
+
+    int firstFrame() const { return m_firstFrame; }
+    int lastFrame() const { return m_firstFrame + m_frames.size() - 1; }
+    int size() const { return m_frames.size(); }
+    const Fps_sV& fps() const { return m_fps; }
+
+    /** \return The plan as CSV table with one frame per line, for debugging */
+    QString toCsv() const;
+    /** Saves the CSV table to \c filename. \return \c false if the file could not be written */
+    bool exportCsv(const QString &filename) const;
+
+private:
+    Fps_sV m_fps;
+    int m_firstFrame;
+    QVector<Frame> m_frames;
+
+    /**
+      Fills the remaining fields of \c frame.
+      \param otherSourceTime Source time at the next output frame, or at the previous
+             output frame if \c backwards is set (at the end of the curve)
+      */
+    static void complete(Project_sV *project, Frame &frame, qreal rawSourceTime, qreal otherSourceTime,
+                         bool backwards, int leftNode, const Fps_sV &fps);
+};
+
+#endif // RENDERPLAN_SV_H
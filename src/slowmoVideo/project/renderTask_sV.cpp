@@ -11,16 +11,25 @@ the Free Software Foundation, either version 3 of the License, or
 #include "renderTask_sV.h"
 #include "abstractRenderTarget_sV.h"
 #include "emptyFrameSource_sV.h"
+#include "cacheManager_sV.h"
+#include "renderPlan_sV.h"
 
 #include <QImage>
 #include <QMetaObject>
 #include "project_sV.h"
 #include "nodeList_sV.h"
 #include "../lib/defs_sV.hpp"
+#include "../lib/bufferPool_sV.h"
+#include "../lib/floatImage_sV.h"
+#include "../lib/profiler_sV.h"
+
+/// Number of rendered frames after which the cache quota is checked
+#define CACHE_CHECK_INTERVAL 100
 
 RenderTask_sV::RenderTask_sV(Project_sV *project) :
     m_project(project),
     m_renderTarget(NULL),
+    m_plan(NULL),
     m_renderTimeElapsed(0),
     m_initialized(false),
     m_stopRendering(false),
@@ -36,6 +45,7 @@ RenderTask_sV::RenderTask_sV(Project_sV *project) :
 RenderTask_sV::~RenderTask_sV()
 {
     if (m_renderTarget != NULL) { delete m_renderTarget; }
+    delete m_plan;
 }
 
 void RenderTask_sV::setRenderTarget(AbstractRenderTarget_sV *renderTarget)
@@ -76,6 +86,26 @@ void RenderTask_sV::setQtConnectionType(Qt::ConnectionType type)
     m_connectionType = type;
 }
 
+void RenderTask_sV::updatePlan()
+{
+    delete m_plan;
+    m_plan = new RenderPlan_sV(m_project, m_timeStart, m_timeEnd, m_prefs.fps());
+    qDebug() << "Render plan for frames " << m_plan->firstFrame() << " to " << m_plan->lastFrame();
+}
+
+bool RenderTask_sV::closeRenderTarget()
+{
+    // Continuing afterwards opens the target again.
+    m_initialized = false;
+    try {
+        m_renderTarget->closeRenderTarget();
+    } catch (Error_sV &err) {
+        emit signalRenderingAborted(tr("Rendering aborted.") + " " + err.message());
+        return false;
+    }
+    return true;
+}
+
 void RenderTask_sV::slotStopRendering()
 {
     m_stopRendering = true;
@@ -91,7 +121,7 @@ void RenderTask_sV::slotContinueRendering()
         qDebug() << "Frame snapping in from " << m_nextFrameTime << " to " << snapped;
         m_nextFrameTime = snapped;
 
-        Q_ASSERT(int((m_nextFrameTime - m_project->nodes()->startTime()) * m_prefs.fps().fps() + .5) == framesBefore);
+        Q_ASSERT(m_prefs.fps().nearestFrame(m_nextFrameTime - m_project->nodes()->startTime()) == framesBefore);
     }
     if (!m_initialized) {
         try {
@@ -103,6 +133,8 @@ void RenderTask_sV::slotContinueRendering()
             return;
         }
     }
+    updatePlan();
+    BufferPool_sV::instance()->resetCounters();
     qDebug() << "Continuing rendering at " << m_nextFrameTime;
 
     m_stopwatch.start();
@@ -126,45 +158,75 @@ void RenderTask_sV::slotRenderFrom(qreal time)
         emit signalRenderingAborted(tr("Empty frame source, cannot be rendered."));
     }
 
-    int outputFrame = (time - m_project->nodes()->startTime()) * m_prefs.fps().fps() + .5;
+    int outputFrame = m_prefs.fps().nearestFrame(time - m_project->nodes()->startTime());
     if (!m_stopRendering) {
 
         if (time > m_timeEnd) {
             m_stopRendering = true;
-            m_renderTarget->closeRenderTarget();
+            bool closed = closeRenderTarget();
+            m_project->cacheManager()->enforceQuota();
             m_renderTimeElapsed += m_stopwatch.elapsed();
-            emit signalRenderingFinished(QTime().addMSecs(m_renderTimeElapsed).toString("hh:mm:ss"));
+            if (closed) {
+                emit signalRenderingFinished(QTime().addMSecs(m_renderTimeElapsed).toString("hh:mm:ss"));
+            }
             qDebug() << "Rendering stopped after " << QTime().addMSecs(m_renderTimeElapsed).toString("hh:mm:ss");
+            qDebug() << BufferPool_sV::instance()->summary();
+            BufferPool_sV::instance()->clear();
 
         } else {
-            qreal srcTime = m_project->nodes()->sourceTime(time);
+            const RenderPlan_sV::Frame *planned = (m_plan != NULL) ? m_plan->frameAt(outputFrame) : NULL;
+            qreal srcTime = (planned != NULL) ? planned->sourceTime : m_project->nodes()->sourceTime(time);
 
             qDebug() << "Rendering frame number " << outputFrame << " @" << time << " from source time " << srcTime;
             emit signalItemDesc(tr("Rendering frame %1 @ %2 s  from input position: %3 s (frame %4)")
                                 .arg(outputFrame).arg(time).arg(srcTime).arg(srcTime*m_project->frameSource()->fps()->fps()));
             try {
-                QImage rendered = m_project->render(time, m_prefs);
-
-                m_renderTarget->slotConsumeFrame(rendered, outputFrame);
-                m_nextFrameTime = time + 1/m_prefs.fps().fps();
+                Profiler_sV::Timer frameTimer(Profiler_sV::Stage_Frame);
+                // Passed as float, so targets with more than 8 bits per channel get the full precision.
+                FloatImage_sV rendered = m_project->renderFloat(
+                            (planned != NULL) ? *planned : RenderPlan_sV::planFrame(m_project, time, m_prefs.fps()), m_prefs);
+
+                {
+                    Profiler_sV::Timer encodeTimer(Profiler_sV::Stage_Encode);
+                    m_renderTarget->slotConsumeFrame(rendered, outputFrame);
+                }
+                // Calculated from the frame number and not by adding the frame length,
+                // which would accumulate rounding errors over long renderings.
+                m_nextFrameTime = m_project->nodes()->startTime() + m_prefs.fps().toTime(outputFrame+1);
+
+                if (outputFrame % CACHE_CHECK_INTERVAL == CACHE_CHECK_INTERVAL-1) {
+                    m_project->cacheManager()->enforceQuota();
+                }
 
                 emit signalTaskProgress( (time-m_timeStart) * m_prefs.fps().fps() );
                 emit signalFrameRendered(time, outputFrame);
             } catch (FlowBuildingError &err) {
                 m_stopRendering = true;
                 emit signalRenderingAborted(err.message());
+                closeRenderTarget();
             } catch (InterpolationError &err) {
                 emit signalItemDesc(err.message());
+            } catch (Error_sV &err) {
+                // The render target failed, e.g. the encoder. Closing it finishes what has been written so far.
+                m_stopRendering = true;
+                emit signalRenderingAborted(err.message());
+                closeRenderTarget();
             }
 
             m_prevTime = srcTime;
+            // Temporaries of this frame have been released; free those which were not reused.
+            BufferPool_sV::instance()->endFrame();
+            Profiler_sV::instance()->endFrame();
         }
 
     } else {
-        m_renderTarget->closeRenderTarget();
+        closeRenderTarget();
+        m_project->cacheManager()->enforceQuota();
         m_renderTimeElapsed += m_stopwatch.elapsed();
         emit signalRenderingStopped(QTime().addMSecs(m_renderTimeElapsed).toString("hh:mm:ss"));
         qDebug() << "Rendering stopped after " << QTime().addMSecs(m_renderTimeElapsed).toString("hh:mm:ss");
+        qDebug() << BufferPool_sV::instance()->summary();
+        BufferPool_sV::instance()->clear();
     }
     if (!m_stopRendering) {
         QMetaObject::invokeMethod(this, "slotRenderFrom", m_connectionType, Q_ARG(qreal, m_nextFrameTime));
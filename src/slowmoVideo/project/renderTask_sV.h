@@ -18,6 +18,7 @@ the Free Software Foundation, either version 3 of the License, or
 
 class Project_sV;
 class AbstractRenderTarget_sV;
+class RenderPlan_sV;
 
 /**
   \brief Renders a project when started.
@@ -67,6 +68,14 @@ public:
 
     RenderPreferences_sV& renderPreferences() { return m_prefs; }
 
+    /**
+      Calculates source times and shutter lengths for all frames in the time range.
+      Called automatically when rendering is continued.
+      */
+    void updatePlan();
+    /// \return The current render plan, or \c NULL if updatePlan() has not been called yet
+    const RenderPlan_sV* renderPlan() const { return m_plan; }
+
 
 public slots:
     void slotContinueRendering();
@@ -89,6 +98,7 @@ private:
     RenderPreferences_sV m_prefs; ///< \todo Set preferences
 
     AbstractRenderTarget_sV *m_renderTarget;
+    RenderPlan_sV *m_plan;
 
     qreal m_timeStart;
     qreal m_timeEnd;
@@ -104,6 +114,10 @@ private:
 
     Qt::ConnectionType m_connectionType;
 
+    /// Closes the render target, it is opened again when rendering continues.
+    /// Emits signalRenderingAborted() and returns \c false on errors.
+    bool closeRenderTarget();
+
 private slots:
     void slotRenderFrom(qreal time);
 
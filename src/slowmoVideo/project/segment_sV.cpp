@@ -36,6 +36,18 @@ bool Segment_sV::operator <(const Segment_sV& other) const
     return m_leftNodeIndex < other.m_leftNodeIndex;
 }
 
+const BezierTools_sV::Polynomial& Segment_sV::bezier() const
+{
+    return m_bezier;
+}
+
+void Segment_sV::setBezier(QPointF p0, QPointF p1, QPointF p2, QPointF p3)
+{
+    if (!m_bezier.matches(p0, p1, p2, p3)) {
+        m_bezier = BezierTools_sV::Polynomial(p0, p1, p2, p3);
+    }
+}
+
 QString toString(const Segment_sV &segment)
 {
     return QString("Left node: %1; selected: %2").arg(segment.leftNodeIndex()).arg(segment.selected());
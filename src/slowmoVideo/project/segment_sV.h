@@ -14,6 +14,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include <QtCore/QString>
 
 #include "canvasObject_sV.h"
+#include "../lib/bezierTools_sV.h"
 
 /**
   \brief Dummy object for a segment between two nodes
@@ -31,9 +32,20 @@ public:
 
     bool operator <(const Segment_sV &other) const;
 
+    /**
+      \brief Polynomial of the bézier curve on this segment.
+
+      It is set by NodeList_sV whenever the nodes or handles change, so reading it
+      does not modify the segment and is safe while another thread reads it as well.
+      */
+    const BezierTools_sV::Polynomial& bezier() const;
+    /// Calculates the polynomial for the given control points.
+    void setBezier(QPointF p0, QPointF p1, QPointF p2, QPointF p3);
+
 private:
     int m_leftNodeIndex;
     bool m_selected;
+    BezierTools_sV::Polynomial m_bezier;
 };
 
 QString toString(const Segment_sV& segment);
@@ -0,0 +1,903 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "shutterExpression_sV.h"
+
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+
+/// Maximum number of variables (including the 5 parameters) a native shutter function may use
+#define MAX_VARIABLES 64
+
+namespace ShutterExpression {
+
+static const double notANumber = std::numeric_limits<double>::quiet_NaN();
+static const double infinity = std::numeric_limits<double>::infinity();
+
+inline bool truthy(double d) { return d != 0 && d == d; }
+
+
+/// Node of an expression tree
+class Expression {
+public:
+    virtual ~Expression() {}
+    virtual double eval(double *vars) const = 0;
+    /// \return \c true if the expression may evaluate to a boolean (instead of a number) in ECMAScript
+    virtual bool boolean(const std::vector<bool> &booleanVars) const { (void)booleanVars; return false; }
+};
+
+class Constant : public Expression {
+public:
+    Constant(double value, bool isBoolean = false) : m_value(value), m_boolean(isBoolean) {}
+    double eval(double *) const { return m_value; }
+    bool boolean(const std::vector<bool> &) const { return m_boolean; }
+private:
+    double m_value;
+    bool m_boolean;
+};
+
+class Variable : public Expression {
+public:
+    Variable(int slot) : m_slot(slot) {}
+    double eval(double *vars) const { return vars[m_slot]; }
+    bool boolean(const std::vector<bool> &booleanVars) const { return booleanVars[m_slot]; }
+private:
+    int m_slot;
+};
+
+class Assignment : public Expression {
+public:
+    Assignment(int slot, char op, Expression *value) : m_slot(slot), m_op(op), m_value(value) {}
+    ~Assignment() { delete m_value; }
+    double eval(double *vars) const {
+        double v = m_value->eval(vars);
+        switch (m_op) {
+        case '+': v = vars[m_slot] + v; break;
+        case '-': v = vars[m_slot] - v; break;
+        case '*': v = vars[m_slot] * v; break;
+        case '/': v = vars[m_slot] / v; break;
+        }
+        vars[m_slot] = v;
+        return v;
+    }
+    bool boolean(const std::vector<bool> &booleanVars) const {
+        return m_op == '=' && m_value->boolean(booleanVars);
+    }
+private:
+    int m_slot;
+    char m_op;
+    Expression *m_value;
+};
+
+class Unary : public Expression {
+public:
+    Unary(char op, Expression *a) : m_op(op), m_a(a) {}
+    ~Unary() { delete m_a; }
+    double eval(double *vars) const {
+        double a = m_a->eval(vars);
+        switch (m_op) {
+        case '-': return -a;
+        case '!': return truthy(a) ? 0 : 1;
+        default:  return a;
+        }
+    }
+    bool boolean(const std::vector<bool> &) const { return m_op == '!'; }
+private:
+    char m_op;
+    Expression *m_a;
+};
+
+enum BinaryOp { Add, Sub, Mul, Div, Mod, Less, LessEq, Greater, GreaterEq, Equal, NotEqual };
+
+class Binary : public Expression {
+public:
+    Binary(BinaryOp op, Expression *a, Expression *b) : m_op(op), m_a(a), m_b(b) {}
+    ~Binary() { delete m_a; delete m_b; }
+    double eval(double *vars) const {
+        double a = m_a->eval(vars);
+        double b = m_b->eval(vars);
+        switch (m_op) {
+        case Add:       return a + b;
+        case Sub:       return a - b;
+        case Mul:       return a * b;
+        case Div:       return a / b;
+        case Mod:       return fmod(a, b);
+        case Less:      return a < b;
+        case LessEq:    return a <= b;
+        case Greater:   return a > b;
+        case GreaterEq: return a >= b;
+        case Equal:     return a == b;
+        case NotEqual:  return a != b;
+        }
+        return notANumber;
+    }
+    bool boolean(const std::vector<bool> &) const { return m_op >= Less; }
+private:
+    BinaryOp m_op;
+    Expression *m_a;
+    Expression *m_b;
+};
+
+/// && and || return one of their operands, like in ECMAScript
+class Logical : public Expression {
+public:
+    Logical(bool isAnd, Expression *a, Expression *b) : m_and(isAnd), m_a(a), m_b(b) {}
+    ~Logical() { delete m_a; delete m_b; }
+    double eval(double *vars) const {
+        double a = m_a->eval(vars);
+        if (truthy(a) == m_and) {
+            return m_b->eval(vars);
+        }
+        return a;
+    }
+    bool boolean(const std::vector<bool> &booleanVars) const {
+        return m_a->boolean(booleanVars) || m_b->boolean(booleanVars);
+    }
+private:
+    bool m_and;
+    Expression *m_a;
+    Expression *m_b;
+};
+
+class Conditional : public Expression {
+public:
+    Conditional(Expression *cond, Expression *a, Expression *b) : m_cond(cond), m_a(a), m_b(b) {}
+    ~Conditional() { delete m_cond; delete m_a; delete m_b; }
+    double eval(double *vars) const {
+        return truthy(m_cond->eval(vars)) ? m_a->eval(vars) : m_b->eval(vars);
+    }
+    bool boolean(const std::vector<bool> &booleanVars) const {
+        return m_a->boolean(booleanVars) || m_b->boolean(booleanVars);
+    }
+private:
+    Expression *m_cond;
+    Expression *m_a;
+    Expression *m_b;
+};
+
+typedef double (*Function1)(double);
+typedef double (*Function2)(double, double);
+
+double jsRound(double d) { return floor(d + .5); }
+double jsAbs(double d) { return fabs(d); }
+double jsPow(double a, double b) { return pow(a, b); }
+double jsAtan2(double a, double b) { return atan2(a, b); }
+double jsSin(double d) { return sin(d); }
+double jsCos(double d) { return cos(d); }
+double jsTan(double d) { return tan(d); }
+double jsAsin(double d) { return asin(d); }
+double jsAcos(double d) { return acos(d); }
+double jsAtan(double d) { return atan(d); }
+double jsExp(double d) { return exp(d); }
+double jsLog(double d) { return log(d); }
+double jsSqrt(double d) { return sqrt(d); }
+double jsFloor(double d) { return floor(d); }
+double jsCeil(double d) { return ceil(d); }
+
+class Call1 : public Expression {
+public:
+    Call1(Function1 f, Expression *a) : m_f(f), m_a(a) {}
+    ~Call1() { delete m_a; }
+    double eval(double *vars) const { return m_f(m_a->eval(vars)); }
+private:
+    Function1 m_f;
+    Expression *m_a;
+};
+
+class Call2 : public Expression {
+public:
+    Call2(Function2 f, Expression *a, Expression *b) : m_f(f), m_a(a), m_b(b) {}
+    ~Call2() { delete m_a; delete m_b; }
+    double eval(double *vars) const { return m_f(m_a->eval(vars), m_b->eval(vars)); }
+private:
+    Function2 m_f;
+    Expression *m_a;
+    Expression *m_b;
+};
+
+/// Math.min and Math.max, which accept any number of arguments and propagate NaN
+class MinMax : public Expression {
+public:
+    MinMax(bool isMax, const std::vector<Expression*> &args) : m_max(isMax), m_args(args) {}
+    ~MinMax() {
+        for (size_t i = 0; i < m_args.size(); i++) { delete m_args[i]; }
+    }
+    double eval(double *vars) const {
+        double result = m_max ? -infinity : infinity;
+        for (size_t i = 0; i < m_args.size(); i++) {
+            double v = m_args[i]->eval(vars);
+            if (v != v) {
+                return notANumber;
+            }
+            if (m_max ? v > result : v < result) {
+                result = v;
+            }
+        }
+        return result;
+    }
+private:
+    bool m_max;
+    std::vector<Expression*> m_args;
+};
+
+
+/// Node of the statement tree
+class Statement {
+public:
+    virtual ~Statement() {}
+    /// \return \c true if a \c return statement has been executed
+    virtual bool exec(double *vars, double &result) const = 0;
+};
+
+class ExpressionStatement : public Statement {
+public:
+    ExpressionStatement(Expression *expr) : m_expr(expr) {}
+    ~ExpressionStatement() { delete m_expr; }
+    bool exec(double *vars, double &) const { m_expr->eval(vars); return false; }
+private:
+    Expression *m_expr;
+};
+
+class Return : public Statement {
+public:
+    /// \param expr \c NULL for returning \c undefined
+    Return(Expression *expr) : m_expr(expr) {}
+    ~Return() { delete m_expr; }
+    bool exec(double *vars, double &result) const {
+        result = (m_expr == NULL) ? 0 : m_expr->eval(vars);
+        return true;
+    }
+    const Expression* expression() const { return m_expr; }
+private:
+    Expression *m_expr;
+};
+
+class If : public Statement {
+public:
+    If(Expression *cond, Statement *a, Statement *b) : m_cond(cond), m_a(a), m_b(b) {}
+    ~If() { delete m_cond; delete m_a; delete m_b; }
+    bool exec(double *vars, double &result) const {
+        if (truthy(m_cond->eval(vars))) {
+            return m_a->exec(vars, result);
+        } else if (m_b != NULL) {
+            return m_b->exec(vars, result);
+        }
+        return false;
+    }
+private:
+    Expression *m_cond;
+    Statement *m_a;
+    Statement *m_b;
+};
+
+class Block : public Statement {
+public:
+    ~Block() {
+        for (size_t i = 0; i < m_statements.size(); i++) { delete m_statements[i]; }
+    }
+    void add(Statement *s) { m_statements.push_back(s); }
+    bool exec(double *vars, double &result) const {
+        for (size_t i = 0; i < m_statements.size(); i++) {
+            if (m_statements[i]->exec(vars, result)) {
+                return true;
+            }
+        }
+        return false;
+    }
+private:
+    std::vector<Statement*> m_statements;
+};
+
+
+struct Token {
+    enum Type { Number, Identifier, Punctuator, End };
+    Type type;
+    std::string text;
+    double number;
+    /// A line break precedes this token (relevant for <code>return</code>)
+    bool newlineBefore;
+};
+
+/// Recursive descent parser creating the expression tree
+class Parser {
+public:
+    Parser(const std::string &code) :
+        m_code(code), m_pos(0)
+    {
+        const char *params[] = { "x", "t", "fps", "y", "dy" };
+        for (int i = 0; i < 5; i++) {
+            m_slots[params[i]] = i;
+            m_declared.push_back(true);
+            m_booleanVars.push_back(false);
+        }
+        tokenize();
+    }
+    ~Parser() {}
+
+    Statement* parse(int &nVariables)
+    {
+        Block *body = new Block();
+        try {
+            while (peek().type != Token::End) {
+                body->add(statement());
+            }
+            for (size_t i = 0; i < m_declared.size(); i++) {
+                if (!m_declared[i]) {
+                    throw ShutterExpression_sV::CompileError("Undeclared variable used");
+                }
+            }
+            for (size_t i = 0; i < m_returns.size(); i++) {
+                if (m_returns[i]->expression() != NULL && m_returns[i]->expression()->boolean(m_booleanVars)) {
+                    throw ShutterExpression_sV::CompileError("Boolean return values are not supported");
+                }
+            }
+        } catch (ShutterExpression_sV::CompileError &err) {
+            delete body;
+            throw;
+        }
+        nVariables = m_declared.size();
+        return body;
+    }
+
+private:
+    std::string m_code;
+    size_t m_pos;
+    std::vector<Token> m_tokens;
+    size_t m_next;
+
+    std::map<std::string, int> m_slots;
+    std::vector<bool> m_declared;
+    std::vector<bool> m_booleanVars;
+    std::vector<const Return*> m_returns;
+
+    void fail(const std::string &msg)
+    {
+        throw ShutterExpression_sV::CompileError(msg);
+    }
+
+    void tokenize()
+    {
+        static const char *punctuators[] = {
+            "===", "!==", "==", "!=", "<=", ">=", "&&", "||", "+=", "-=", "*=", "/=",
+            "++", "--", "+", "-", "*", "/", "%", "<", ">", "!", "=", "?", ":", "(", ")", "{", "}", ",", ";", ".",
+            NULL
+        };
+        const size_t n = m_code.size();
+        bool newline = false;
+        while (true) {
+            // Skip white space and comments
+            while (m_pos < n) {
+                char c = m_code[m_pos];
+                if (c == '\n') {
+                    newline = true;
+                    m_pos++;
+                } else if (isspace((unsigned char)c)) {
+                    m_pos++;
+                } else if (m_code.compare(m_pos, 2, "//") == 0) {
+                    while (m_pos < n && m_code[m_pos] != '\n') { m_pos++; }
+                } else if (m_code.compare(m_pos, 2, "/*") == 0) {
+                    size_t end = m_code.find("*/", m_pos+2);
+                    if (end == std::string::npos) { fail("Unterminated comment"); }
+                    if (m_code.find('\n', m_pos) < end) { newline = true; }
+                    m_pos = end+2;
+                } else {
+                    break;
+                }
+            }
+
+            Token token;
+            token.newlineBefore = newline;
+            token.number = 0;
+            newline = false;
+
+            if (m_pos >= n) {
+                token.type = Token::End;
+                m_tokens.push_back(token);
+                break;
+            }
+
+            char c = m_code[m_pos];
+            if (isdigit((unsigned char)c) || (c == '.' && m_pos+1 < n && isdigit((unsigned char)m_code[m_pos+1]))) {
+                if (c == '0' && m_pos+1 < n && (m_code[m_pos+1] == 'x' || m_code[m_pos+1] == 'X')) {
+                    fail("Hexadecimal numbers are not supported");
+                }
+                const char *start = m_code.c_str() + m_pos;
+                char *end;
+                token.type = Token::Number;
+                token.number = strtod(start, &end);
+                m_pos += end - start;
+                if (m_pos < n && (isalnum((unsigned char)m_code[m_pos]) || m_code[m_pos] == '_')) {
+                    fail("Invalid number");
+                }
+            } else if (isalpha((unsigned char)c) || c == '_' || c == '$') {
+                size_t start = m_pos;
+                while (m_pos < n && (isalnum((unsigned char)m_code[m_pos]) || m_code[m_pos] == '_' || m_code[m_pos] == '$')) {
+                    m_pos++;
+                }
+                token.type = Token::Identifier;
+                token.text = m_code.substr(start, m_pos-start);
+            } else {
+                token.type = Token::Punctuator;
+                for (int i = 0; punctuators[i] != NULL; i++) {
+                    size_t len = strlen(punctuators[i]);
+                    if (m_code.compare(m_pos, len, punctuators[i]) == 0) {
+                        token.text = punctuators[i];
+                        break;
+                    }
+                }
+                if (token.text.empty()) {
+                    fail(std::string("Unsupported character: ") + c);
+                }
+                if (token.text == "++" || token.text == "--") {
+                    fail("Increment and decrement operators are not supported");
+                }
+                m_pos += token.text.size();
+            }
+            m_tokens.push_back(token);
+        }
+        m_next = 0;
+    }
+
+    const Token& peek(int ahead = 0) const
+    {
+        size_t i = m_next + ahead;
+        if (i >= m_tokens.size()) { i = m_tokens.size()-1; }
+        return m_tokens[i];
+    }
+    const Token& take()
+    {
+        const Token &t = m_tokens[m_next];
+        if (m_next < m_tokens.size()-1) { m_next++; }
+        return t;
+    }
+    bool isPunctuator(const char *p, int ahead = 0) const
+    {
+        return peek(ahead).type == Token::Punctuator && peek(ahead).text == p;
+    }
+    bool isIdentifier(const char *id) const
+    {
+        return peek().type == Token::Identifier && peek().text == id;
+    }
+    bool accept(const char *p)
+    {
+        if (isPunctuator(p)) {
+            take();
+            return true;
+        }
+        return false;
+    }
+    void expect(const char *p)
+    {
+        if (!accept(p)) {
+            fail(std::string("Expected ") + p);
+        }
+    }
+    /// Automatic semicolon insertion: A semicolon may be omitted before a line break, a } or the end.
+    void endOfStatement()
+    {
+        if (accept(";")) { return; }
+        if (isPunctuator("}") || peek().type == Token::End || peek().newlineBefore) { return; }
+        fail("Expected ;");
+    }
+
+    static bool isReserved(const std::string &name)
+    {
+        static const char *reserved[] = {
+            "var", "if", "else", "return", "true", "false", "Math", "NaN", "Infinity", "undefined",
+            "for", "while", "do", "function", "new", "this", "switch", "case", "break", "continue",
+            "typeof", "delete", "in", "instanceof", "null", "with", "try", "catch", "throw", "void",
+            NULL
+        };
+        for (int i = 0; reserved[i] != NULL; i++) {
+            if (name == reserved[i]) { return true; }
+        }
+        return false;
+    }
+
+    int slot(const std::string &name, bool declare)
+    {
+        if (isReserved(name)) {
+            fail("Unsupported identifier: " + name);
+        }
+        std::map<std::string, int>::const_iterator it = m_slots.find(name);
+        int s;
+        if (it == m_slots.end()) {
+            s = m_declared.size();
+            if (s >= MAX_VARIABLES) {
+                fail("Too many variables");
+            }
+            m_slots[name] = s;
+            m_declared.push_back(false);
+            m_booleanVars.push_back(false);
+        } else {
+            s = it->second;
+        }
+        if (declare) {
+            m_declared[s] = true;
+        }
+        return s;
+    }
+
+    Statement* statement()
+    {
+        if (accept("{")) {
+            Block *block = new Block();
+            try {
+                while (!accept("}")) {
+                    if (peek().type == Token::End) { fail("Expected }"); }
+                    block->add(statement());
+                }
+            } catch (ShutterExpression_sV::CompileError &err) {
+                delete block;
+                throw;
+            }
+            return block;
+        }
+        if (accept(";")) {
+            return new Block();
+        }
+        if (isIdentifier("var")) {
+            take();
+            Block *block = new Block();
+            try {
+                do {
+                    if (peek().type != Token::Identifier) { fail("Expected variable name"); }
+                    int s = slot(take().text, true);
+                    if (accept("=")) {
+                        Expression *value = assignment();
+                        if (value->boolean(m_booleanVars)) { m_booleanVars[s] = true; }
+                        block->add(new ExpressionStatement(new Assignment(s, '=', value)));
+                    }
+                } while (accept(","));
+                endOfStatement();
+            } catch (ShutterExpression_sV::CompileError &err) {
+                delete block;
+                throw;
+            }
+            return block;
+        }
+        if (isIdentifier("if")) {
+            take();
+            expect("(");
+            Expression *cond = expression();
+            Statement *a = NULL;
+            Statement *b = NULL;
+            try {
+                expect(")");
+                a = statement();
+                if (isIdentifier("else")) {
+                    take();
+                    b = statement();
+                }
+            } catch (ShutterExpression_sV::CompileError &err) {
+                delete cond;
+                delete a;
+                throw;
+            }
+            return new If(cond, a, b);
+        }
+        if (isIdentifier("return")) {
+            take();
+            Expression *value = NULL;
+            if (!isPunctuator(";") && !isPunctuator("}") && peek().type != Token::End && !peek().newlineBefore) {
+                value = expression();
+            }
+            Return *ret = new Return(value);
+            try {
+                endOfStatement();
+            } catch (ShutterExpression_sV::CompileError &err) {
+                delete ret;
+                throw;
+            }
+            m_returns.push_back(ret);
+            return ret;
+        }
+        Expression *expr = expression();
+        try {
+            endOfStatement();
+        } catch (ShutterExpression_sV::CompileError &err) {
+            delete expr;
+            throw;
+        }
+        return new ExpressionStatement(expr);
+    }
+
+    Expression* expression()
+    {
+        if (isPunctuator(",", 1)) {
+            fail("The comma operator is not supported");
+        }
+        return assignment();
+    }
+
+    Expression* assignment()
+    {
+        if (peek().type == Token::Identifier && peek(1).type == Token::Punctuator) {
+            const std::string &op = peek(1).text;
+            char c = 0;
+            if (op == "=") { c = '='; }
+            else if (op == "+=") { c = '+'; }
+            else if (op == "-=") { c = '-'; }
+            else if (op == "*=") { c = '*'; }
+            else if (op == "/=") { c = '/'; }
+            if (c != 0) {
+                int s = slot(take().text, false);
+                take();
+                Expression *value = assignment();
+                if (c == '=' && value->boolean(m_booleanVars)) {
+                    m_booleanVars[s] = true;
+                }
+                return new Assignment(s, c, value);
+            }
+        }
+        return conditional();
+    }
+
+    Expression* conditional()
+    {
+        Expression *cond = logicalOr();
+        if (accept("?")) {
+            Expression *a = NULL;
+            try {
+                a = assignment();
+                expect(":");
+            } catch (ShutterExpression_sV::CompileError &err) {
+                delete cond;
+                delete a;
+                throw;
+            }
+            Expression *b = guarded(cond, a, &Parser::assignment);
+            return new Conditional(cond, a, b);
+        }
+        return cond;
+    }
+
+    /// Parses the right-hand side; deletes the already parsed operands if that fails.
+    Expression* guarded(Expression *a, Expression *b, Expression* (Parser::*next)())
+    {
+        try {
+            return (this->*next)();
+        } catch (ShutterExpression_sV::CompileError &err) {
+            delete a;
+            delete b;
+            throw;
+        }
+    }
+
+    Expression* logicalOr()
+    {
+        Expression *a = logicalAnd();
+        while (accept("||")) {
+            a = new Logical(false, a, guarded(a, NULL, &Parser::logicalAnd));
+        }
+        return a;
+    }
+
+    Expression* logicalAnd()
+    {
+        Expression *a = equality();
+        while (accept("&&")) {
+            a = new Logical(true, a, guarded(a, NULL, &Parser::equality));
+        }
+        return a;
+    }
+
+    Expression* equality()
+    {
+        Expression *a = relational();
+        while (true) {
+            BinaryOp op;
+            if (accept("==") || accept("===")) { op = Equal; }
+            else if (accept("!=") || accept("!==")) { op = NotEqual; }
+            else { return a; }
+            a = new Binary(op, a, guarded(a, NULL, &Parser::relational));
+        }
+    }
+
+    Expression* relational()
+    {
+        Expression *a = additive();
+        while (true) {
+            BinaryOp op;
+            if (accept("<")) { op = Less; }
+            else if (accept("<=")) { op = LessEq; }
+            else if (accept(">")) { op = Greater; }
+            else if (accept(">=")) { op = GreaterEq; }
+            else { return a; }
+            a = new Binary(op, a, guarded(a, NULL, &Parser::additive));
+        }
+    }
+
+    Expression* additive()
+    {
+        Expression *a = multiplicative();
+        while (true) {
+            BinaryOp op;
+            if (accept("+")) { op = Add; }
+            else if (accept("-")) { op = Sub; }
+            else { return a; }
+            a = new Binary(op, a, guarded(a, NULL, &Parser::multiplicative));
+        }
+    }
+
+    Expression* multiplicative()
+    {
+        Expression *a = unary();
+        while (true) {
+            BinaryOp op;
+            if (accept("*")) { op = Mul; }
+            else if (accept("/")) { op = Div; }
+            else if (accept("%")) { op = Mod; }
+            else { return a; }
+            a = new Binary(op, a, guarded(a, NULL, &Parser::unary));
+        }
+    }
+
+    Expression* unary()
+    {
+        if (accept("-")) { return new Unary('-', unary()); }
+        if (accept("+")) { return new Unary('+', unary()); }
+        if (accept("!")) { return new Unary('!', unary()); }
+        return primary();
+    }
+
+    Expression* primary()
+    {
+        const Token &token = take();
+        if (token.type == Token::Number) {
+            return new Constant(token.number);
+        }
+        if (token.type == Token::Punctuator && token.text == "(") {
+            Expression *e = expression();
+            try {
+                expect(")");
+            } catch (ShutterExpression_sV::CompileError &err) {
+                delete e;
+                throw;
+            }
+            return e;
+        }
+        if (token.type != Token::Identifier) {
+            fail("Unexpected token: " + token.text);
+        }
+        if (token.text == "true")     { return new Constant(1, true); }
+        if (token.text == "false")    { return new Constant(0, true); }
+        if (token.text == "NaN")      { return new Constant(notANumber); }
+        if (token.text == "Infinity") { return new Constant(infinity); }
+        if (token.text == "Math") {
+            expect(".");
+            if (peek().type != Token::Identifier) { fail("Expected Math member"); }
+            return math(take().text);
+        }
+        if (isReserved(token.text)) {
+            fail("Unsupported keyword: " + token.text);
+        }
+        if (isPunctuator("(") || isPunctuator(".")) {
+            fail("Function calls and objects are not supported");
+        }
+        return new Variable(slot(token.text, false));
+    }
+
+    Expression* math(const std::string &name)
+    {
+        struct Const { const char *name; double value; };
+        static const Const constants[] = {
+            { "PI", M_PI }, { "E", M_E }, { "LN2", M_LN2 }, { "LN10", M_LN10 },
+            { "LOG2E", M_LOG2E }, { "LOG10E", M_LOG10E }, { "SQRT2", M_SQRT2 }, { "SQRT1_2", M_SQRT1_2 },
+            { NULL, 0 }
+        };
+        for (int i = 0; constants[i].name != NULL; i++) {
+            if (name == constants[i].name) {
+                return new Constant(constants[i].value);
+            }
+        }
+
+        std::vector<Expression*> args;
+        expect("(");
+        try {
+            if (!accept(")")) {
+                do {
+                    args.push_back(assignment());
+                } while (accept(","));
+                expect(")");
+            }
+
+            if (name == "min" || name == "max") {
+                return new MinMax(name == "max", args);
+            }
+
+            struct F1 { const char *name; Function1 f; };
+            static const F1 functions1[] = {
+                { "abs", jsAbs }, { "acos", jsAcos }, { "asin", jsAsin }, { "atan", jsAtan },
+                { "ceil", jsCeil }, { "cos", jsCos }, { "exp", jsExp }, { "floor", jsFloor },
+                { "log", jsLog }, { "round", jsRound }, { "sin", jsSin }, { "sqrt", jsSqrt }, { "tan", jsTan },
+                { NULL, NULL }
+            };
+            for (int i = 0; functions1[i].name != NULL; i++) {
+                if (name == functions1[i].name) {
+                    if (args.size() != 1) { fail("Math." + name + " requires 1 argument"); }
+                    return new Call1(functions1[i].f, args[0]);
+                }
+            }
+            if (name == "pow" || name == "atan2") {
+                if (args.size() != 2) { fail("Math." + name + " requires 2 arguments"); }
+                return new Call2(name == "pow" ? jsPow : jsAtan2, args[0], args[1]);
+            }
+            fail("Unsupported function: Math." + name);
+
+        } catch (ShutterExpression_sV::CompileError &err) {
+            for (size_t i = 0; i < args.size(); i++) { delete args[i]; }
+            throw;
+        }
+        return NULL;
+    }
+};
+
+}
+
+using namespace ShutterExpression;
+
+ShutterExpression_sV::ShutterExpression_sV(Statement *body, int nVariables) :
+    m_body(body),
+    m_nVariables(nVariables)
+{
+}
+
+ShutterExpression_sV::~ShutterExpression_sV()
+{
+    delete m_body;
+}
+
+ShutterExpression_sV* ShutterExpression_sV::compile(const std::string &code, std::string *error)
+{
+    try {
+        Parser parser(code);
+        int nVariables;
+        Statement *body = parser.parse(nVariables);
+        return new ShutterExpression_sV(body, nVariables);
+    } catch (CompileError &err) {
+        if (error != NULL) {
+            *error = err.message;
+        }
+        return NULL;
+    }
+}
+
+float ShutterExpression_sV::evaluate(const float x, const float t, const float fps, const float y, const float dy) const
+{
+    double vars[MAX_VARIABLES];
+    vars[0] = x;
+    vars[1] = t;
+    vars[2] = fps;
+    vars[3] = y;
+    vars[4] = dy;
+    for (int i = 5; i < m_nVariables; i++) {
+        vars[i] = notANumber;
+    }
+
+    double result = 0;
+    if (!m_body->exec(vars, result)) {
+        // Returned undefined
+        return 0;
+    }
+    if (result != result) {
+        return result;
+    }
+    // QString::toFloat() fails for values that do not fit into a float, and for "Infinity".
+    if (result > FLT_MAX || result < -FLT_MAX) {
+        return 0;
+    }
+    return result;
+}
@@ -0,0 +1,74 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef SHUTTEREXPRESSION_SV_H
+#define SHUTTEREXPRESSION_SV_H
+
+#include <string>
+#include <vector>
+
+namespace ShutterExpression {
+class Statement;
+}
+
+/**
+  \brief Natively compiled shutter function.
+
+  Evaluating a shutter function with QtScript is expensive compared to the function itself,
+  which usually is a single arithmetic expression. This class compiles the subset of ECMAScript
+  that is used in shutter functions into an expression tree that is evaluated directly.
+
+  Supported are:
+  \li Number literals, \c true, \c false, \c NaN, \c Infinity
+  \li The function parameters \c x, \c t, \c fps, \c y, \c dy and variables declared with \c var
+  \li Arithmetic (<code>+ - * / %</code>), comparisons, <code>! && || ?:</code>
+  \li Assignments (also <code>+= -= *= /=</code>) to declared variables
+  \li \c if / \c else, blocks, \c return
+  \li Math constants and functions like \c Math.PI, \c Math.pow(), \c Math.min()
+  \li Line and block comments
+
+  For everything else (loops, strings, objects, undeclared variables, returning a boolean which
+  QtScript would convert to \c "true") compile() fails, and ShutterFunction_sV falls back to QtScript.
+  */
+class ShutterExpression_sV
+{
+public:
+    /// Thrown by the parser if the code uses unsupported constructs
+    class CompileError {
+    public:
+        CompileError(std::string message) : message(message) {}
+        std::string message;
+    };
+
+    ~ShutterExpression_sV();
+
+    /**
+      Compiles the body of a shutter function (without the surrounding function header).
+      \param error Receives the reason if the code cannot be compiled
+      \return \c NULL if the function uses constructs that are not supported
+      */
+    static ShutterExpression_sV* compile(const std::string &code, std::string *error = NULL);
+
+    /**
+      Evaluates the function. The result corresponds to what ShutterFunction_sV would get from
+      QtScript: If the function does not return a number, 0 is returned.
+      */
+    float evaluate(const float x, const float t, const float fps, const float y, const float dy) const;
+
+private:
+    ShutterExpression_sV(ShutterExpression::Statement *body, int nVariables);
+    ShutterExpression_sV(const ShutterExpression_sV &other);
+    void operator =(const ShutterExpression_sV &other);
+
+    ShutterExpression::Statement *m_body;
+    int m_nVariables;
+};
+
+#endif // SHUTTEREXPRESSION_SV_H
@@ -9,6 +9,7 @@ the Free Software Foundation, either version 3 of the License, or
 */
 
 #include "shutterFunction_sV.h"
+#include "shutterExpression_sV.h"
 
 #include <QtCore/QDebug>
 #include <QtScript/QScriptEngine>
@@ -50,11 +51,13 @@ ShutterFunction_sV::ShutterFunction_sV(const ShutterFunction_sV &other)
 void ShutterFunction_sV::init()
 {
     m_scriptEngine = new QScriptEngine();
+    m_nativeFunction = NULL;
     qDebug() << "Script engine initialized for function " << this;
 }
 ShutterFunction_sV::~ShutterFunction_sV()
 {
     delete m_scriptEngine;
+    delete m_nativeFunction;
 }
 
 void ShutterFunction_sV::operator =(const ShutterFunction_sV &other)
@@ -63,8 +66,7 @@ void ShutterFunction_sV::operator =(const ShutterFunction_sV &other)
     Q_ASSERT(false);
     if (this != &other) {
         m_id = other.m_id;
-        m_function = other.m_function;
-        m_compiledFunction = other.m_compiledFunction;
+        updateFunction(other.m_function);
     }
 }
 
@@ -92,9 +94,24 @@ void ShutterFunction_sV::updateFunction(const QString &function)
 //    qDebug() << "===== Function is:\n" << f << "\n=====";
 
     m_compiledFunction = m_scriptEngine->evaluate(f);
+
+    delete m_nativeFunction;
+    std::string reason;
+    m_nativeFunction = ShutterExpression_sV::compile(m_function.toStdString(), &reason);
+    if (m_nativeFunction == NULL) {
+        qDebug() << "Shutter function " << m_id << " uses QtScript: " << reason.c_str();
+    }
 }
 
 float ShutterFunction_sV::evaluate(const float x, const float t, const float fps, const float y, const float dy)
+{
+    if (m_nativeFunction != NULL) {
+        return m_nativeFunction->evaluate(x, t, fps, y, dy);
+    }
+    return evaluateScript(x, t, fps, y, dy);
+}
+
+float ShutterFunction_sV::evaluateScript(const float x, const float t, const float fps, const float y, const float dy)
 {
     QScriptValueList args;
     args << x << t << fps << y << dy;
@@ -15,6 +15,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include <QtCore/QPointF>
 #include <QtScript/QScriptValue>
 class QScriptEngine;
+class ShutterExpression_sV;
 
 /**
   \brief Defines the shutter length over a node segment.
@@ -39,6 +40,9 @@ class QScriptEngine;
   if (speed < 1) { speed = 0; }
   return speed;
   \endcode
+
+  Functions that only use arithmetic, conditionals and \c Math are compiled natively
+  (see ShutterExpression_sV) and do not need the script engine for evaluation.
 */
 class ShutterFunction_sV
 {
@@ -79,6 +83,11 @@ public:
       \return Shutter duration in seconds
       */
     float evaluate(const float x, const float t, const float fps, const float y, const float dy);
+    /// Like evaluate(), but always uses QtScript, also if the function has been compiled natively.
+    float evaluateScript(const float x, const float t, const float fps, const float y, const float dy);
+
+    /// \return \c true if the function has been compiled natively and does not need QtScript
+    bool isNative() const { return m_nativeFunction != NULL; }
 
 private:
     QString m_id;
@@ -86,6 +95,7 @@ private:
 
     QScriptEngine *m_scriptEngine;
     QScriptValue m_compiledFunction;
+    ShutterExpression_sV *m_nativeFunction;
 
     void init();
     void operator =(const ShutterFunction_sV &other);
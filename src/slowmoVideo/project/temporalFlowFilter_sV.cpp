@@ -0,0 +1,191 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "temporalFlowFilter_sV.h"
+#include "project_sV.h"
+#include "abstractFrameSource_sV.h"
+#include "abstractFlowSource_sV.h"
+#include "cacheManager_sV.h"
+#include "../lib/flowField_sV.h"
+#include "../lib/flowRW_sV.h"
+#include "../lib/flowTools_sV.h"
+#include "../lib/profiler_sV.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QStringList>
+#include <QDebug>
+
+TemporalFlowFilter_sV::TemporalFlowFilter_sV(Project_sV *project) :
+    m_project(project),
+    m_window(1),
+    m_clock(0)
+{
+}
+
+TemporalFlowFilter_sV::~TemporalFlowFilter_sV()
+{
+    clear();
+}
+
+void TemporalFlowFilter_sV::setWindow(int window)
+{
+    Q_ASSERT(window >= 1 && window % 2 == 1 && window <= MEDIAN_MAX_FIELDS);
+    QMutexLocker locker(&m_mutex);
+    if (window != m_window) {
+        clearEntries();
+        m_window = window;
+    }
+}
+
+int TemporalFlowFilter_sV::window() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_window;
+}
+
+void TemporalFlowFilter_sV::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    clearEntries();
+}
+
+void TemporalFlowFilter_sV::clearEntries()
+{
+    for (int i = 0; i < m_entries.size(); i++) {
+        delete m_entries[i].flow;
+    }
+    m_entries.clear();
+}
+
+const QString TemporalFlowFilter_sV::flowPath(int leftFrame, int rightFrame, FrameSize frameSize) const
+{
+    return flowPath(leftFrame, rightFrame, frameSize, window());
+}
+
+const QString TemporalFlowFilter_sV::flowPath(int leftFrame, int rightFrame, FrameSize frameSize, int window) const
+{
+    // The name of the source flow identifies method, direction, frames, and parameters, but not the size.
+    QFileInfo source(m_project->flowSource()->flowPath(leftFrame, rightFrame, frameSize));
+    return m_project->getDirectory("cache/oFlowTemporal").absoluteFilePath(
+                QString("%1-%2-median%3.sVflow").arg(source.completeBaseName())
+                .arg(frameSize == FrameSize_Orig ? "orig" : "small").arg(window));
+}
+
+QStringList TemporalFlowFilter_sV::sourceFlowPaths(int leftFrame, int rightFrame, FrameSize frameSize, int window) const
+{
+    QStringList paths;
+    for (int k = 0; k < window; k++) {
+        int shift = pairShift(k, window, leftFrame, rightFrame);
+        paths << m_project->flowSource()->flowPath(leftFrame+shift, rightFrame+shift, frameSize);
+    }
+    return paths;
+}
+
+int TemporalFlowFilter_sV::pairShift(int k, int window, int leftFrame, int rightFrame) const
+{
+    // Shift the window such that all pairs lie inside the clip.
+    const int count = m_project->frameSource()->framesCount();
+    const int minShift = -qMin(leftFrame, rightFrame);
+    const int maxShift = count-1 - qMax(leftFrame, rightFrame);
+    return qBound(minShift, k - window/2, maxShift);
+}
+
+const QString TemporalFlowFilter_sV::consistencyPath(int leftFrame, int rightFrame, FrameSize frameSize) const
+{
+    QFileInfo flow(flowPath(qMin(leftFrame, rightFrame), qMax(leftFrame, rightFrame), frameSize));
+    return flow.dir().absoluteFilePath(flow.completeBaseName() + ".sVcons");
+}
+
+FlowField_sV* TemporalFlowFilter_sV::buildFlow(int leftFrame, int rightFrame, FrameSize frameSize) throw(FlowBuildingError)
+{
+    // Taken once, such that the file name and the median agree even if the window is changed meanwhile.
+    const int window = this->window();
+
+    QString path = flowPath(leftFrame, rightFrame, frameSize, window);
+    // A source flow which has been built again since (e.g. after it was evicted) may differ.
+    if (CacheManager_sV::isUpToDate(path, sourceFlowPaths(leftFrame, rightFrame, frameSize, window))) {
+        try {
+            Profiler_sV::Timer timer(Profiler_sV::Stage_FlowLoad);
+            FlowField_sV *flow = FlowRW_sV::load(path.toStdString());
+            m_project->cacheManager()->recordAccess(path);
+            return flow;
+        } catch (FlowRW_sV::FlowRWError &err) {
+            qDebug() << "Could not load the filtered flow, building it again: " << err.message.c_str();
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    // If the flow source changes while building the source flow (e.g. to OpenCV if V3D failed),
+    // the fields of the window are requested again such that they all come from the same source.
+    const FlowField_sV *fields[MEDIAN_MAX_FIELDS];
+    bool sameSource = false;
+    for (int pass = 0; pass < 2 && !sameSource; pass++) {
+        QStringList sourcePaths = sourceFlowPaths(leftFrame, rightFrame, frameSize, window);
+        for (int k = 0; k < window; k++) {
+            int shift = pairShift(k, window, leftFrame, rightFrame);
+            fields[k] = sourceFlow(leftFrame+shift, rightFrame+shift, frameSize, window);
+            if (fields[k]->width() != fields[0]->width() || fields[k]->height() != fields[0]->height()) {
+                throw FlowBuildingError(QString("Flow fields of frames %1 to %2 differ in size, cannot filter them.")
+                                        .arg(leftFrame).arg(rightFrame));
+            }
+        }
+        sameSource = sourcePaths == sourceFlowPaths(leftFrame, rightFrame, frameSize, window);
+    }
+    if (!sameSource) {
+        throw FlowBuildingError(QString("The flow source changed while filtering the flow of frames %1 to %2.")
+                                .arg(leftFrame).arg(rightFrame));
+    }
+
+    // Named after the source the fields have been built with
+    path = flowPath(leftFrame, rightFrame, frameSize, window);
+
+    Profiler_sV::Timer timer(Profiler_sV::Stage_FlowBuild);
+    FlowField_sV *flow = new FlowField_sV(fields[0]->width(), fields[0]->height());
+    FlowTools_sV::median(fields, window, *flow);
+    FlowRW_sV::save(path.toStdString(), flow);
+    m_project->cacheManager()->recordAccess(path);
+    return flow;
+}
+
+const FlowField_sV* TemporalFlowFilter_sV::sourceFlow(int leftFrame, int rightFrame, FrameSize frameSize, int window) throw(FlowBuildingError)
+{
+    const QString sourcePath = m_project->flowSource()->flowPath(leftFrame, rightFrame, frameSize);
+    for (int i = 0; i < m_entries.size(); i++) {
+        Entry &e = m_entries[i];
+        if (e.sourcePath == sourcePath) {
+            e.lastUse = ++m_clock;
+            return e.flow;
+        }
+    }
+
+    Entry entry;
+    entry.flow = m_project->requestSourceFlow(leftFrame, rightFrame, frameSize);
+    // Not sourcePath: the flow source may have changed while building the flow.
+    entry.sourcePath = m_project->flowSource()->flowPath(leftFrame, rightFrame, frameSize);
+    entry.lastUse = ++m_clock;
+
+    // The fields of the current window have been used last and are therefore never replaced.
+    if (m_entries.size() < 2*window) {
+        m_entries.append(entry);
+    } else {
+        int oldest = 0;
+        for (int i = 1; i < m_entries.size(); i++) {
+            if (m_entries[i].lastUse < m_entries[oldest].lastUse) {
+                oldest = i;
+            }
+        }
+        delete m_entries[oldest].flow;
+        m_entries[oldest] = entry;
+    }
+    return entry.flow;
+}
@@ -0,0 +1,97 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#ifndef TEMPORALFLOWFILTER_SV_H
+#define TEMPORALFLOWFILTER_SV_H
+
+#include "../lib/defs_sV.hpp"
+
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+class Project_sV;
+class FlowField_sV;
+
+/**
+  \brief Post-processes the flow of the flow source with a temporal median.
+
+  The filtered flow from \c leftFrame to \c rightFrame is the per-pixel median (see FlowTools_sV::median())
+  of the flow fields of the \c window frame pairs centred at it, i.e. from <code>leftFrame-window/2</code>
+  to <code>rightFrame-window/2</code> up to <code>leftFrame+window/2</code> to <code>rightFrame+window/2</code>.
+  This removes flow vectors that flicker in a single pair. At the start and end of the clip the outermost pair
+  is repeated.
+
+  The flow fields of the source are kept in a ring buffer with room for a window in each direction,
+  the least recently used one is replaced. Frames are rendered in increasing order, so for each further pair
+  only one flow field per direction has to be requested from the flow source, and the memory used stays
+  the same for arbitrarily long clips. The fields are identified by the file name of the source flow,
+  so fields built with other flow settings (e.g. a different lambda) are not used.
+  The filtered flow is written to \c cache/oFlowTemporal, next to the flow cache of the flow source,
+  and built again if one of the source flow files is newer.
+
+  The filter is shared by the render threads; the window and the ring buffer are protected by a mutex.
+  */
+class TemporalFlowFilter_sV
+{
+public:
+    TemporalFlowFilter_sV(Project_sV *project);
+    ~TemporalFlowFilter_sV();
+
+    /**
+      Sets the number of frame pairs the median is taken over; an odd number, 1 disables filtering.
+      Changing the window clears the ring buffer.
+      */
+    void setWindow(int window);
+    int window() const;
+
+    /** \return The filtered flow field from \c leftFrame to \c rightFrame, from the cache if it has been built already. */
+    FlowField_sV* buildFlow(int leftFrame, int rightFrame, FrameSize frameSize) throw(FlowBuildingError);
+    /** \return The path to the filtered flow file for the given frames */
+    const QString flowPath(int leftFrame, int rightFrame, FrameSize frameSize) const;
+    /** \return The path to the ConsistencyMap_sV of the filtered flow of the frame pair */
+    const QString consistencyPath(int leftFrame, int rightFrame, FrameSize frameSize) const;
+
+    /** Deletes the flow fields in the ring buffer. */
+    void clear();
+
+private:
+    /// Flow field of the flow source for a frame pair
+    struct Entry {
+        /// Flow file of the source; identifies frames, size, method, and flow parameters
+        QString sourcePath;
+        FlowField_sV *flow;
+        uint lastUse;
+    };
+
+    Project_sV *m_project;
+    int m_window;
+
+    mutable QMutex m_mutex;
+    /// Ring buffer with 2*window entries
+    QVector<Entry> m_entries;
+    uint m_clock;
+
+    /**
+      \return The source flow for the frame pair, from the ring buffer or requested from the project.
+      The ring buffer keeps room for 2*window fields, so none of the fields of the current window are replaced.
+      */
+    const FlowField_sV* sourceFlow(int leftFrame, int rightFrame, FrameSize frameSize, int window) throw(FlowBuildingError);
+    /** \return The offset of pair \c k of the window, limited such that all pairs lie inside the clip */
+    int pairShift(int k, int window, int leftFrame, int rightFrame) const;
+    /** \return The flow files of the source for all pairs of the window */
+    QStringList sourceFlowPaths(int leftFrame, int rightFrame, FrameSize frameSize, int window) const;
+    const QString flowPath(int leftFrame, int rightFrame, FrameSize frameSize, int window) const;
+    /** Deletes the flow fields in the ring buffer; the caller holds the mutex. */
+    void clearEntries();
+};
+
+#endif // TEMPORALFLOWFILTER_SV_H
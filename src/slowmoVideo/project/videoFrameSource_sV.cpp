@@ -10,6 +10,7 @@ the Free Software Foundation, either version 3 of the License, or
 
 #include "videoFrameSource_sV.h"
 #include "project_sV.h"
+#include "../lib/profiler_sV.h"
 
 #include <QtCore/QProcess>
 #include <QtCore/QTimer>
@@ -96,6 +97,7 @@ const Fps_sV* VideoFrameSource_sV::fps() const
 }
 QImage VideoFrameSource_sV::frameAt(const uint frame, const FrameSize frameSize)
 {
+    Profiler_sV::Timer timer(Profiler_sV::Stage_Decode);
     return QImage(framePath(frame, frameSize));
 }
 const QString VideoFrameSource_sV::videoFile() const
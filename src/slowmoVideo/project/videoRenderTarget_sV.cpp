@@ -20,19 +20,30 @@ the Free Software Foundation, either version 3 of the License, or
 
 #include "videoRenderTarget_sV.h"
 #include "renderTask_sV.h"
+#include "frameQueue_sV.h"
 #include <QtCore/QObject>
 
 extern "C" {
 #include "../lib/ffmpegEncode_sV.h"
 }
 
+/// Default number of frames waiting for the encoder
+#define DEFAULT_QUEUE_SIZE 4
+
 VideoRenderTarget_sV::VideoRenderTarget_sV(RenderTask_sV *parentRenderTask) :
-    AbstractRenderTarget_sV(parentRenderTask)
+    AbstractRenderTarget_sV(parentRenderTask),
+    m_bitrate(0),
+    m_crf(-1),
+    m_encoderThreads(0),
+    m_queueSize(DEFAULT_QUEUE_SIZE),
+    m_queue(NULL),
+    m_encoder(NULL)
 {
     m_videoOut = (VideoOut_sV*)malloc(sizeof(VideoOut_sV));
 }
 VideoRenderTarget_sV::~VideoRenderTarget_sV()
 {
+    stopEncoder();
     free(m_videoOut);
 }
 
@@ -44,30 +55,104 @@ void VideoRenderTarget_sV::setVcodec(const QString &codec)
 {
     m_vcodec = codec;
 }
+void VideoRenderTarget_sV::setQueueSize(int frames)
+{
+    Q_ASSERT(frames > 0);
+    m_queueSize = frames;
+}
+void VideoRenderTarget_sV::setBitrate(int bitrate)
+{
+    Q_ASSERT(bitrate >= 0);
+    m_bitrate = bitrate;
+}
+void VideoRenderTarget_sV::setCrf(int crf)
+{
+    m_crf = crf;
+}
+void VideoRenderTarget_sV::setPreset(const QString &preset)
+{
+    m_preset = preset;
+}
+void VideoRenderTarget_sV::setEncoderThreads(int threads)
+{
+    Q_ASSERT(threads >= 0);
+    m_encoderThreads = threads;
+}
 
 void VideoRenderTarget_sV::openRenderTarget() throw(Error_sV)
 {
-    char *vcodec = NULL;
-    if (m_vcodec.length() > 0) {
-        vcodec = (char*)malloc(m_vcodec.length()+1);
-        strcpy(vcodec, m_vcodec.toStdString().c_str());
+    QByteArray vcodec = m_vcodec.toUtf8();
+    QByteArray preset = m_preset.toUtf8();
+    QSize size = renderTask()->resolution();
+
+    EncoderSettings_sV settings;
+    defaultEncoderSettings(&settings);
+    settings.bitrate = m_bitrate;
+    if (m_bitrate == 0 && m_crf < 0) {
+        // High quality default
+        settings.bitrate = renderTask()->fps().fps() * size.width() * size.height();
     }
+    settings.crf = m_crf;
+    settings.preset = (preset.length() > 0) ? preset.constData() : NULL;
+    settings.threads = m_encoderThreads;
+
     int worked =
-    prepare(m_videoOut, m_filename.toStdString().c_str(), vcodec,
-            renderTask()->resolution().width(), renderTask()->resolution().height(),
-            renderTask()->fps().fps() * renderTask()->resolution().width() * renderTask()->resolution().height(),
-            renderTask()->fps().den, renderTask()->fps().num);
+    prepareWithSettings(m_videoOut, m_filename.toStdString().c_str(),
+                        (vcodec.length() > 0) ? vcodec.constData() : NULL,
+                        size.width(), size.height(), &settings,
+                        renderTask()->fps().den, renderTask()->fps().num);
     if (worked != 0) {
         throw Error_sV(QObject::tr("Video could not be prepared (error code %1).\n%2").arg(worked).arg(m_videoOut->errorMessage));
     }
+
+    stopEncoder();
+    m_queue = new FrameQueue_sV(m_queueSize);
+    m_encoder = new FrameConsumerThread_sV(m_queue, this);
+    m_encoder->start();
 }
 
 void VideoRenderTarget_sV::slotConsumeFrame(const QImage &image, const int frameNumber)
 {
-    eatARGB(m_videoOut, image.bits());
+    if (m_queue == NULL) {
+        throw Error_sV(QObject::tr("Video render target has not been opened, cannot add frame %1.").arg(frameNumber));
+    }
+    // Blocks while the encoder is busy with previous frames.
+    if (!m_queue->push(image, frameNumber)) {
+        throw Error_sV(stopEncoder());
+    }
+}
+
+void VideoRenderTarget_sV::consumeQueuedFrame(const QImage &image, int frameNumber) throw(Error_sV)
+{
+    int ret = eatARGB(m_videoOut, image.bits());
+    if (ret != 0) {
+        throw Error_sV(QObject::tr("Frame %1 could not be encoded (error code %2).\n%3")
+                       .arg(frameNumber).arg(ret).arg(m_videoOut->errorMessage));
+    }
+}
+
+QString VideoRenderTarget_sV::stopEncoder()
+{
+    QString error;
+    if (m_encoder != NULL) {
+        m_queue->close();
+        m_encoder->wait();
+        if (m_encoder->failed()) {
+            error = m_encoder->errorMessage();
+        }
+        delete m_encoder;
+        m_encoder = NULL;
+    }
+    delete m_queue;
+    m_queue = NULL;
+    return error;
 }
 
 void VideoRenderTarget_sV::closeRenderTarget() throw(Error_sV)
 {
+    QString error = stopEncoder();
     finish(m_videoOut);
+    if (error.length() > 0) {
+        throw Error_sV(error);
+    }
 }
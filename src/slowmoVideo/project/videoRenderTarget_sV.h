@@ -12,12 +12,20 @@ the Free Software Foundation, either version 3 of the License, or
 #define VIDEORENDERTARGET_SV_H
 
 #include "abstractRenderTarget_sV.h"
+#include "frameConsumerThread_sV.h"
 
 class VideoOut_sV;
 class RenderTask_sV;
+class FrameQueue_sV;
 
-/// Produces videos from frames.
-class VideoRenderTarget_sV : public AbstractRenderTarget_sV
+/**
+  \brief Produces videos from frames.
+
+  Frames are encoded on a separate thread, such that encoding the current frame and
+  rendering the next one overlap. The queue between rendering and encoding is bounded;
+  if the encoder is slower, slotConsumeFrame() waits until there is space again.
+  */
+class VideoRenderTarget_sV : public AbstractRenderTarget_sV, public FrameConsumerThread_sV::Consumer
 {
 public:
     /// Constructs a new video render target
@@ -28,11 +36,27 @@ public:
     void setTargetFile(const QString& filename);
     /// Set a custom video codec (see <pre>ffmpeg -codecs</pre> for a list of available codecs).
     void setVcodec(const QString& codec);
+    /// Number of rendered frames that may wait for the encoder. Takes effect when opening the target.
+    void setQueueSize(int frames);
+
+    /// Bit rate in bits/s. 0 (default) uses width*height*fps, or lets the encoder decide if a crf is set.
+    void setBitrate(int bitrate);
+    /// Constant rate factor for x264/x265/VP9 (e.g. 18 for high quality). -1 disables it (default).
+    void setCrf(int crf);
+    /// Encoder preset for x264/x265 like \c medium or \c slow. Empty for the encoder's default.
+    void setPreset(const QString &preset);
+    /// Number of encoder threads. 0 (default) uses all cores.
+    void setEncoderThreads(int threads);
 
     void openRenderTarget() throw(Error_sV);
+    /// Waits until all queued frames are encoded. Throws an error if encoding failed.
     void closeRenderTarget() throw(Error_sV);
 
+    /// Encodes a frame; called on the encoder thread.
+    void consumeQueuedFrame(const QImage &image, int frameNumber) throw(Error_sV);
+
 public slots:
+    /// Queues the frame for encoding. Throws an Error_sV if the encoder has failed or the target is not open.
     void slotConsumeFrame(const QImage &image, const int frameNumber);
 
 private:
@@ -40,6 +64,21 @@ private:
     QString m_vcodec;
     VideoOut_sV *m_videoOut;
 
+    int m_bitrate;
+    int m_crf;
+    QString m_preset;
+    int m_encoderThreads;
+
+    int m_queueSize;
+    FrameQueue_sV *m_queue;
+    FrameConsumerThread_sV *m_encoder;
+
+    /**
+      Stops the encoder thread after encoding the remaining frames.
+      \return The encoder's error message, or an empty string if there was no error
+      */
+    QString stopEncoder();
+
     int m_width;
     int m_height;
 };
@@ -19,6 +19,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include "emptyFrameSource_sV.h"
 #include "imagesFrameSource_sV.h"
 #include "motionBlur_sV.h"
+#include "../lib/flowTools_sV.h"
 
 #include <QDebug>
 #include <QTextStream>
@@ -67,6 +68,10 @@ int XmlProjectRW_sV::saveProject(Project_sV *project, QString filename) throw(Er
     QDomElement videoFilename = doc.createElement("videoFilename");
     QDomElement videoCodec = doc.createElement("videoCodec");
     QDomElement flowV3dLambda = doc.createElement("flowV3dLambda");
+    QDomElement flowWarmStart = doc.createElement("flowWarmStart");
+    QDomElement flowScale = doc.createElement("flowScale");
+    QDomElement flowSmallInit = doc.createElement("flowSmallInit");
+    QDomElement flowTemporalMedian = doc.createElement("flowTemporalMedian");
     QDomElement prevTagAxis = doc.createElement("prevTagAxis");
     QDomElement viewport_t0 = doc.createElement("viewport_t0");
     QDomElement viewport_secRes = doc.createElement("viewport_secRes");
@@ -88,6 +93,10 @@ int XmlProjectRW_sV::saveProject(Project_sV *project, QString filename) throw(Er
     preferences.appendChild(videoFilename);
     preferences.appendChild(videoCodec);
     preferences.appendChild(flowV3dLambda);
+    preferences.appendChild(flowWarmStart);
+    preferences.appendChild(flowScale);
+    preferences.appendChild(flowSmallInit);
+    preferences.appendChild(flowTemporalMedian);
     preferences.appendChild(prevTagAxis);
     preferences.appendChild(viewport_t0);
     preferences.appendChild(viewport_secRes);
@@ -109,6 +118,10 @@ int XmlProjectRW_sV::saveProject(Project_sV *project, QString filename) throw(Er
     videoFilename.setAttribute("file", pr->videoFilename());
     videoCodec.setAttribute("codec", pr->videoCodec());
     flowV3dLambda.setAttribute("lambda", pr->flowV3DLambda());
+    flowWarmStart.setAttribute("enabled", QVariant(pr->flowWarmStart()).toString());
+    flowScale.setAttribute("scale", pr->flowScale());
+    flowSmallInit.setAttribute("enabled", QVariant(pr->flowSmallInit()).toString());
+    flowTemporalMedian.setAttribute("window", pr->flowTemporalMedian());
     prevTagAxis.setAttribute("axis", QVariant(pr->lastSelectedTagAxis()).toString());
     viewport_t0.setAttribute("x", pr->viewport_t0().x());
     viewport_t0.setAttribute("y", pr->viewport_t0().y());
@@ -524,6 +537,24 @@ Project_sV* XmlProjectRW_sV::loadProject(QString filename, QString *warning) thr
                             } else if (xml.name() == "flowV3dLambda") {
                                 pr->flowV3DLambda() = xml.attributes().value("lambda").toString().toFloat();
                                 xml.skipCurrentElement();
+                            } else if (xml.name() == "flowWarmStart") {
+                                pr->flowWarmStart() = xml.attributes().value("enabled").toString() == "true";
+                                xml.skipCurrentElement();
+                            } else if (xml.name() == "flowScale") {
+                                float scale = xml.attributes().value("scale").toString().toFloat();
+                                if (scale > 0 && scale <= 1) {
+                                    pr->flowScale() = scale;
+                                }
+                                xml.skipCurrentElement();
+                            } else if (xml.name() == "flowSmallInit") {
+                                pr->flowSmallInit() = xml.attributes().value("enabled").toString() == "true";
+                                xml.skipCurrentElement();
+                            } else if (xml.name() == "flowTemporalMedian") {
+                                int window = xml.attributes().value("window").toString().toInt();
+                                if (window >= 1 && window % 2 == 1 && window <= MEDIAN_MAX_FIELDS) {
+                                    pr->flowTemporalMedian() = window;
+                                }
+                                xml.skipCurrentElement();
 
                             } else if (xml.name() == "prevTagAxis") {
                                 pr->lastSelectedTagAxis() = (TagAxis)xml.attributes().value("axis").toString().toInt();
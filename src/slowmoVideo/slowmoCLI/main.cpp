@@ -9,6 +9,7 @@ the Free Software Foundation, either version 3 of the License, or
 */
 
 #include "../lib/interpolate_sV.h"
+#include "../lib/floatImage_sV.h"
 #include "../lib/flowField_sV.h"
 #include "../lib/flowRW_sV.h"
 
@@ -177,7 +178,12 @@ int main(int argc, char *argv[])
 
 
 
-    output = QImage(left.size(), QImage::Format_RGB32);
+    FloatImage_sV leftF = FloatImage_sV::fromImage(left);
+    FloatImage_sV rightF;
+    if (mode == FlowMode_Twoway) {
+        rightF = FloatImage_sV::fromImage(right);
+    }
+    FloatImage_sV outputF(left.size());
 
 
 
@@ -193,12 +199,13 @@ int main(int argc, char *argv[])
     for (unsigned int step = 0; step < fps+1; step++) {
         pos = step/float(fps);
         if (mode == FlowMode_Twoway) {
-            Interpolate_sV::twowayFlow(left, right, ffForward, ffBackward, pos, output);
+            Interpolate_sV::twowayFlow(leftF, rightF, ffForward, ffBackward, pos, outputF);
         } else if (mode == FlowMode_Forward) {
-            Interpolate_sV::forwardFlow(left, ffForward, pos, output);
+            Interpolate_sV::forwardFlow(leftF, ffForward, pos, outputF);
         }
         filename = pattern.arg(QString::number(numberOffset + step), stepLog, fillChar);
         qDebug() << "Saving position " << pos << " to image " << filename;
+        output = outputF.toImage();
         output.save(filename);
     }
 
@@ -9,6 +9,7 @@ the Free Software Foundation, either version 3 of the License, or
 */
 
 #include "slowmoRenderer_sV.h"
+#include "../lib/flowTools_sV.h"
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QStringList>
@@ -43,13 +44,21 @@ void printHelp()
 {
     std::cout << "slowmoRenderer for slowmoVideo " << Version_sV::version.toStdString() << std::endl
               << myName.toStdString() << " <project>" << std::endl
-              << "\t-target [video <path> [<codec>|auto] | images <filenamePattern> <directory> ] " << std::endl
+              << "\t-target [video <path> [<codec>|auto] | images <filenamePattern> <directory> " << std::endl
+              << "\t\t| raw [pfm|ppm16|pam16] <filenamePattern> <directory> " << std::endl
+              << "\t\t| pipe <path> [<ffmpeg output options>|default] ] " << std::endl
+              << "\t-crf <crf> -preset <preset> -bitrate <kbit/s> -encoderThreads <threads|0> " << std::endl
               << "\t-size [small|orig] " << std::endl
               << "\t-fps <fps> " << std::endl
               << "\t-start <startTime> -end <endTime> " << std::endl
               << "\t-interpolation [forward[2]|twoway[2]] " << std::endl
               << "\t -motionblur [stack|convolve] " << std::endl
-              << "\t-v3dLambda <lambda> " << std::endl;
+              << "\t-v3dLambda <lambda> -flowWarmStart -flowScale <0..1> -flowSmallInit -flowTemporalMedian <pairs> " << std::endl
+              << "\t-cacheQuota <MiB> -cachePolicy [lru|lfu] " << std::endl
+              << "\t-exportPlan <csvFile> " << std::endl
+              << "\t-profile -profileJson <jsonFile> " << std::endl
+              << myName.toStdString() << " <project> -cacheStats" << std::endl
+              << myName.toStdString() << " <project> -prune <MiB> [-cachePolicy [lru|lfu]]" << std::endl;
 }
 
 void require(int nArgs, int index, int size)
@@ -93,6 +102,17 @@ int main(int argc, char *argv[])
 
     QString start = ":start";
     QString end = ":end";
+    bool cacheOnly = false;
+    bool showCacheStats = false;
+    qint64 pruneTo = -1;
+    QString planFile;
+    bool encoderSettingsSet = false;
+    int bitrate = 0;
+    int crf = -1;
+    QString preset;
+    int encoderThreads = 0;
+    bool printProfile = false;
+    QString profileFile;
 
     const int n = args.size();
     int next = 2;
@@ -114,6 +134,26 @@ int main(int argc, char *argv[])
                 QString dir = args.at(next++);
                 renderer.setImagesRenderTarget(filenamePattern, dir);
 
+            } else if ("raw" == args.at(next)) {
+                require(3, next, n);
+                next++;
+                QString format = args.at(next++);
+                QString filenamePattern = args.at(next++);
+                QString dir = args.at(next++);
+                try {
+                    renderer.setRawRenderTarget(format, filenamePattern, dir);
+                } catch (Error &err) {
+                    std::cerr << err.message << std::endl;
+                    return -1;
+                }
+
+            } else if ("pipe" == args.at(next)) {
+                next++;
+                QString filename = args.at(next++);
+                QString options = args.at(next++);
+                if ("default" == options) { options = ""; }
+                renderer.setPipeRenderTarget(filename, options);
+
             } else {
                 std::cerr << "Not a valid target: " << args.at(next).toStdString() << std::endl;
                 return -1;
@@ -196,6 +236,116 @@ int main(int argc, char *argv[])
             renderer.setV3dLambda(lambda);
             next++;
 
+        } else if ("-flowWarmStart" == args.at(next)) {
+            next++;
+            renderer.setFlowWarmStart(true);
+
+        } else if ("-flowScale" == args.at(next)) {
+            require(1, next, n);
+            next++;
+            bool b;
+            float scale = args.at(next).toFloat(&b);
+            if (!b || scale <= 0 || scale > 1) {
+                std::cerr << "Not a valid flow scale (0 < scale <= 1): " << args.at(next).toStdString() << std::endl;
+                return -1;
+            }
+            renderer.setFlowScale(scale);
+            next++;
+
+        } else if ("-flowSmallInit" == args.at(next)) {
+            next++;
+            renderer.setFlowSmallInit(true);
+
+        } else if ("-flowTemporalMedian" == args.at(next)) {
+            require(1, next, n);
+            next++;
+            bool b;
+            int window = args.at(next).toInt(&b);
+            if (!b || window < 1 || window % 2 == 0 || window > MEDIAN_MAX_FIELDS) {
+                std::cerr << "Not a valid number of frame pairs (odd, 1 to " << MEDIAN_MAX_FIELDS << "): "
+                          << args.at(next).toStdString() << std::endl;
+                return -1;
+            }
+            renderer.setFlowTemporalMedian(window);
+            next++;
+
+        } else if ("-cacheQuota" == args.at(next) || "-prune" == args.at(next)) {
+            require(1, next, n);
+            bool prune = "-prune" == args.at(next);
+            next++;
+            bool b;
+            qint64 megabytes = args.at(next).toLongLong(&b);
+            if (!b || megabytes < 0) {
+                std::cerr << "Not a valid size in MiB: " << args.at(next).toStdString() << std::endl;
+                return -1;
+            }
+            if (prune) {
+                pruneTo = megabytes;
+                cacheOnly = true;
+            } else {
+                renderer.setCacheQuota(megabytes);
+            }
+            next++;
+
+        } else if ("-cachePolicy" == args.at(next)) {
+            require(1, next, n);
+            next++;
+            bool b;
+            CacheManager_sV::Policy policy = CacheManager_sV::fromString(args.at(next), &b);
+            if (!b) {
+                std::cerr << "Not a valid cache policy: " << args.at(next).toStdString() << std::endl;
+                return -1;
+            }
+            renderer.setCachePolicy(policy);
+            next++;
+
+        } else if ("-crf" == args.at(next) || "-bitrate" == args.at(next) || "-encoderThreads" == args.at(next)) {
+            require(1, next, n);
+            QString option = args.at(next);
+            next++;
+            bool b;
+            int value = args.at(next).toInt(&b);
+            if (!b || value < 0) {
+                std::cerr << "Not a valid value for " << option.toStdString() << ": " << args.at(next).toStdString() << std::endl;
+                return -1;
+            }
+            if ("-crf" == option) {
+                crf = value;
+            } else if ("-bitrate" == option) {
+                bitrate = 1000*value;
+            } else {
+                encoderThreads = value;
+            }
+            encoderSettingsSet = true;
+            next++;
+
+        } else if ("-preset" == args.at(next)) {
+            require(1, next, n);
+            next++;
+            preset = args.at(next++);
+            encoderSettingsSet = true;
+
+        } else if ("-exportPlan" == args.at(next)) {
+            require(1, next, n);
+            next++;
+            planFile = args.at(next++);
+
+        } else if ("-profile" == args.at(next)) {
+            next++;
+            printProfile = true;
+            renderer.setProfiling(true);
+
+        } else if ("-profileJson" == args.at(next)) {
+            require(1, next, n);
+            next++;
+            profileFile = args.at(next++);
+            renderer.setProfiling(true);
+
+        } else if ("-cacheStats" == args.at(next)) {
+            next++;
+            showCacheStats = true;
+            cacheOnly = true;
+
         } else {
             std::cout << "Argument not recognized: " << args.at(next).toStdString() << std::endl;
             printHelp();
@@ -203,8 +353,30 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (cacheOnly) {
+        if (pruneTo >= 0) {
+            renderer.pruneCache(pruneTo);
+        }
+        if (showCacheStats || pruneTo >= 0) {
+            renderer.printCacheStatistics();
+        }
+        return 0;
+    }
+
+    if (encoderSettingsSet && !renderer.setEncoderSettings(bitrate, crf, preset, encoderThreads)) {
+        std::cout << "Encoder settings are only used for video targets, ignoring them." << std::endl;
+    }
+
     renderer.setTimeRange(start, end);
 
+    if (planFile.length() > 0) {
+        if (renderer.exportPlan(planFile)) {
+            std::cout << "Render plan written to " << planFile.toStdString() << std::endl;
+        } else {
+            std::cerr << "Could not write render plan to " << planFile.toStdString() << std::endl;
+        }
+    }
+
     QString msg;
     if (!renderer.isComplete(msg)) {
         std::cout << msg.toStdString() << std::endl;
@@ -214,4 +386,15 @@ int main(int argc, char *argv[])
 
     renderer.start();
 
+    if (printProfile) {
+        renderer.printProfile();
+    }
+    if (profileFile.length() > 0) {
+        if (renderer.writeProfile(profileFile)) {
+            std::cout << "Render profile written to " << profileFile.toStdString() << std::endl;
+        } else {
+            std::cerr << "Could not write render profile to " << profileFile.toStdString() << std::endl;
+        }
+    }
+
 }
@@ -15,9 +15,14 @@ the Free Software Foundation, either version 3 of the License, or
 #include "project/xmlProjectRW_sV.h"
 #include "project/renderTask_sV.h"
 #include "project/imagesRenderTarget_sV.h"
+#include "project/rawRenderTarget_sV.h"
 #include "project/videoRenderTarget_sV.h"
+#include "project/pipeRenderTarget_sV.h"
 #include "project/flowSourceV3D_sV.h"
+#include "project/renderPlan_sV.h"
+#include "lib/profiler_sV.h"
 
+#include <QtCore/QFile>
 #include <iostream>
 
 Error::Error(std::string message) :
@@ -29,7 +34,8 @@ SlowmoRenderer_sV::SlowmoRenderer_sV() :
     m_lastProgress(0),
     m_start(":start"),
     m_end(":end"),
-    m_renderTargetSet(false)
+    m_renderTargetSet(false),
+    m_videoTarget(NULL)
 {
 }
 
@@ -92,6 +98,19 @@ void SlowmoRenderer_sV::setVideoRenderTarget(QString filename, QString codec)
     vrt->setVcodec(QString(codec));
     m_project->renderTask()->setRenderTarget(vrt);
     m_renderTargetSet = true;
+    m_videoTarget = vrt;
+}
+
+bool SlowmoRenderer_sV::setEncoderSettings(int bitrate, int crf, QString preset, int threads)
+{
+    if (m_videoTarget == NULL) {
+        return false;
+    }
+    m_videoTarget->setBitrate(bitrate);
+    m_videoTarget->setCrf(crf);
+    m_videoTarget->setPreset(preset);
+    m_videoTarget->setEncoderThreads(threads);
+    return true;
 }
 
 void SlowmoRenderer_sV::setImagesRenderTarget(QString filenamePattern, QString directory)
@@ -101,6 +120,33 @@ void SlowmoRenderer_sV::setImagesRenderTarget(QString filenamePattern, QString d
     irt->setTargetDir(QString(directory));
     m_project->renderTask()->setRenderTarget(irt);
     m_renderTargetSet = true;
+    m_videoTarget = NULL;
+}
+
+void SlowmoRenderer_sV::setRawRenderTarget(QString format, QString filenamePattern, QString directory) throw(Error)
+{
+    bool ok;
+    RawRenderTarget_sV::Format f = RawRenderTarget_sV::fromString(format, &ok);
+    if (!ok) {
+        throw Error("Not a valid raw format: " + format.toStdString());
+    }
+    RawRenderTarget_sV *rrt = new RawRenderTarget_sV(m_project->renderTask());
+    rrt->setFormat(f);
+    rrt->setFilenamePattern(filenamePattern);
+    rrt->setTargetDir(QString(directory));
+    m_project->renderTask()->setRenderTarget(rrt);
+    m_renderTargetSet = true;
+    m_videoTarget = NULL;
+}
+
+void SlowmoRenderer_sV::setPipeRenderTarget(QString filename, QString arguments)
+{
+    PipeRenderTarget_sV *prt = new PipeRenderTarget_sV(m_project->renderTask());
+    prt->setTargetFile(filename);
+    prt->setArguments(arguments.split(" ", QString::SkipEmptyParts));
+    m_project->renderTask()->setRenderTarget(prt);
+    m_renderTargetSet = true;
+    m_videoTarget = NULL;
 }
 
 void SlowmoRenderer_sV::setInterpolation(InterpolationType interpolation)
@@ -127,6 +173,85 @@ void SlowmoRenderer_sV::setV3dLambda(float lambda)
     m_project->preferences()->flowV3DLambda() = lambda;
 }
 
+void SlowmoRenderer_sV::setFlowWarmStart(bool warmStart)
+{
+    m_project->preferences()->flowWarmStart() = warmStart;
+}
+
+void SlowmoRenderer_sV::setFlowScale(float scale)
+{
+    m_project->preferences()->flowScale() = scale;
+}
+
+void SlowmoRenderer_sV::setFlowSmallInit(bool smallInit)
+{
+    m_project->preferences()->flowSmallInit() = smallInit;
+}
+
+void SlowmoRenderer_sV::setFlowTemporalMedian(int window)
+{
+    m_project->preferences()->flowTemporalMedian() = window;
+}
+
+void SlowmoRenderer_sV::setCacheQuota(qint64 megabytes)
+{
+    m_project->cacheManager()->setQuota(megabytes * 1024 * 1024);
+}
+
+void SlowmoRenderer_sV::setCachePolicy(CacheManager_sV::Policy policy)
+{
+    m_project->cacheManager()->setPolicy(policy);
+}
+
+void SlowmoRenderer_sV::printCacheStatistics()
+{
+    QList<CacheManager_sV::DirectoryStats> stats = m_project->cacheManager()->statistics();
+    qint64 total = 0;
+    for (int i = 0; i < stats.size(); i++) {
+        std::cout << stats.at(i).name.toStdString() << ": " << stats.at(i).files << " files, "
+                  << stats.at(i).bytes/1024 << " KiB" << (stats.at(i).evictable ? "" : " (not evictable)") << std::endl;
+        total += stats.at(i).bytes;
+    }
+    std::cout << "Total: " << total/1024 << " KiB, evictable: " << m_project->cacheManager()->evictableSize()/1024 << " KiB";
+    if (m_project->cacheManager()->quota() > 0) {
+        std::cout << ", quota: " << m_project->cacheManager()->quota()/1024 << " KiB ("
+                  << CacheManager_sV::toString(m_project->cacheManager()->policy()).toStdString() << ")";
+    }
+    std::cout << std::endl;
+}
+
+void SlowmoRenderer_sV::pruneCache(qint64 megabytes)
+{
+    int deleted = m_project->cacheManager()->prune(megabytes * 1024 * 1024);
+    std::cout << "Deleted " << deleted << " cached files." << std::endl;
+}
+
+bool SlowmoRenderer_sV::exportPlan(QString filename)
+{
+    m_project->renderTask()->updatePlan();
+    return m_project->renderTask()->renderPlan()->exportCsv(filename);
+}
+
+void SlowmoRenderer_sV::setProfiling(bool enabled)
+{
+    Profiler_sV::instance()->setEnabled(enabled);
+}
+
+void SlowmoRenderer_sV::printProfile()
+{
+    std::cout << Profiler_sV::instance()->report().toStdString();
+}
+
+bool SlowmoRenderer_sV::writeProfile(QString filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QByteArray json = Profiler_sV::instance()->toJson().toUtf8();
+    return file.write(json) == json.size();
+}
+
 void SlowmoRenderer_sV::start()
 {
     m_project->renderTask()->slotContinueRendering();
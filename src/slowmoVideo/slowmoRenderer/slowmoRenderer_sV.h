@@ -12,11 +12,13 @@ the Free Software Foundation, either version 3 of the License, or
 #define SLOWMORENDERER_SV_H
 
 #include "lib/defs_sV.hpp"
+#include "project/cacheManager_sV.h"
 #include <QtCore/QObject>
 #include <QtCore/QCoreApplication>
 #include <string>
 
 class Project_sV;
+class VideoRenderTarget_sV;
 
 class Error {
 public:
@@ -41,12 +43,48 @@ public:
     void setTimeRange(QString start, QString end);
     void setFps(double fps);
     void setVideoRenderTarget(QString filename, QString codec);
+    /**
+      Sets the encoder quality and threads for the video render target, see VideoRenderTarget_sV.
+      \return \c false if no video render target has been set
+      */
+    bool setEncoderSettings(int bitrate, int crf, QString preset, int threads);
     void setImagesRenderTarget(QString filenamePattern, QString directory);
+    /// Writes uncompressed high bit depth images, \c format is \c pfm, \c ppm16, or \c pam16.
+    void setRawRenderTarget(QString format, QString filenamePattern, QString directory) throw(Error);
+    /**
+      Streams the frames to the ffmpeg executable from the settings.
+      \param arguments Output options for ffmpeg, separated by spaces
+      */
+    void setPipeRenderTarget(QString filename, QString arguments);
     void setInterpolation(InterpolationType interpolation);
     void setMotionblur(MotionblurType motionblur);
     void setSize(bool original);
     void setV3dLambda(float lambda);
-
+    /// Initialise each frame pair's flow with the neighbouring pair's flow, see AbstractFlowSource_sV::setWarmStart()
+    void setFlowWarmStart(bool warmStart);
+    /// Builds the flow for the original size at a reduced scale, see AbstractFlowSource_sV::setScale()
+    void setFlowScale(float scale);
+    /// Initialises the flow for the original size with the flow of the small size, see AbstractFlowSource_sV::setSmallInit()
+    void setFlowSmallInit(bool smallInit);
+    /// Median filters the flow over this many frame pairs, see TemporalFlowFilter_sV
+    void setFlowTemporalMedian(int window);
+    void setCacheQuota(qint64 megabytes);
+    void setCachePolicy(CacheManager_sV::Policy policy);
+
+    /// Prints the usage of the project's cache directories
+    void printCacheStatistics();
+    /// Deletes cached files until the cache is not larger than \c megabytes
+    void pruneCache(qint64 megabytes);
+
+    /// Writes the source times and shutter lengths of all frames to render to a CSV file
+    bool exportPlan(QString filename);
+
+    /// Measures the time spent in each render stage, see Profiler_sV
+    void setProfiling(bool enabled);
+    /// Prints the time spent in each render stage
+    void printProfile();
+    /// Writes the time spent in each render stage to a JSON file
+    bool writeProfile(QString filename);
 
     void printProgress();
 
@@ -65,6 +103,7 @@ private:
     QString m_end;
 
     bool m_renderTargetSet;
+    VideoRenderTarget_sV *m_videoTarget;
 
 
 private slots:
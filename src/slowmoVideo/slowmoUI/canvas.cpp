@@ -430,14 +430,13 @@ void Canvas::paintEvent(QPaintEvent *)
             if (shutterFunction != NULL) {
 
                 QPoint pp = convertTimeToCanvas(*leftNode);
+                const BezierTools_sV::Polynomial &curve = m_nodes->segments()->at(i-1).bezier();
                 for (int x = pp.x(); x < p.x(); x++) {
                     qreal progressOnCurve = ((qreal)x - pp.x()) / (p.x() - pp.x());
 
                     QPointF time;
                     if (leftNode->rightCurveType() == CurveType_Bezier && rightNode->leftCurveType() == CurveType_Bezier) {
-                        time = BezierTools_sV::interpolateAtX(convertCanvasToTime(QPoint(x, 0)).x(),
-                                    leftNode->toQPointF(), leftNode->toQPointF()+leftNode->rightNodeHandle(),
-                                    rightNode->toQPointF()+rightNode->leftNodeHandle(), rightNode->toQPointF());
+                        time = BezierTools_sV::interpolateAtX(convertCanvasToTime(QPoint(x, 0)).x(), curve);
                     } else {
                         time = leftNode->toQPointF() + (rightNode->toQPointF() - leftNode->toQPointF()) * progressOnCurve;
                     }
@@ -1130,6 +1129,7 @@ void Canvas::slotResetHandle(const QString &position)
         } else {
             node->setRightNodeHandle(0, 0);
         }
+        m_nodes->updateCurves();
         emit nodesChanged();
     } else {
         qDebug() << "Object at mouse position is " << m_states.initialContextObject << ", cannot reset the handle.";
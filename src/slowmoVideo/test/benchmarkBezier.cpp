@@ -0,0 +1,97 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+/*
+  Compares solving bézier curves for x with the previous iterative search
+  and with BezierTools_sV (with and without cached coefficients).
+  Usage: BezierBenchmark [<samples>]
+*/
+
+#include "../lib/bezierTools_sV.h"
+
+#include <QtCore/QString>
+#include <QtCore/QTime>
+
+#include <cmath>
+#include <iostream>
+
+/// The previous implementation of BezierTools_sV::interpolateAtX, for reference
+QPointF searchAtX(float x, QPointF p0, QPointF p1, QPointF p2, QPointF p3)
+{
+    float delta = 1;
+    float t = 0;
+    int iterations = 10*(p3.x()-p0.x());
+
+    for (int i = 0; i < iterations; i++) {
+        float plus  = BezierTools_sV::interpolate(t+delta, p0, p1, p2, p3).x();
+        float minus = BezierTools_sV::interpolate(t-delta, p0, p1, p2, p3).x();
+        float norm  = BezierTools_sV::interpolate(t      , p0, p1, p2, p3).x();
+        if ((t+delta) <= 1 && fabs(plus-x) < fabs(norm-x)) {
+            t += delta;
+        } else if ((t-delta) >= 0 && fabs(minus-x) < fabs(norm-x)) {
+            t -= delta;
+        }
+        delta /= 2;
+    }
+    return BezierTools_sV::interpolate(t, p0, p1, p2, p3);
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 1000000;
+    if (argc > 1) {
+        n = QString(argv[1]).toInt();
+    }
+
+    // A segment of 3 seconds, as in a typical project
+    QPointF p0(0, 1);
+    QPointF p1(2, 3);
+    QPointF p2(.5, 0);
+    QPointF p3(3, 1);
+    const qreal width = p3.x() - p0.x();
+
+    QTime time;
+    double sumSearch = 0, sumDirect = 0, sumCached = 0;
+    double errSearch = 0, errDirect = 0;
+
+    time.start();
+    for (int i = 0; i < n; i++) {
+        float x = p0.x() + width*i/n;
+        QPointF p = searchAtX(x, p0, p1, p2, p3);
+        sumSearch += p.y();
+        errSearch = qMax(errSearch, fabs(p.x() - x));
+    }
+    int searchMs = time.elapsed();
+
+    time.start();
+    for (int i = 0; i < n; i++) {
+        float x = p0.x() + width*i/n;
+        QPointF p = BezierTools_sV::interpolateAtX(x, p0, p1, p2, p3);
+        sumDirect += p.y();
+        errDirect = qMax(errDirect, fabs(p.x() - x));
+    }
+    int directMs = time.elapsed();
+
+    BezierTools_sV::Polynomial curve(p0, p1, p2, p3);
+    time.start();
+    for (int i = 0; i < n; i++) {
+        float x = p0.x() + width*i/n;
+        sumCached += BezierTools_sV::interpolateAtX(x, curve).y();
+    }
+    int cachedMs = time.elapsed();
+
+    std::cout << "Samples: " << n << std::endl;
+    std::cout << "Iterative search:    " << searchMs << " ms, max x error " << errSearch << std::endl;
+    std::cout << "Solver:              " << directMs << " ms, max x error " << errDirect << std::endl;
+    std::cout << "Solver, cached poly: " << cachedMs << " ms" << std::endl;
+    std::cout << "(Checksums: " << sumSearch/n << " " << sumDirect/n << " " << sumCached/n << ")" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,445 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+/*
+  Measures the image and flow kernels of lib/ on synthetic frames and flow fields.
+  Usage: KernelBenchmark [-sizes 480p,1080p,4k] [-filter <text>] [-minTime <ms>] [-json <file>]
+
+  Each kernel is repeated until it ran for at least minTime. The JSON file uses the
+  layout of Google Benchmark, so the usual comparison tools can be used to track regressions.
+*/
+
+#include "../lib/defs_sV.hpp"
+#include "../lib/floatImage_sV.h"
+#include "../lib/flowField_sV.h"
+#include "../lib/flowRW_sV.h"
+#include "../lib/flowTools_sV.h"
+#include "../lib/intMatrix_sV.h"
+#include "../lib/interpolate_sV.h"
+#include "../lib/shutter_sV.h"
+#include "../lib/sourceField_sV.h"
+#include "../project/nodeList_sV.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+
+#include <cmath>
+#include <iostream>
+
+/// Default minimum time per kernel in ms
+#define MIN_TIME 500
+/// Upper limit for the repetitions of a kernel
+#define MAX_ITERATIONS 10000
+
+/// Synthetic input for one frame size
+struct Fixture {
+    QString name;
+    int width;
+    int height;
+    FloatImage_sV left;
+    FloatImage_sV right;
+    FloatImage_sV output;
+    FlowField_sV *forward;
+    FlowField_sV *backward;
+    QImage image;
+    std::string flowFile;
+
+    Fixture(QString name, int width, int height);
+    ~Fixture();
+};
+
+/// Measures the time between start() and stop(), summed up over the iterations
+class Stopwatch {
+public:
+    Stopwatch() : m_ns(0) {}
+    void start() { m_timer.start(); }
+    void stop() { m_ns += m_timer.nsecsElapsed(); }
+    qint64 ns() const { return m_ns; }
+private:
+    QElapsedTimer m_timer;
+    qint64 m_ns;
+};
+
+/// Discards the log output of FlowRW_sV while it exists
+class MuteStdout {
+public:
+    MuteStdout() : m_buffer(std::cout.rdbuf(NULL)) {}
+    ~MuteStdout() { std::cout.rdbuf(m_buffer); std::cout.clear(); }
+private:
+    std::streambuf *m_buffer;
+};
+
+typedef void (*Kernel)(Fixture &f, Stopwatch &watch);
+
+struct Benchmark {
+    const char *name;
+    Kernel kernel;
+    /// Kernels which do not depend on the frame size run only once
+    bool sized;
+};
+
+struct Result {
+    QString name;
+    int iterations;
+    /// Mean and minimum time per iteration in ms
+    double mean;
+    double min;
+    /// Pixels per second, 0 for kernels without frame size
+    double pixelsPerSecond;
+};
+
+Fixture::Fixture(QString name, int width, int height) :
+    name(name),
+    width(width),
+    height(height),
+    left(width, height),
+    right(width, height),
+    output(width, height)
+{
+    const float s = width/640.0f;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            float checker = ((x/16 + y/16) % 2) * .5f + .25f;
+            left.setPixel(x, y, float(x)/width, float(y)/height, checker);
+            right.setPixel(x, y, float(y)/height, float(x)/width, 1-checker);
+        }
+    }
+
+    // Two regions moving apart, which leaves holes for inpainting
+    forward = new FlowField_sV(width, height);
+    backward = new FlowField_sV(width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            float fx = (x < width/2 ? 4 : -2)*s + 2*std::sin(y*.02f);
+            float fy = 1.5f*s*std::cos(x*.015f);
+            forward->setX(x, y, fx);
+            forward->setY(x, y, fy);
+            backward->setX(x, y, -fx);
+            backward->setY(x, y, -fy);
+        }
+    }
+
+    image = left.toImage();
+    flowFile = QDir::temp().absoluteFilePath(QString("kernelBenchmark-%1.sVflow").arg(name)).toStdString();
+}
+
+Fixture::~Fixture()
+{
+    delete forward;
+    delete backward;
+    QFile(QString::fromStdString(flowFile)).remove();
+}
+
+
+void forwardFlow(Fixture &f, Stopwatch &watch)
+{
+    watch.start();
+    Interpolate_sV::forwardFlow(f.left, f.forward, .5, f.output);
+    watch.stop();
+}
+void newForwardFlow(Fixture &f, Stopwatch &watch)
+{
+    watch.start();
+    Interpolate_sV::newForwardFlow(f.left, f.forward, .5, f.output);
+    watch.stop();
+}
+void twowayFlow(Fixture &f, Stopwatch &watch)
+{
+    watch.start();
+    Interpolate_sV::twowayFlow(f.left, f.right, f.forward, f.backward, .5, f.output);
+    watch.stop();
+}
+void newTwowayFlow(Fixture &f, Stopwatch &watch)
+{
+    watch.start();
+    Interpolate_sV::newTwowayFlow(f.left, f.right, f.forward, f.backward, .5, f.output);
+    watch.stop();
+}
+void bezierFlow(Fixture &f, Stopwatch &watch)
+{
+    watch.start();
+    Interpolate_sV::bezierFlow(f.left, f.right, f.backward, f.forward, .5, f.output);
+    watch.stop();
+}
+
+void sourceFieldBuild(Fixture &f, Stopwatch &watch)
+{
+    watch.start();
+    SourceField_sV field(f.forward, .5);
+    watch.stop();
+}
+void sourceFieldInpaint(Fixture &f, Stopwatch &watch)
+{
+    SourceField_sV field(f.forward, .5);
+    watch.start();
+    field.inpaint();
+    watch.stop();
+}
+
+void shutterCombine(Fixture &f, Stopwatch &watch)
+{
+    QList<FloatImage_sV> images;
+    images << f.left << f.right << f.left;
+    watch.start();
+    FloatImage_sV sum = Shutter_sV::combine(images);
+    watch.stop();
+}
+void shutterConvolutionBlur(Fixture &f, Stopwatch &watch)
+{
+    watch.start();
+    FloatImage_sV blurred = Shutter_sV::convolutionBlur(f.left, f.forward, .5);
+    watch.stop();
+}
+
+void flowSave(Fixture &f, Stopwatch &watch)
+{
+    MuteStdout mute;
+    watch.start();
+    FlowRW_sV::save(f.flowFile, f.forward);
+    watch.stop();
+}
+void flowLoad(Fixture &f, Stopwatch &watch)
+{
+    MuteStdout mute;
+    if (!QFile(QString::fromStdString(f.flowFile)).exists()) {
+        FlowRW_sV::save(f.flowFile, f.forward);
+    }
+    watch.start();
+    FlowField_sV *field = FlowRW_sV::load(f.flowFile);
+    watch.stop();
+    delete field;
+}
+
+void flowDifference(Fixture &f, Stopwatch &watch)
+{
+    FlowField_sV out(f.width, f.height);
+    watch.start();
+    FlowTools_sV::difference(*f.forward, *f.backward, out);
+    watch.stop();
+}
+void flowSignedDifference(Fixture &f, Stopwatch &watch)
+{
+    FlowField_sV out(f.width, f.height);
+    watch.start();
+    FlowTools_sV::signedDifference(*f.forward, *f.backward, out);
+    watch.stop();
+}
+void flowMedian(Fixture &f, Stopwatch &watch)
+{
+    FlowField_sV out(f.width, f.height);
+    watch.start();
+    FlowTools_sV::median(f.forward, f.backward, f.forward, out);
+    watch.stop();
+}
+
+void intMatrixAdd(Fixture &f, Stopwatch &watch)
+{
+    IntMatrix_sV matrix(f.width, f.height, 4);
+    watch.start();
+    matrix += f.image.constBits();
+    matrix += f.image.constBits();
+    matrix /= 2;
+    watch.stop();
+}
+void intMatrixToBytes(Fixture &f, Stopwatch &watch)
+{
+    IntMatrix_sV matrix(f.width, f.height, 4);
+    matrix += f.image.constBits();
+    QImage out(f.width, f.height, QImage::Format_ARGB32);
+    watch.start();
+    matrix.toBytes(out.bits());
+    watch.stop();
+}
+
+void nodeListSourceTime(Fixture &, Stopwatch &watch)
+{
+    // A curve like in a long project: 100 nodes, every other segment is a bézier curve
+    NodeList_sV nodes(.1);
+    for (int i = 0; i < 100; i++) {
+        nodes.add(Node_sV(i, .5*i + .2*std::sin(float(i))));
+    }
+    for (int i = 0; i < 99; i += 2) {
+        nodes.setCurveType(i + .5, CurveType_Bezier);
+    }
+    const int n = 100000;
+    qreal sum = 0;
+    int hint = 0;
+    watch.start();
+    for (int i = 0; i < n; i++) {
+        sum += nodes.sourceTime(99.0*i/n, &hint);
+    }
+    watch.stop();
+    if (sum < 0) {
+        std::cout << sum << std::endl;
+    }
+}
+
+static const Benchmark benchmarks[] = {
+    { "interpolate/forward",        forwardFlow,            true },
+    { "interpolate/forwardNew",     newForwardFlow,         true },
+    { "interpolate/twoway",         twowayFlow,             true },
+    { "interpolate/twowayNew",      newTwowayFlow,          true },
+    { "interpolate/bezier",         bezierFlow,             true },
+    { "sourceField/build",          sourceFieldBuild,       true },
+    { "sourceField/inpaint",        sourceFieldInpaint,     true },
+    { "shutter/combine3",           shutterCombine,         true },
+    { "shutter/convolutionBlur",    shutterConvolutionBlur, true },
+    { "flowRW/save",                flowSave,               true },
+    { "flowRW/load",                flowLoad,               true },
+    { "flowTools/difference",       flowDifference,         true },
+    { "flowTools/signedDifference", flowSignedDifference,   true },
+    { "flowTools/median",           flowMedian,             true },
+    { "intMatrix/add",              intMatrixAdd,           true },
+    { "intMatrix/toBytes",          intMatrixToBytes,       true },
+    { "nodeList/sourceTime100k",    nodeListSourceTime,     false }
+};
+
+Result run(const Benchmark &benchmark, Fixture &f, int minTime)
+{
+    Result result;
+    result.name = benchmark.name;
+    if (benchmark.sized) {
+        result.name += "/" + f.name;
+    }
+    result.iterations = 0;
+    result.min = 0;
+
+    QElapsedTimer total;
+    Stopwatch watch;
+    total.start();
+    while (result.iterations < MAX_ITERATIONS
+           && (result.iterations == 0 || total.elapsed() < minTime)) {
+        qint64 before = watch.ns();
+        benchmark.kernel(f, watch);
+        double ms = (watch.ns()-before) / 1e6;
+        if (result.iterations == 0 || ms < result.min) {
+            result.min = ms;
+        }
+        result.iterations++;
+    }
+    result.mean = watch.ns() / 1e6 / result.iterations;
+    result.pixelsPerSecond = benchmark.sized ? f.width*f.height / (result.mean/1000) : 0;
+    return result;
+}
+
+QString toJson(const QList<Result> &results)
+{
+    QStringList entries;
+    for (int i = 0; i < results.size(); i++) {
+        const Result &r = results.at(i);
+        QString entry = QString("    {\n"
+                                "      \"name\": \"%1\",\n"
+                                "      \"iterations\": %2,\n"
+                                "      \"real_time\": %3,\n"
+                                "      \"min_time\": %4,\n"
+                                "      \"time_unit\": \"ms\"")
+                .arg(r.name).arg(r.iterations).arg(r.mean, 0, 'f', 4).arg(r.min, 0, 'f', 4);
+        if (r.pixelsPerSecond > 0) {
+            entry += QString(",\n      \"items_per_second\": %1").arg(r.pixelsPerSecond, 0, 'f', 0);
+        }
+        entries << entry + "\n    }";
+    }
+    return QString("{\n"
+                   "  \"context\": {\n"
+                   "    \"date\": \"%1\",\n"
+                   "    \"version\": \"%2\",\n"
+                   "    \"num_cpus\": %3\n"
+                   "  },\n"
+                   "  \"benchmarks\": [\n%4\n  ]\n"
+                   "}\n")
+            .arg(QDateTime::currentDateTime().toString(Qt::ISODate))
+            .arg(Version_sV::version)
+            .arg(QThread::idealThreadCount())
+            .arg(entries.join(",\n"));
+}
+
+void printHelp(const char *name)
+{
+    std::cout << name << " [-sizes 480p,1080p,4k] [-filter <text>] [-minTime <ms>] [-json <file>]" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QStringList sizes;
+    sizes << "480p" << "1080p" << "4k";
+    QString filter;
+    int minTime = MIN_TIME;
+    QString jsonFile;
+
+    for (int i = 1; i < argc; i++) {
+        QString arg(argv[i]);
+        if (i+1 < argc && arg == "-sizes") {
+            sizes = QString(argv[++i]).toLower().split(",", QString::SkipEmptyParts);
+        } else if (i+1 < argc && arg == "-filter") {
+            filter = argv[++i];
+        } else if (i+1 < argc && arg == "-minTime") {
+            minTime = QString(argv[++i]).toInt();
+        } else if (i+1 < argc && arg == "-json") {
+            jsonFile = argv[++i];
+        } else {
+            printHelp(argv[0]);
+            return -1;
+        }
+    }
+
+    const int nBenchmarks = sizeof(benchmarks)/sizeof(Benchmark);
+    QList<Result> results;
+    bool unsizedDone = false;
+
+    for (int s = 0; s < sizes.size(); s++) {
+        int width, height;
+        if (sizes.at(s) == "480p") {
+            width = 854; height = 480;
+        } else if (sizes.at(s) == "1080p") {
+            width = 1920; height = 1080;
+        } else if (sizes.at(s) == "4k") {
+            width = 3840; height = 2160;
+        } else {
+            std::cerr << "Unknown size: " << sizes.at(s).toStdString() << std::endl;
+            return -1;
+        }
+        Fixture fixture(sizes.at(s), width, height);
+
+        for (int b = 0; b < nBenchmarks; b++) {
+            if (!benchmarks[b].sized && unsizedDone) {
+                continue;
+            }
+            if (filter.length() > 0 && !QString(benchmarks[b].name).contains(filter)) {
+                continue;
+            }
+            Result r = run(benchmarks[b], fixture, minTime);
+            results << r;
+            std::cout << QString("%1 %2 ms/it (min %3 ms, %4 iterations)")
+                         .arg(r.name, -40).arg(r.mean, 10, 'f', 3).arg(r.min, 0, 'f', 3).arg(r.iterations)
+                         .toStdString();
+            if (r.pixelsPerSecond > 0) {
+                std::cout << ", " << QString::number(r.pixelsPerSecond/1e6, 'f', 1).toStdString() << " MPixel/s";
+            }
+            std::cout << std::endl;
+        }
+        unsizedDone = true;
+    }
+
+    if (jsonFile.length() > 0) {
+        QFile file(jsonFile);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::cerr << "Could not write to " << jsonFile.toStdString() << std::endl;
+            return -1;
+        }
+        file.write(toJson(results).toUtf8());
+        std::cout << "Results written to " << jsonFile.toStdString() << std::endl;
+    }
+
+    return 0;
+}
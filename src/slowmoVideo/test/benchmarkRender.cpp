@@ -0,0 +1,382 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+/*
+  Renders a generated project with each interpolation and motion blur type
+  and reports the rendered frames per second and the peak memory usage.
+  Usage: RenderBenchmark [-size <width>x<height>] [-frames <n>] [-dir <projectDir>]
+                         [-interpolation forward,forward2,twoway,twoway2,bezier]
+                         [-motionblur stack,convolve,nearest] [-json <file>]
+
+  The project consists of an image sequence with a moving pattern, optical flow
+  which matches the movement (so no flow builder is needed), and a curve with
+  slow motion, bézier and fast segments and a shutter function.
+*/
+
+#include "../lib/defs_sV.hpp"
+#include "../lib/flowField_sV.h"
+#include "../lib/flowRW_sV.h"
+#include "../project/project_sV.h"
+#include "../project/abstractFlowSource_sV.h"
+#include "../project/abstractRenderTarget_sV.h"
+#include "../project/imagesFrameSource_sV.h"
+#include "../project/renderTask_sV.h"
+#include "../project/shutterFunction_sV.h"
+#include "../project/shutterFunctionList_sV.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+
+#include <cmath>
+#include <iostream>
+
+#if !defined(WINDOWS) && !defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+/// Counts and discards the rendered frames
+class NullRenderTarget : public AbstractRenderTarget_sV
+{
+public:
+    NullRenderTarget(RenderTask_sV *task) : AbstractRenderTarget_sV(task), frames(0) {}
+    void slotConsumeFrame(const QImage &, const int) { frames++; }
+    int frames;
+};
+
+struct Result {
+    QString name;
+    int frames;
+    double seconds;
+    /// Peak resident set size in KiB, 0 if unknown
+    long peakRss;
+};
+
+/// Centre of the moving disc at frame t
+static QPointF discCentre(float t, int width, int height)
+{
+    return QPointF(width/2 + width/4*std::cos(t*.2), height/2 + height/4*std::sin(t*.2));
+}
+
+/// Background movement per frame
+static QPointF backgroundSpeed(int width)
+{
+    return QPointF(width/320.0, width/640.0);
+}
+
+static bool inDisc(float x, float y, QPointF centre, int height)
+{
+    const float r = height/5.0f;
+    return (x-centre.x())*(x-centre.x()) + (y-centre.y())*(y-centre.y()) < r*r;
+}
+
+QImage generateFrame(int t, int width, int height)
+{
+    QImage img(width, height, QImage::Format_RGB32);
+    QPointF centre = discCentre(t, width, height);
+    QPointF offset = backgroundSpeed(width) * t;
+    for (int y = 0; y < height; y++) {
+        QRgb *line = (QRgb*) img.scanLine(y);
+        for (int x = 0; x < width; x++) {
+            if (inDisc(x, y, centre, height)) {
+                float angle = std::atan2(y-centre.y(), x-centre.x());
+                int stripe = int(std::floor(angle*6/M_PI)) & 1;
+                line[x] = stripe ? qRgb(230, 80, 40) : qRgb(250, 220, 60);
+            } else {
+                int cx = int(std::floor((x - offset.x())/32));
+                int cy = int(std::floor((y - offset.y())/32));
+                int shade = ((cx + cy) & 1) ? 60 : 180;
+                line[x] = qRgb(shade, shade + 255*y/height/4, shade + 255*x/width/4);
+            }
+        }
+    }
+    return img;
+}
+
+/// Flow from frame \c from to the neighbouring frame \c to, matching generateFrame()
+FlowField_sV* generateFlow(int from, int to, int width, int height)
+{
+    FlowField_sV *flow = new FlowField_sV(width, height);
+    QPointF centre = discCentre(from, width, height);
+    QPointF disc = discCentre(to, width, height) - centre;
+    QPointF background = backgroundSpeed(width) * (to-from);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            QPointF v = inDisc(x, y, centre, height) ? disc : background;
+            flow->setX(x, y, v.x());
+            flow->setY(x, y, v.y());
+        }
+    }
+    return flow;
+}
+
+/// Creates the input frames and the project with flow files
+Project_sV* generateProject(QDir dir, int width, int height, int frames) throw(FrameSourceError)
+{
+    dir.mkpath("input");
+    QStringList images;
+    for (int t = 0; t < frames; t++) {
+        QString path = dir.absoluteFilePath(QString("input/frame%1.png").arg(t, 5, 10, QChar('0')));
+        if (!QFile(path).exists()) {
+            generateFrame(t, width, height).save(path);
+        }
+        images << path;
+    }
+
+    Project_sV *project = new Project_sV(dir.absoluteFilePath("project"));
+    project->loadFrameSource(new ImagesFrameSource_sV(project, images));
+
+    for (int t = 0; t+1 < frames; t++) {
+        for (int d = 0; d < 2; d++) {
+            int from = (d == 0) ? t : t+1;
+            int to = (d == 0) ? t+1 : t;
+            std::string path = project->flowSource()->flowPath(from, to, FrameSize_Orig).toStdString();
+            if (!QFile(QString::fromStdString(path)).exists()) {
+                FlowField_sV *flow = generateFlow(from, to, width, height);
+                FlowRW_sV::save(path, flow);
+                delete flow;
+            }
+        }
+    }
+
+    // Slow motion, a bézier segment, and a fast segment, all with a 360° shutter
+    const qreal s = (frames-1) / project->frameSource()->fps()->fps();
+    NodeList_sV *nodes = project->nodes();
+    nodes->add(Node_sV(0, 0));
+    nodes->add(Node_sV(1.0*s, .25*s));
+    nodes->add(Node_sV(2.0*s, .6*s));
+    nodes->add(Node_sV(2.25*s, s));
+    nodes->setCurveType(1.5*s, CurveType_Bezier);
+    (*nodes)[1].setRightNodeHandle(.3*s, .02*s);
+    (*nodes)[2].setLeftNodeHandle(-.3*s, -.05*s);
+    nodes->updateCurves();
+
+    ShutterFunction_sV *shutter = project->shutterFunctions()->addFunction(ShutterFunction_sV("return dy;"), true);
+    for (int i = 0; i < nodes->size(); i++) {
+        (*nodes)[i].setShutterFunctionID(shutter->id());
+    }
+    return project;
+}
+
+/// Removes cached interpolated frames, so each run starts with the same state
+void clearRenderCache(Project_sV *project)
+{
+    QDir dir = project->getDirectory("cache/motionBlurOrig");
+    QStringList files = dir.entryList(QDir::Files);
+    for (int i = 0; i < files.size(); i++) {
+        dir.remove(files.at(i));
+    }
+}
+
+/// Resets the peak memory usage of the process, if supported
+void resetPeakRss()
+{
+#ifdef __linux__
+    QFile file("/proc/self/clear_refs");
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write("5");
+    }
+#endif
+}
+
+/// \return Peak resident set size in KiB; on systems without reset this is the peak of the whole process.
+long peakRss()
+{
+#if defined(__linux__)
+    QFile file("/proc/self/status");
+    if (file.open(QIODevice::ReadOnly)) {
+        QTextStream in(&file);
+        QString line;
+        while (!(line = in.readLine()).isNull()) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(" ").first().toLong();
+            }
+        }
+    }
+    return 0;
+#elif defined(WINDOWS)
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+Result render(Project_sV *project, InterpolationType interpolation, MotionblurType motionblur, QString name)
+{
+    clearRenderCache(project);
+
+    RenderTask_sV *task = new RenderTask_sV(project);
+    project->replaceRenderTask(task);
+    task->renderPreferences().setFps(Fps_sV(24, 1));
+    task->renderPreferences().size = FrameSize_Orig;
+    task->renderPreferences().interpolation = interpolation;
+    task->renderPreferences().motionblur = motionblur;
+    task->setTimeRange(project->nodes()->startTime(), project->nodes()->endTime());
+    // Renders all frames within slotContinueRendering()
+    task->setQtConnectionType(Qt::DirectConnection);
+    NullRenderTarget *target = new NullRenderTarget(task);
+    task->setRenderTarget(target);
+
+    resetPeakRss();
+    QElapsedTimer timer;
+    timer.start();
+    task->slotContinueRendering();
+
+    Result result;
+    result.name = name;
+    result.seconds = timer.nsecsElapsed() / 1e9;
+    result.frames = target->frames;
+    result.peakRss = peakRss();
+    return result;
+}
+
+QString toJson(const QList<Result> &results, QSize size, int frames)
+{
+    QStringList entries;
+    for (int i = 0; i < results.size(); i++) {
+        const Result &r = results.at(i);
+        entries << QString("    {\"name\": \"%1\", \"frames\": %2, \"seconds\": %3, \"fps\": %4, \"peak_rss_kib\": %5}")
+                   .arg(r.name).arg(r.frames).arg(r.seconds, 0, 'f', 3)
+                   .arg(r.frames / r.seconds, 0, 'f', 3).arg(r.peakRss);
+    }
+    return QString("{\n"
+                   "  \"context\": {\"date\": \"%1\", \"version\": \"%2\", \"num_cpus\": %3, "
+                   "\"width\": %4, \"height\": %5, \"input_frames\": %6},\n"
+                   "  \"renders\": [\n%7\n  ]\n"
+                   "}\n")
+            .arg(QDateTime::currentDateTime().toString(Qt::ISODate)).arg(Version_sV::version)
+            .arg(QThread::idealThreadCount())
+            .arg(size.width()).arg(size.height()).arg(frames)
+            .arg(entries.join(",\n"));
+}
+
+void printHelp(QString name)
+{
+    std::cout << name.toStdString() << " [-size <width>x<height>] [-frames <n>] [-dir <projectDir>]" << std::endl
+              << "\t[-interpolation forward,forward2,twoway,twoway2,bezier]" << std::endl
+              << "\t[-motionblur stack,convolve,nearest] [-json <file>]" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+
+    QSize size(640, 360);
+    int frames = 24;
+    QString dir = QDir::temp().absoluteFilePath("slowmoRenderBenchmark");
+    QStringList interpolations = QString("forward,forward2,twoway,twoway2,bezier").split(",");
+    QStringList motionblurs = QString("stack,convolve,nearest").split(",");
+    QString jsonFile;
+
+    for (int i = 1; i < args.size(); i++) {
+        if (i+1 < args.size() && args.at(i) == "-size") {
+            QStringList wh = args.at(++i).split("x");
+            if (wh.size() == 2) {
+                size = QSize(wh.at(0).toInt(), wh.at(1).toInt());
+            }
+        } else if (i+1 < args.size() && args.at(i) == "-frames") {
+            frames = args.at(++i).toInt();
+        } else if (i+1 < args.size() && args.at(i) == "-dir") {
+            dir = args.at(++i);
+        } else if (i+1 < args.size() && args.at(i) == "-interpolation") {
+            interpolations = args.at(++i).split(",", QString::SkipEmptyParts);
+        } else if (i+1 < args.size() && args.at(i) == "-motionblur") {
+            motionblurs = args.at(++i).split(",", QString::SkipEmptyParts);
+        } else if (i+1 < args.size() && args.at(i) == "-json") {
+            jsonFile = args.at(++i);
+        } else {
+            printHelp(args.at(0));
+            return -1;
+        }
+    }
+    if (size.isEmpty() || frames < 3) {
+        std::cerr << "At least 3 frames with a valid size are required." << std::endl;
+        return -1;
+    }
+
+    Project_sV *project;
+    try {
+        // The directory depends on the input, so frames and flow are re-used by later runs.
+        QDir projectDir(QString("%1/%2x%3-%4").arg(dir).arg(size.width()).arg(size.height()).arg(frames));
+        std::cout << "Generating project in " << projectDir.absolutePath().toStdString() << std::endl;
+        project = generateProject(projectDir, size.width(), size.height(), frames);
+    } catch (FrameSourceError &err) {
+        std::cerr << "Could not create the project: " << err.message().toStdString() << std::endl;
+        return -1;
+    }
+
+    QList<Result> results;
+    for (int i = 0; i < interpolations.size(); i++) {
+        InterpolationType interpolation;
+        const QString ip = interpolations.at(i);
+        if (ip == "forward") {
+            interpolation = InterpolationType_Forward;
+        } else if (ip == "forward2") {
+            interpolation = InterpolationType_ForwardNew;
+        } else if (ip == "twoway") {
+            interpolation = InterpolationType_Twoway;
+        } else if (ip == "twoway2") {
+            interpolation = InterpolationType_TwowayNew;
+        } else if (ip == "bezier") {
+            interpolation = InterpolationType_Bezier;
+        } else {
+            std::cerr << "Not a valid interpolation type: " << ip.toStdString() << std::endl;
+            return -1;
+        }
+
+        for (int m = 0; m < motionblurs.size(); m++) {
+            MotionblurType motionblur;
+            const QString mb = motionblurs.at(m);
+            if (mb == "stack") {
+                motionblur = MotionblurType_Stacking;
+            } else if (mb == "convolve") {
+                motionblur = MotionblurType_Convolving;
+            } else if (mb == "nearest") {
+                motionblur = MotionblurType_Nearest;
+            } else {
+                std::cerr << "Not a valid motion blur type: " << mb.toStdString() << std::endl;
+                return -1;
+            }
+
+            Result r = render(project, interpolation, motionblur, ip + "/" + mb);
+            results << r;
+            std::cout << QString("%1 %2 frames in %3 s, %4 frames/s, peak RSS %5 MiB")
+                         .arg(r.name, -20).arg(r.frames).arg(r.seconds, 0, 'f', 2)
+                         .arg(r.frames / r.seconds, 0, 'f', 2).arg(r.peakRss / 1024)
+                         .toStdString() << std::endl;
+        }
+    }
+
+    delete project;
+
+    if (jsonFile.length() > 0) {
+        QFile file(jsonFile);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::cerr << "Could not write to " << jsonFile.toStdString() << std::endl;
+            return -1;
+        }
+        file.write(toJson(results, size, frames).toUtf8());
+        std::cout << "Results written to " << jsonFile.toStdString() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+/*
+  Compares evaluating shutter functions natively and with QtScript.
+  Usage: ShutterBenchmark [<evaluations>]
+*/
+
+#include "../project/shutterFunction_sV.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QStringList>
+#include <QtCore/QTime>
+
+#include <iostream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int n = 100000;
+    if (argc > 1) {
+        n = QString(argv[1]).toInt();
+    }
+
+    QStringList functions;
+    functions << "return 0;"
+              << "return Math.sin(x*Math.PI);"
+              << "var dx = 1/fps; \n"
+                 "var speed = dy/dx;\n"
+                 "if (speed < 1) { speed = 0; }\n"
+                 "return speed;";
+
+    std::cout << "Evaluations per function: " << n << std::endl;
+    for (int i = 0; i < functions.size(); i++) {
+        ShutterFunction_sV f(functions.at(i));
+
+        QTime time;
+        float sum = 0;
+
+        time.start();
+        for (int k = 0; k < n; k++) {
+            sum += f.evaluateScript(float(k)/n, k/24.0, 24, k/30.0, 1/30.0);
+        }
+        int scriptMs = time.elapsed();
+
+        time.start();
+        for (int k = 0; k < n; k++) {
+            sum -= f.evaluate(float(k)/n, k/24.0, 24, k/30.0, 1/30.0);
+        }
+        int nativeMs = time.elapsed();
+
+        std::cout << "Function " << i << (f.isNative() ? " (native)" : " (QtScript only)") << ": "
+                  << "QtScript " << scriptMs << " ms, native " << nativeMs << " ms";
+        if (nativeMs > 0) {
+            std::cout << ", speedup " << float(scriptMs)/nativeMs;
+        }
+        std::cout << " (difference: " << sum << ")" << std::endl;
+    }
+
+    return 0;
+}
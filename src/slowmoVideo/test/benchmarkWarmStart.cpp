@@ -0,0 +1,252 @@
+/*
+This file is part of slowmoVideo.
+Copyright (C) 2011  Simon A. Eugster (Granjow)  <simon.eu@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+/*
+  Builds the forward flow of all frame pairs of an image sequence twice, once from
+  scratch for each pair and once initialised with the flow of the previous pair,
+  and compares the time and quality.
+  Usage: FlowWarmStartBenchmark [-dir <workDir>] [-lambda <lambda>] [-json <file>] <image> <image> [<image> ...]
+
+  The flow method is the one selected in the preferences. Quality is measured as the
+  mean absolute grey value difference between the left frame and the right frame
+  warped back with the flow; the endpoint difference tells how far the warm started
+  flow is from the one built from scratch.
+*/
+
+#include "../lib/defs_sV.hpp"
+#include "../lib/flowField_sV.h"
+#include "../project/project_sV.h"
+#include "../project/projectPreferences_sV.h"
+#include "../project/abstractFlowSource_sV.h"
+#include "../project/cacheManager_sV.h"
+#include "../project/imagesFrameSource_sV.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtGui/QImage>
+
+#include <cmath>
+#include <iostream>
+
+struct PairResult {
+    double coldMs;
+    double warmMs;
+    float coldError;
+    float warmError;
+    /// Mean endpoint distance between the warm started and the cold flow
+    float endpointDiff;
+};
+
+/// Bilinearly interpolated grey value, clamped at the border
+static float grey(const QImage &img, float x, float y)
+{
+    x = qBound(0.0f, x, float(img.width()-1));
+    y = qBound(0.0f, y, float(img.height()-1));
+    int x0 = int(x), y0 = int(y);
+    int x1 = qMin(x0+1, img.width()-1);
+    int y1 = qMin(y0+1, img.height()-1);
+    float dx = x-x0, dy = y-y0;
+    return (1-dx)*(1-dy)*qGray(img.pixel(x0, y0)) + dx*(1-dy)*qGray(img.pixel(x1, y0))
+            + (1-dx)*dy*qGray(img.pixel(x0, y1)) + dx*dy*qGray(img.pixel(x1, y1));
+}
+
+/// Mean absolute difference between \c left and \c right warped back along \c flow
+float warpError(const QImage &left, const QImage &right, FlowField_sV *flow)
+{
+    double sum = 0;
+    for (int y = 0; y < flow->height(); y++) {
+        for (int x = 0; x < flow->width(); x++) {
+            sum += std::fabs(qGray(left.pixel(x, y)) - grey(right, x + flow->x(x, y), y + flow->y(x, y)));
+        }
+    }
+    return sum / (flow->width() * flow->height());
+}
+
+float endpointDifference(FlowField_sV *a, FlowField_sV *b)
+{
+    double sum = 0;
+    for (int y = 0; y < a->height(); y++) {
+        for (int x = 0; x < a->width(); x++) {
+            float dx = a->x(x, y) - b->x(x, y);
+            float dy = a->y(x, y) - b->y(x, y);
+            sum += std::sqrt(dx*dx + dy*dy);
+        }
+    }
+    return sum / (a->width() * a->height());
+}
+
+/// Project with an empty cache, so all flow fields are built again
+Project_sV* createProject(QDir dir, QStringList images, float lambda, bool warmStart) throw(FrameSourceError)
+{
+    Project_sV *project = new Project_sV(dir.absolutePath());
+    project->loadFrameSource(new ImagesFrameSource_sV(project, images));
+    project->preferences()->flowV3DLambda() = lambda;
+    project->preferences()->flowWarmStart() = warmStart;
+
+    // Not only the flow of the measured size: cached flow of the small frames
+    // (used to initialise the full size flow) would make the cold run warm as well.
+    QStringList dirs = CacheManager_sV::evictableDirectories();
+    for (int d = 0; d < dirs.size(); d++) {
+        QDir cacheDir = project->getDirectory(dirs.at(d), false);
+        QStringList files = cacheDir.entryList(QDir::Files);
+        for (int i = 0; i < files.size(); i++) {
+            cacheDir.remove(files.at(i));
+        }
+    }
+    return project;
+}
+
+/// Builds the flow from \c frame to the next frame and measures the time in ms
+FlowField_sV* buildFlow(Project_sV *project, int frame, double &ms) throw(FlowBuildingError)
+{
+    QElapsedTimer timer;
+    timer.start();
+    FlowField_sV *flow = project->requestFlow(frame, frame+1, FrameSize_Orig);
+    ms = timer.nsecsElapsed() / 1e6;
+    return flow;
+}
+
+QString toJson(const QList<PairResult> &results, float lambda)
+{
+    QStringList entries;
+    for (int i = 0; i < results.size(); i++) {
+        const PairResult &r = results.at(i);
+        entries << QString("    {\"pair\": %1, \"cold_ms\": %2, \"warm_ms\": %3, \"cold_error\": %4, "
+                           "\"warm_error\": %5, \"endpoint_diff\": %6}")
+                   .arg(i).arg(r.coldMs, 0, 'f', 1).arg(r.warmMs, 0, 'f', 1)
+                   .arg(r.coldError, 0, 'f', 4).arg(r.warmError, 0, 'f', 4).arg(r.endpointDiff, 0, 'f', 4);
+    }
+    return QString("{\n"
+                   "  \"context\": {\"date\": \"%1\", \"version\": \"%2\", \"num_cpus\": %3, \"lambda\": %4},\n"
+                   "  \"pairs\": [\n%5\n  ]\n"
+                   "}\n")
+            .arg(QDateTime::currentDateTime().toString(Qt::ISODate)).arg(Version_sV::version)
+            .arg(QThread::idealThreadCount()).arg(lambda)
+            .arg(entries.join(",\n"));
+}
+
+void printHelp(QString name)
+{
+    std::cout << name.toStdString() << " [-dir <workDir>] [-lambda <lambda>] [-json <file>] "
+              << "<image> <image> [<image> ...]" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+
+    QString dir = QDir::temp().absoluteFilePath("slowmoWarmStartBenchmark");
+    float lambda = 20;
+    QString jsonFile;
+    QStringList images;
+
+    for (int i = 1; i < args.size(); i++) {
+        if (i+1 < args.size() && args.at(i) == "-dir") {
+            dir = args.at(++i);
+        } else if (i+1 < args.size() && args.at(i) == "-lambda") {
+            lambda = args.at(++i).toFloat();
+        } else if (i+1 < args.size() && args.at(i) == "-json") {
+            jsonFile = args.at(++i);
+        } else if (args.at(i).startsWith("-")) {
+            printHelp(args.at(0));
+            return -1;
+        } else {
+            images << QFileInfo(args.at(i)).absoluteFilePath();
+        }
+    }
+    if (images.size() < 3) {
+        std::cerr << "At least 3 images are required." << std::endl;
+        printHelp(args.at(0));
+        return -1;
+    }
+
+    Project_sV *cold;
+    Project_sV *warm;
+    try {
+        cold = createProject(QDir(dir + "/cold"), images, lambda, false);
+        warm = createProject(QDir(dir + "/warm"), images, lambda, true);
+    } catch (FrameSourceError &err) {
+        std::cerr << "Could not create the projects: " << err.message().toStdString() << std::endl;
+        return -1;
+    }
+
+    QList<PairResult> results;
+    double coldTotal = 0, warmTotal = 0;
+    double coldErrorTotal = 0, warmErrorTotal = 0, endpointTotal = 0;
+
+    std::cout << QString("%1 %2 %3 %4 %5 %6")
+                 .arg("pair", 5).arg("cold ms", 10).arg("warm ms", 10)
+                 .arg("cold err", 10).arg("warm err", 10).arg("EPE diff", 10).toStdString() << std::endl;
+    for (int t = 0; t+1 < images.size(); t++) {
+        PairResult r;
+        FlowField_sV *coldFlow;
+        FlowField_sV *warmFlow;
+        try {
+            coldFlow = buildFlow(cold, t, r.coldMs);
+            warmFlow = buildFlow(warm, t, r.warmMs);
+        } catch (FlowBuildingError &err) {
+            std::cerr << "Could not build the flow: " << err.message().toStdString() << std::endl;
+            return -1;
+        }
+
+        QImage left = cold->frameSource()->frameAt(t, FrameSize_Orig);
+        QImage right = cold->frameSource()->frameAt(t+1, FrameSize_Orig);
+        r.coldError = warpError(left, right, coldFlow);
+        r.warmError = warpError(left, right, warmFlow);
+        r.endpointDiff = endpointDifference(warmFlow, coldFlow);
+        delete coldFlow;
+        delete warmFlow;
+
+        // The first pair has no neighbour to start from.
+        if (t > 0) {
+            coldTotal += r.coldMs;
+            warmTotal += r.warmMs;
+        }
+        coldErrorTotal += r.coldError;
+        warmErrorTotal += r.warmError;
+        endpointTotal += r.endpointDiff;
+        results << r;
+
+        std::cout << QString("%1 %2 %3 %4 %5 %6")
+                     .arg(t, 5).arg(r.coldMs, 10, 'f', 1).arg(r.warmMs, 10, 'f', 1)
+                     .arg(r.coldError, 10, 'f', 3).arg(r.warmError, 10, 'f', 3).arg(r.endpointDiff, 10, 'f', 3)
+                     .toStdString() << std::endl;
+    }
+
+    const int n = results.size();
+    std::cout << QString("Without the first pair: %1 ms cold, %2 ms warm, speedup %3x")
+                 .arg(coldTotal, 0, 'f', 1).arg(warmTotal, 0, 'f', 1)
+                 .arg(warmTotal > 0 ? coldTotal / warmTotal : 0, 0, 'f', 2).toStdString() << std::endl;
+    std::cout << QString("Mean warp error %1 cold, %2 warm; mean endpoint difference %3 px")
+                 .arg(coldErrorTotal / n, 0, 'f', 3).arg(warmErrorTotal / n, 0, 'f', 3)
+                 .arg(endpointTotal / n, 0, 'f', 3).toStdString() << std::endl;
+
+    delete cold;
+    delete warm;
+
+    if (jsonFile.length() > 0) {
+        QFile file(jsonFile);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::cerr << "Could not write to " << jsonFile.toStdString() << std::endl;
+            return -1;
+        }
+        file.write(toJson(results, lambda).toUtf8());
+        std::cout << "Results written to " << jsonFile.toStdString() << std::endl;
+    }
+
+    return 0;
+}
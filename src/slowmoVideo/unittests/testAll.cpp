@@ -7,6 +7,17 @@
 #include "testShutterFunction_sV.h"
 #include "testProject_sV.h"
 #include "testNodeList_sV.h"
+#include "testCacheKey_sV.h"
+#include "testCacheManager_sV.h"
+#include "testRenderPlan_sV.h"
+#include "testBezierTools_sV.h"
+#include "testFrameQueue_sV.h"
+#include "testImagesRenderTarget_sV.h"
+#include "testFloatImage_sV.h"
+#include "testBufferPool_sV.h"
+#include "testProfiler_sV.h"
+#include "testCpuPyramid.h"
+#include "testConsistencyMap_sV.h"
 
 #include <QtTest/QtTest>
 
@@ -38,4 +49,37 @@ int main()
 
     TestNodeList_sV nodes;
     QTest::qExec(&nodes);
+
+    TestCacheKey_sV cacheKey;
+    QTest::qExec(&cacheKey);
+
+    TestCacheManager_sV cacheManager;
+    QTest::qExec(&cacheManager);
+
+    TestRenderPlan_sV renderPlan;
+    QTest::qExec(&renderPlan);
+
+    TestBezierTools_sV bezier;
+    QTest::qExec(&bezier);
+
+    TestFrameQueue_sV frameQueue;
+    QTest::qExec(&frameQueue);
+
+    TestImagesRenderTarget_sV imagesTarget;
+    QTest::qExec(&imagesTarget);
+
+    TestFloatImage_sV floatImage;
+    QTest::qExec(&floatImage);
+
+    TestBufferPool_sV bufferPool;
+    QTest::qExec(&bufferPool);
+
+    TestProfiler_sV profiler;
+    QTest::qExec(&profiler);
+
+    TestCpuPyramid pyramid;
+    QTest::qExec(&pyramid);
+
+    TestConsistencyMap_sV consistency;
+    QTest::qExec(&consistency);
 }
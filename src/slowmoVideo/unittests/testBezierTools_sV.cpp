@@ -0,0 +1,69 @@
+#include "testBezierTools_sV.h"
+
+#include "../lib/bezierTools_sV.h"
+
+void TestBezierTools_sV::testSolveT()
+{
+    QPointF p0(0, 1);
+    QPointF p1(2, 3);
+    QPointF p2(0, 0);
+    QPointF p3(3, 1);
+    BezierTools_sV::Polynomial curve(p0, p1, p2, p3);
+
+    for (int i = 0; i <= 300; i++) {
+        qreal x = i/100.0;
+        qreal t = curve.solveT(x);
+        QVERIFY(t >= 0 && t <= 1);
+        QVERIFY(fabs(curve.at(t).x() - x) < 1e-9);
+    }
+
+    // Short segment (fails with a fixed number of iterations per x unit)
+    curve = BezierTools_sV::Polynomial(QPointF(1, 1), QPointF(1.01, 1.5), QPointF(1.02, 2), QPointF(1.03, 2));
+    for (int i = 0; i <= 30; i++) {
+        qreal x = 1 + i/1000.0;
+        QVERIFY(fabs(BezierTools_sV::interpolateAtX(x, curve).x() - x) < 1e-6);
+    }
+}
+
+void TestBezierTools_sV::testBoundaries()
+{
+    QPointF p0(1, 0);
+    QPointF p1(1.5, 2);
+    QPointF p2(2, 2);
+    QPointF p3(3, 1);
+    QCOMPARE(BezierTools_sV::interpolateAtX(1, p0, p1, p2, p3), p0);
+    QCOMPARE(BezierTools_sV::interpolateAtX(3, p0, p1, p2, p3), p3);
+    QCOMPARE(BezierTools_sV::interpolateAtX(0, p0, p1, p2, p3), p0);
+    QCOMPARE(BezierTools_sV::interpolateAtX(4, p0, p1, p2, p3), p3);
+
+    // Handles at 1/3 and 2/3 make x linear in t
+    BezierTools_sV::Polynomial linear(QPointF(0, 0), QPointF(1, 5), QPointF(2, 5), QPointF(3, 0));
+    QVERIFY(fabs(linear.solveT(1.5) - .5) < 1e-12);
+}
+
+void TestBezierTools_sV::testPolynomial()
+{
+    QPointF p0(0, 1);
+    QPointF p1(2, 3);
+    QPointF p2(.5, 0);
+    QPointF p3(3, 1);
+    BezierTools_sV::Polynomial curve(p0, p1, p2, p3);
+    for (int i = 0; i <= 10; i++) {
+        QPointF a = curve.at(i/10.0);
+        QPointF b = BezierTools_sV::interpolate(i/10.0, p0, p1, p2, p3);
+        QVERIFY(fabs(a.x() - b.x()) < 1e-5);
+        QVERIFY(fabs(a.y() - b.y()) < 1e-5);
+    }
+}
+
+void TestBezierTools_sV::testMatches()
+{
+    QPointF p0(0, 1);
+    QPointF p1(2, 3);
+    QPointF p2(.5, 0);
+    QPointF p3(3, 1);
+    BezierTools_sV::Polynomial curve(p0, p1, p2, p3);
+    QVERIFY(curve.matches(p0, p1, p2, p3));
+    QVERIFY(!curve.matches(p0, p1, p2, QPointF(3, 1.0001)));
+    QVERIFY(!BezierTools_sV::Polynomial().matches(p0, p1, p2, p3));
+}
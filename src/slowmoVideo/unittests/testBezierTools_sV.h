@@ -0,0 +1,18 @@
+#ifndef TESTBEZIERTOOLS_SV_H
+#define TESTBEZIERTOOLS_SV_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestBezierTools_sV : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSolveT();
+    void testBoundaries();
+    void testPolynomial();
+    void testMatches();
+};
+
+#endif // TESTBEZIERTOOLS_SV_H
@@ -0,0 +1,78 @@
+#include "testBufferPool_sV.h"
+
+#include "../lib/bufferPool_sV.h"
+#include "../lib/floatImage_sV.h"
+
+#define LARGE (1024*1024)
+
+void TestBufferPool_sV::testReuse()
+{
+    BufferPool_sV pool;
+    void *a = pool.acquire(LARGE);
+    void *b = pool.acquire(LARGE);
+    QVERIFY(a != b);
+    pool.release(a, LARGE);
+    pool.release(b, LARGE);
+    QCOMPARE(pool.counters().allocations, 2L);
+    QCOMPARE(pool.counters().bytesPooled, size_t(2*LARGE));
+
+    // Only buffers of the same size are returned
+    void *c = pool.acquire(LARGE);
+    QVERIFY(c == a || c == b);
+    void *d = pool.acquire(2*LARGE);
+    QCOMPARE(pool.counters().reuses, 1L);
+    QCOMPARE(pool.counters().allocations, 3L);
+    QCOMPARE(pool.counters().bytesPooled, size_t(LARGE));
+    QCOMPARE(pool.counters().peakBytesPooled, size_t(2*LARGE));
+
+    pool.release(c, LARGE);
+    pool.release(d, 2*LARGE);
+}
+
+void TestBufferPool_sV::testSmallBuffers()
+{
+    BufferPool_sV pool;
+    void *a = pool.acquire(100);
+    pool.release(a, 100);
+    a = pool.acquire(100);
+    pool.release(a, 100);
+    QCOMPARE(pool.counters().allocations, 0L);
+    QCOMPARE(pool.counters().reuses, 0L);
+    QCOMPARE(pool.counters().bytesPooled, size_t(0));
+}
+
+void TestBufferPool_sV::testTrim()
+{
+    BufferPool_sV pool;
+    void *a = pool.acquire(LARGE);
+    void *b = pool.acquire(2*LARGE);
+    pool.release(a, LARGE);
+    pool.release(b, 2*LARGE);
+    pool.endFrame();
+
+    // Buffers used in each frame stay in the pool
+    for (int i = 0; i < 5; i++) {
+        a = pool.acquire(LARGE);
+        pool.release(a, LARGE);
+        pool.endFrame();
+    }
+    QCOMPARE(pool.counters().trimmed, 1L);
+    QCOMPARE(pool.counters().bytesPooled, size_t(LARGE));
+    QCOMPARE(pool.counters().reuses, 5L);
+
+    pool.clear();
+    QCOMPARE(pool.counters().bytesPooled, size_t(0));
+}
+
+void TestBufferPool_sV::testFloatImage()
+{
+    BufferPool_sV *pool = BufferPool_sV::instance();
+    pool->clear();
+    long reuses = pool->counters().reuses;
+    for (int i = 0; i < 3; i++) {
+        FloatImage_sV img(640, 480);
+        img.fill(0, 0, 0);
+    }
+    QCOMPARE(pool->counters().reuses, reuses + 2);
+    pool->clear();
+}
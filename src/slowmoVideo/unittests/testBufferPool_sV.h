@@ -0,0 +1,17 @@
+#ifndef TESTBUFFERPOOL_SV_H
+#define TESTBUFFERPOOL_SV_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestBufferPool_sV : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testReuse();
+    void testSmallBuffers();
+    void testTrim();
+    void testFloatImage();
+};
+
+#endif // TESTBUFFERPOOL_SV_H
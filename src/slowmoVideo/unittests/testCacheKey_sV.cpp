@@ -0,0 +1,39 @@
+#include "testCacheKey_sV.h"
+
+#include "../project/cacheKey_sV.h"
+
+void TestCacheKey_sV::testEqualInputs()
+{
+    CacheKey_sV a, b;
+    a.add("pos", "1.250").add("size", "Small");
+    b.add("pos", "1.250").add("size", "Small");
+    QCOMPARE(a.hash(), b.hash());
+    QCOMPARE(a.fileName("cached", "png"), QString("cached-%1.png").arg(a.hash()));
+    QCOMPARE(a.description(), QString("pos=1.250;size=Small"));
+}
+
+void TestCacheKey_sV::testDifferentInputs()
+{
+    CacheKey_sV a, b, c;
+    a.add("pos", "1.250").add("lambda", "10.00");
+    b.add("pos", "1.250").add("lambda", "5.00");
+    c.add("lambda", "10.00").add("pos", "1.250");
+    QVERIFY(a.hash() != b.hash());
+    QVERIFY(a.hash() != c.hash());
+}
+
+void TestCacheKey_sV::testManifest()
+{
+    QDir dir(QDir::temp().absoluteFilePath("unittestCacheKey_sV"));
+    dir.mkpath(".");
+    QFile::remove(dir.absoluteFilePath(CacheKey_sV::manifestName));
+
+    CacheKey_sV key;
+    key.add("pos", "2.500");
+    QVERIFY(key.writeManifestEntry(dir, key.fileName("cached", "png")));
+
+    QFile manifest(dir.absoluteFilePath(CacheKey_sV::manifestName));
+    QVERIFY(manifest.open(QIODevice::ReadOnly | QIODevice::Text));
+    QString line = QString::fromUtf8(manifest.readLine()).trimmed();
+    QCOMPARE(line, QString("%1\tpos=2.500").arg(key.fileName("cached", "png")));
+}
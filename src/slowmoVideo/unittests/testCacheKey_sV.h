@@ -0,0 +1,16 @@
+#ifndef TESTCACHEKEY_SV_H
+#define TESTCACHEKEY_SV_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestCacheKey_sV : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testEqualInputs();
+    void testDifferentInputs();
+    void testManifest();
+};
+
+#endif // TESTCACHEKEY_SV_H
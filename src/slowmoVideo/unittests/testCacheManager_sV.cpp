@@ -0,0 +1,77 @@
+#include "testCacheManager_sV.h"
+
+#include "../project/project_sV.h"
+#include "../project/cacheManager_sV.h"
+
+namespace {
+QString writeFile(const QDir &dir, const QString &name, int bytes)
+{
+    QFile file(dir.absoluteFilePath(name));
+    file.open(QIODevice::WriteOnly);
+    file.write(QByteArray(bytes, 'x'));
+    file.close();
+    return file.fileName();
+}
+}
+
+void TestCacheManager_sV::testStatistics()
+{
+    QString projectDir = QDir::temp().absoluteFilePath("unittestCacheManager_sV");
+    Project_sV project(projectDir);
+    QDir dir = project.getDirectory("cache/motionBlurSmall");
+    QFile::remove(dir.absoluteFilePath("a.png"));
+    writeFile(dir, "a.png", 100);
+
+    QList<CacheManager_sV::DirectoryStats> stats = project.cacheManager()->statistics();
+    QCOMPARE(stats.size(), CacheManager_sV::directories().size());
+    for (int i = 0; i < stats.size(); i++) {
+        if (stats.at(i).name == "cache/motionBlurSmall") {
+            QVERIFY(stats.at(i).bytes >= 100);
+            QVERIFY(stats.at(i).evictable);
+        } else if (stats.at(i).name.startsWith("frames/")) {
+            QVERIFY(!stats.at(i).evictable);
+        }
+    }
+    QFile::remove(dir.absoluteFilePath("a.png"));
+}
+
+void TestCacheManager_sV::testPruneLFU()
+{
+    QString projectDir = QDir::temp().absoluteFilePath("unittestCacheManager_sV");
+    Project_sV project(projectDir);
+    CacheManager_sV *manager = project.cacheManager();
+    manager->prune(0);
+
+    QDir dir = project.getDirectory("cache/oFlowSmall");
+    QString a = writeFile(dir, "a.sVflow", 100);
+    QString b = writeFile(dir, "b.sVflow", 100);
+    manager->recordAccess(b);
+    manager->recordAccess(b);
+    QCOMPARE(manager->evictableSize(), qint64(200));
+
+    manager->setPolicy(CacheManager_sV::Policy_LFU);
+    QCOMPARE(manager->prune(150), 1);
+    QVERIFY(!QFileInfo(a).exists());
+    QVERIFY(QFileInfo(b).exists());
+
+    QCOMPARE(manager->prune(0), 1);
+    QCOMPARE(manager->evictableSize(), qint64(0));
+}
+
+void TestCacheManager_sV::testUpToDate()
+{
+    QDir dir(QDir::temp().absoluteFilePath("unittestCacheManager_sV"));
+    dir.mkpath(".");
+    QString cached = writeFile(dir, "derived.sVcons", 10);
+    // File times may only have a resolution of one second
+    QTest::qSleep(1100);
+    QString source = writeFile(dir, "source.sVflow", 10);
+    QString missing = dir.absoluteFilePath("missing.sVflow");
+    QFile::remove(missing);
+
+    QVERIFY(!CacheManager_sV::isUpToDate(cached, QStringList() << source));
+    QVERIFY(CacheManager_sV::isUpToDate(source, QStringList() << cached << missing));
+    QVERIFY(!CacheManager_sV::isUpToDate(missing, QStringList() << source));
+    QFile::remove(cached);
+    QFile::remove(source);
+}
@@ -0,0 +1,16 @@
+#ifndef TESTCACHEMANAGER_SV_H
+#define TESTCACHEMANAGER_SV_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestCacheManager_sV : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testStatistics();
+    void testPruneLFU();
+    void testUpToDate();
+};
+
+#endif // TESTCACHEMANAGER_SV_H
@@ -0,0 +1,123 @@
+#include "testConsistencyMap_sV.h"
+
+#include "../lib/consistencyMap_sV.h"
+#include "../lib/flowField_sV.h"
+
+static void fill(FlowField_sV &flow, float x, float y)
+{
+    for (int j = 0; j < flow.height(); j++) {
+        for (int i = 0; i < flow.width(); i++) {
+            flow.rx(i,j) = x;
+            flow.ry(i,j) = y;
+        }
+    }
+}
+
+void TestConsistencyMap_sV::testConsistentFlow()
+{
+    FlowField_sV forward(10, 6), backward(10, 6);
+    fill(forward, 2, 0);
+    fill(backward, -2, 0);
+
+    ConsistencyMap_sV *map = ConsistencyMap_sV::fromFlow(&forward, &backward);
+    QCOMPARE(map->width(), 10);
+    QCOMPARE(map->height(), 6);
+    for (int y = 0; y < 6; y++) {
+        for (int x = 0; x < 10; x++) {
+            // Pixels moving out of the frame have no counterpart in the other frame.
+            QCOMPARE(map->at(ConsistencyMap_sV::Frame_Left, x, y), (unsigned char) (x < 8 ? 255 : 0));
+            QCOMPARE(map->at(ConsistencyMap_sV::Frame_Right, x, y), (unsigned char) (x >= 2 ? 255 : 0));
+        }
+    }
+    delete map;
+}
+
+void TestConsistencyMap_sV::testInconsistentFlow()
+{
+    FlowField_sV forward(8, 4), backward(8, 4);
+    fill(forward, 0, 0);
+    fill(backward, 0, 0);
+    // Left pixel (2|1) claims to move right, the right frame does not agree.
+    forward.rx(2,1) = 1;
+    // Half the maximum error of 2 px
+    backward.ry(5,2) = 1;
+
+    ConsistencyMap_sV *map = ConsistencyMap_sV::fromFlow(&forward, &backward, 2);
+    QCOMPARE(map->at(ConsistencyMap_sV::Frame_Left, 2, 1), (unsigned char) 128);
+    QCOMPARE(map->at(ConsistencyMap_sV::Frame_Left, 3, 1), (unsigned char) 255);
+    QCOMPARE(map->at(ConsistencyMap_sV::Frame_Right, 5, 2), (unsigned char) 128);
+    QCOMPARE(map->at(ConsistencyMap_sV::Frame_Right, 3, 1), (unsigned char) 255);
+
+    // Beyond the maximum error
+    forward.rx(2,1) = 3;
+    delete map;
+    map = ConsistencyMap_sV::fromFlow(&forward, &backward, 2);
+    QCOMPARE(map->at(ConsistencyMap_sV::Frame_Left, 2, 1), (unsigned char) 0);
+    delete map;
+}
+
+void TestConsistencyMap_sV::testConfidence()
+{
+    ConsistencyMap_sV map(3, 2);
+    for (int y = 0; y < 2; y++) {
+        for (int x = 0; x < 3; x++) {
+            map.rat(ConsistencyMap_sV::Frame_Left, x, y) = 0;
+            map.rat(ConsistencyMap_sV::Frame_Right, x, y) = 255;
+        }
+    }
+    map.rat(ConsistencyMap_sV::Frame_Left, 2, 1) = 51;
+
+    QCOMPARE(map.confidence(ConsistencyMap_sV::Frame_Left, 1.7, 0.6), .2f);
+    QCOMPARE(map.confidence(ConsistencyMap_sV::Frame_Left, 1.4, 0.6), 0.0f);
+    // Clamped to the border
+    QCOMPARE(map.confidence(ConsistencyMap_sV::Frame_Left, 5, 9), .2f);
+    QCOMPARE(map.confidence(ConsistencyMap_sV::Frame_Right, -3, -1), 1.0f);
+}
+
+void TestConsistencyMap_sV::testReadWrite()
+{
+    ConsistencyMap_sV map(5, 3);
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 5; x++) {
+            map.rat(ConsistencyMap_sV::Frame_Left, x, y) = 10*x + y;
+            map.rat(ConsistencyMap_sV::Frame_Right, x, y) = 200 - x - y;
+        }
+    }
+    std::string path = QDir::temp().absoluteFilePath("unittestConsistencyMap_sV.sVcons").toStdString();
+    QVERIFY(map.save(path));
+
+    ConsistencyMap_sV *loaded = ConsistencyMap_sV::load(path);
+    QCOMPARE(loaded->width(), 5);
+    QCOMPARE(loaded->height(), 3);
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 5; x++) {
+            QCOMPARE(loaded->at(ConsistencyMap_sV::Frame_Left, x, y), map.at(ConsistencyMap_sV::Frame_Left, x, y));
+            QCOMPARE(loaded->at(ConsistencyMap_sV::Frame_Right, x, y), map.at(ConsistencyMap_sV::Frame_Right, x, y));
+        }
+    }
+    delete loaded;
+
+    bool thrown = false;
+    try {
+        ConsistencyMap_sV::load(QDir::temp().absoluteFilePath("unittestConsistencyMap_sV-missing").toStdString());
+    } catch (ConsistencyMap_sV::ConsistencyMapError &) {
+        thrown = true;
+    }
+    QVERIFY(thrown);
+
+    // Maps of another version are rejected
+    QFile file(QString::fromStdString(path));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(7));
+    QVERIFY(file.putChar(2));
+    file.close();
+    thrown = false;
+    try {
+        ConsistencyMap_sV::load(path);
+    } catch (ConsistencyMap_sV::ConsistencyMapError &) {
+        thrown = true;
+    }
+    QVERIFY(thrown);
+
+    QVERIFY(!map.save(QDir::temp().absoluteFilePath("unittestConsistencyMap_sV-missing/map.sVcons").toStdString()));
+}
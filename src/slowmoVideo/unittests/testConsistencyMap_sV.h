@@ -0,0 +1,17 @@
+#ifndef TESTCONSISTENCYMAP_SV_H
+#define TESTCONSISTENCYMAP_SV_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestConsistencyMap_sV : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testConsistentFlow();
+    void testInconsistentFlow();
+    void testConfidence();
+    void testReadWrite();
+};
+
+#endif // TESTCONSISTENCYMAP_SV_H
@@ -0,0 +1,82 @@
+#include "testCpuPyramid.h"
+
+#include "Base/v3d_cpupyramid.h"
+
+using namespace V3D;
+
+void TestCpuPyramid::testLevelSizes()
+{
+    CPU_PyramidWithDerivativesCreator pyramid;
+    pyramid.allocate(37, 23, 3, 2, 3);
+    QCOMPARE(pyramid.numberOfLevels(), 3);
+    QCOMPARE(pyramid.numberOfChannels(), 3);
+    QCOMPARE((int)pyramid.level(1).width(), 18);
+    QCOMPARE((int)pyramid.level(2).height(), 5);
+    QCOMPARE((int)pyramid.level(2).numChannels(), 9);
+}
+
+void TestCpuPyramid::testConstantImage()
+{
+    // Smoothing keeps constant images constant, also at the borders, and they have no gradient.
+    Image<float> image(20, 16, 2);
+    std::fill(image.begin(0), image.end(0), .5f);
+    std::fill(image.begin(1), image.end(1), 1.f);
+
+    CPU_PyramidWithDerivativesCreator pyramid;
+    pyramid.allocate(20, 16, 3, 3, 2);
+    pyramid.buildPyramidForImage(image);
+
+    for (int level = 0; level < 3; level++) {
+        int size = pyramid.width(level) * pyramid.height(level);
+        for (int i = 0; i < size; i++) {
+            QVERIFY(qAbs(pyramid.intensity(level, 0)[i] - 127.5f) < 1e-3);
+            QVERIFY(qAbs(pyramid.intensity(level, 1)[i] - 255.f) < 1e-3);
+            QVERIFY(qAbs(pyramid.gradientX(level, 1)[i]) < 1e-3);
+            QVERIFY(qAbs(pyramid.gradientY(level, 1)[i]) < 1e-3);
+        }
+    }
+}
+
+void TestCpuPyramid::testDerivatives()
+{
+    // I = 2x + 3y: central differences give the slope, one-sided differences at the border half of it.
+    const int w = 12, h = 10;
+    unsigned char image[w*h];
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            image[y*w+x] = 2*x + 3*y;
+        }
+    }
+
+    CPU_PyramidWithDerivativesCreator pyramid;
+    pyramid.allocate(w, h, 1);
+    pyramid.buildPyramidForGrayscaleImage(image);
+
+    QCOMPARE(pyramid.intensity(0)[4*w+5], 22.f);
+    QCOMPARE(pyramid.gradientX(0)[4*w+5], 2.f);
+    QCOMPARE(pyramid.gradientY(0)[4*w+5], 3.f);
+    QCOMPARE(pyramid.gradientX(0)[4*w+0], 1.f);
+    QCOMPARE(pyramid.gradientY(0)[(h-1)*w+5], 1.5f);
+}
+
+void TestCpuPyramid::testDownsampling()
+{
+    // A single bright pixel is spread with the kernel [1 3 3 1]/8 in both directions.
+    const int w = 16, h = 16;
+    unsigned char image[w*h];
+    std::fill(image, image+w*h, 0);
+    image[8*w+8] = 64;
+
+    CPU_PyramidWithDerivativesCreator pyramid;
+    pyramid.allocate(w, h, 2);
+    pyramid.buildPyramidForGrayscaleImage(image);
+
+    const float *level1 = pyramid.intensity(1);
+    const int w1 = pyramid.width(1);
+    // Output pixel i uses the pixels 2i-1 .. 2i+2, so pixel 8 has the weight 3 in output pixel 4
+    // and the weight 1 in output pixel 3.
+    QCOMPARE(level1[4*w1+4], 64*3*3/64.f);
+    QCOMPARE(level1[4*w1+3], 64*3*1/64.f);
+    QCOMPARE(level1[3*w1+3], 64*1*1/64.f);
+    QCOMPARE(level1[4*w1+5], 0.f);
+}
@@ -0,0 +1,17 @@
+#ifndef TESTCPUPYRAMID_H
+#define TESTCPUPYRAMID_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestCpuPyramid : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testLevelSizes();
+    void testConstantImage();
+    void testDerivatives();
+    void testDownsampling();
+};
+
+#endif // TESTCPUPYRAMID_H
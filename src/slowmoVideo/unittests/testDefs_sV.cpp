@@ -22,3 +22,22 @@ void TestDefs_sV::testFpsFloat()
     QVERIFY(fps.num == 30000);
     QVERIFY(fps.den == 1001);
 }
+
+void TestDefs_sV::testFpsFrames()
+{
+    Fps_sV fps(24000, 1001);
+    QVERIFY(fps.toFrame(0) == 0);
+    QVERIFY(fps.toFrame(1.001/24 * .5, false) == 0);
+    QVERIFY(fps.toFrame(1.001/24 * .5, true) == 1);
+    QVERIFY(fps.nearestFrame(1.001/24 * .4) == 0);
+    QVERIFY(fps.nearestFrame(1.001/24 * .6) == 1);
+
+    // No drift on long timelines (about 12 hours)
+    for (int64_t frame = 0; frame < 1000000; frame += 997) {
+        double time = fps.toTime(frame);
+        QVERIFY(fps.toFrame(time, false) == frame);
+        QVERIFY(fps.toFrame(time, true) == frame);
+        QVERIFY(fps.nearestFrame(time) == frame);
+    }
+    QVERIFY(fps.toTime(24000) == 1001);
+}
@@ -11,6 +11,7 @@ class TestDefs_sV : public QObject
 private slots:
     void testFpsInt();
     void testFpsFloat();
+    void testFpsFrames();
 };
 
 #endif // TESTDEFS_SV_H
@@ -0,0 +1,120 @@
+#include "testFloatImage_sV.h"
+
+#include "../lib/floatImage_sV.h"
+#include "../lib/shutter_sV.h"
+
+#include <stdint.h>
+
+void TestFloatImage_sV::testConversion()
+{
+    QImage img(13, 7, QImage::Format_ARGB32);
+    for (int y = 0; y < img.height(); y++) {
+        for (int x = 0; x < img.width(); x++) {
+            img.setPixel(x, y, qRgba(x*19, y*37, x*y, 255-x));
+        }
+    }
+    FloatImage_sV f = FloatImage_sV::fromImage(img);
+    QCOMPARE(f.size(), img.size());
+    QCOMPARE(f.at(FloatImage_sV::Channel_Red, 1, 0), 19/255.0f);
+    QCOMPARE(f.at(FloatImage_sV::Channel_Alpha, 1, 0), 254/255.0f);
+
+    // 8-bit values survive the round trip
+    QImage back = f.toImage();
+    for (int y = 0; y < img.height(); y++) {
+        for (int x = 0; x < img.width(); x++) {
+            QCOMPARE(back.pixel(x, y), img.pixel(x, y));
+        }
+    }
+
+    // Images without alpha channel are opaque
+    QImage rgb(4, 4, QImage::Format_RGB32);
+    rgb.fill(qRgb(1, 2, 3));
+    QCOMPARE(FloatImage_sV::fromImage(rgb).at(FloatImage_sV::Channel_Alpha, 2, 2), 1.0f);
+
+    // Values outside [0,1] are clamped
+    f.fill(2, -1, .5);
+    QCOMPARE(f.toImage().pixel(0, 0), qRgba(255, 0, 128, 255));
+}
+
+void TestFloatImage_sV::testAlignment()
+{
+    FloatImage_sV f(13, 7);
+    QVERIFY(f.stride() >= f.width());
+    QCOMPARE(int(f.stride()*sizeof(float)) % FloatImage_sV::ALIGNMENT, 0);
+    for (int c = 0; c < FloatImage_sV::CHANNELS; c++) {
+        for (int y = 0; y < f.height(); y++) {
+            QCOMPARE(int(uintptr_t(f.scanLine(FloatImage_sV::Channel(c), y)) % FloatImage_sV::ALIGNMENT), 0);
+        }
+    }
+
+    FloatImage_sV::Plane p = f.plane(FloatImage_sV::Channel_Green).sub(2, 3, 4, 2);
+    p.at(1, 1) = 42;
+    QCOMPARE(f.at(FloatImage_sV::Channel_Green, 3, 4), 42.0f);
+}
+
+void TestFloatImage_sV::testCopy()
+{
+    FloatImage_sV a(8, 8);
+    a.fill(.25, .5, .75);
+    FloatImage_sV b = a;
+    b.setPixel(0, 0, 1, 1, 1);
+    QCOMPARE(a.at(FloatImage_sV::Channel_Red, 0, 0), .25f);
+
+    FloatImage_sV c;
+    QVERIFY(c.isNull());
+    c = b;
+    QCOMPARE(c.at(FloatImage_sV::Channel_Red, 0, 0), 1.0f);
+    c = FloatImage_sV();
+    QVERIFY(c.isNull());
+
+    // Swapping exchanges the data
+    c.swap(a);
+    QVERIFY(a.isNull());
+    QCOMPARE(c.size(), QSize(8, 8));
+    QCOMPARE(c.at(FloatImage_sV::Channel_Blue, 7, 7), .75f);
+}
+
+void TestFloatImage_sV::testSample()
+{
+    FloatImage_sV f(4, 4);
+    f.fill(0, 0, 0, 1);
+    f.setPixel(1, 1, 1, 0, 0);
+    f.setPixel(2, 1, 0, 1, 0);
+
+    float rgba[4];
+    f.sample(1, 1, rgba);
+    QCOMPARE(rgba[0], 1.0f);
+    f.sample(1.5, 1, rgba);
+    QCOMPARE(rgba[0], .5f);
+    QCOMPARE(rgba[1], .5f);
+    QCOMPARE(rgba[3], 1.0f);
+    f.sample(1.5, 1.5, rgba);
+    QCOMPARE(rgba[0], .25f);
+}
+
+void TestFloatImage_sV::testCombine()
+{
+    QList<FloatImage_sV> images;
+    for (int i = 0; i < 3; i++) {
+        FloatImage_sV f(5, 3);
+        f.fill(i/255.0f, 1, 0);
+        images << f;
+    }
+    FloatImage_sV combined = Shutter_sV::combine(images);
+    // The average 1/255 is not rounded to 8 bits
+    QCOMPARE(combined.at(FloatImage_sV::Channel_Red, 4, 2), 1/255.0f);
+    QCOMPARE(combined.at(FloatImage_sV::Channel_Green, 4, 2), 1.0f);
+    QCOMPARE(combined.at(FloatImage_sV::Channel_Alpha, 0, 0), 1.0f);
+
+    // Adding them one by one gives the same result
+    Shutter_sV::Accumulator sum;
+    for (int i = 0; i < images.size(); i++) {
+        sum.add(images.at(i));
+    }
+    QCOMPARE(sum.count(), 3);
+    FloatImage_sV average = sum.average();
+    QCOMPARE(sum.count(), 0);
+    QCOMPARE(average.size(), combined.size());
+    QCOMPARE(average.at(FloatImage_sV::Channel_Red, 4, 2), 1/255.0f);
+    QCOMPARE(average.at(FloatImage_sV::Channel_Green, 1, 1), 1.0f);
+}
@@ -0,0 +1,18 @@
+#ifndef TESTFLOATIMAGE_SV_H
+#define TESTFLOATIMAGE_SV_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestFloatImage_sV : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testConversion();
+    void testAlignment();
+    void testCopy();
+    void testSample();
+    void testCombine();
+};
+
+#endif // TESTFLOATIMAGE_SV_H
@@ -2,6 +2,7 @@
 #include "../lib/flowField_sV.h"
 #include "../lib/flowTools_sV.h"
 
+#include <QtGui/QImage>
 #include <iostream>
 
 void TestFlowField_sV::slotTestConstructorOpenGL()
@@ -84,6 +85,148 @@ void TestFlowField_sV::slotTestMedian()
     delete outField;
 }
 
+void TestFlowField_sV::slotTestMedianInPlace()
+{
+    int values[] = { 0, 0, 0, 2 };
+    FlowField_sV f1(2,2);
+    initFlowField(&f1, values);
+    values[1] = 1; values[3] = 1;
+    FlowField_sV f2(2,2);
+    initFlowField(&f2, values);
+    values[1] = 2; values[2] = 1; values[3] = 0;
+    FlowField_sV f3(2,2);
+    initFlowField(&f3, values);
+
+    FlowField_sV *expected = FlowTools_sV::median(&f1, &f2, &f3);
+    FlowTools_sV::median(&f1, &f2, &f3, f1);
+    QVERIFY(f1 == *expected);
+    delete expected;
+}
+
+void TestFlowField_sV::slotTestMedianWindow()
+{
+    // Vector lengths per field at the four pixels; the median of five is the third shortest.
+    int lengths[5][4] = {
+        { 5, 0, 1, 3 },
+        { 1, 0, 2, 3 },
+        { 4, 7, 3, 3 },
+        { 2, 1, 4, 9 },
+        { 3, 2, 5, 0 }
+    };
+    int expected[] = { 3, 1, 3, 3 };
+
+    FlowField_sV *fields[5];
+    for (int k = 0; k < 5; k++) {
+        fields[k] = new FlowField_sV(2,2);
+        for (int i = 0; i < 4; i++) {
+            fields[k]->data()[2*i] = lengths[k][i];
+            fields[k]->data()[2*i+1] = 0;
+        }
+    }
+    FlowField_sV out(2,2);
+    FlowTools_sV::median(fields, 5, out);
+    for (int i = 0; i < 4; i++) {
+        QCOMPARE(out.data()[2*i], float(expected[i]));
+    }
+
+    // Three fields give the same result as the dedicated version
+    FlowField_sV *three = FlowTools_sV::median(fields[0], fields[2], fields[3]);
+    const FlowField_sV *subset[] = { fields[0], fields[2], fields[3] };
+    FlowTools_sV::median(subset, 3, out);
+    QVERIFY(out == *three);
+    delete three;
+
+    for (int k = 0; k < 5; k++) {
+        delete fields[k];
+    }
+}
+
+void TestFlowField_sV::slotTestDifference()
+{
+    FlowField_sV forward(3,1);
+    FlowField_sV backward(3,1);
+    FlowField_sV out(3,1);
+    // Pixel 0 moves to 1 and back by -1 (consistent), pixel 1 moves to 2 but only 0.5 back,
+    // pixel 2 points outside.
+    forward.rx(0,0) = 1;   forward.ry(0,0) = 0;
+    forward.rx(1,0) = 1;   forward.ry(1,0) = 0;
+    forward.rx(2,0) = 2;   forward.ry(2,0) = -1;
+    backward.rx(0,0) = 0;  backward.ry(0,0) = 0;
+    backward.rx(1,0) = -1; backward.ry(1,0) = 0;
+    backward.rx(2,0) = -.5; backward.ry(2,0) = 0;
+
+    FlowTools_sV::difference(forward, backward, out);
+    QCOMPARE(out.x(0,0), 0.0f);
+    QCOMPARE(out.x(1,0), .5f);
+    QCOMPARE(out.x(2,0), 2.0f);
+    QCOMPARE(out.y(2,0), -1.0f);
+
+    // The forward vector is longer at pixel 1, the outside vector is made absolute.
+    FlowTools_sV::signedDifference(forward, backward, out);
+    QCOMPARE(out.x(1,0), .5f);
+    QCOMPARE(out.x(2,0), 2.0f);
+    QCOMPARE(out.y(2,0), 1.0f);
+    FlowTools_sV::signedDifference(backward, forward, out);
+    QCOMPARE(out.x(2,0), -.5f);
+}
+
+void TestFlowField_sV::slotTestUpsampleConstant()
+{
+    FlowField_sV flow(8, 6);
+    for (int y = 0; y < flow.height(); y++) {
+        for (int x = 0; x < flow.width(); x++) {
+            flow.rx(x,y) = 1;
+            flow.ry(x,y) = -2;
+        }
+    }
+    QImage guide(31, 23, QImage::Format_RGB32);
+    for (int y = 0; y < guide.height(); y++) {
+        for (int x = 0; x < guide.width(); x++) {
+            guide.setPixel(x, y, qRgb(x*8, y*11, (x*y) % 256));
+        }
+    }
+
+    // A constant flow stays constant, scaled to the new size in each direction
+    FlowField_sV *out = FlowTools_sV::upsampleJointBilateral(flow, guide);
+    QCOMPARE(out->width(), 31);
+    QCOMPARE(out->height(), 23);
+    for (int y = 0; y < out->height(); y++) {
+        for (int x = 0; x < out->width(); x++) {
+            QVERIFY(fabs(out->x(x,y) - 31/8.0) < 1e-4);
+            QVERIFY(fabs(out->y(x,y) - -2*23/6.0) < 1e-4);
+        }
+    }
+    delete out;
+}
+
+void TestFlowField_sV::slotTestUpsampleEdge()
+{
+    // Dark left half moves right, bright right half moves left
+    FlowField_sV flow(8, 4);
+    for (int y = 0; y < flow.height(); y++) {
+        for (int x = 0; x < flow.width(); x++) {
+            flow.rx(x,y) = x < 4 ? 1 : -1;
+            flow.ry(x,y) = 0;
+        }
+    }
+    QImage guide(32, 16, QImage::Format_RGB32);
+    for (int y = 0; y < guide.height(); y++) {
+        for (int x = 0; x < guide.width(); x++) {
+            guide.setPixel(x, y, x < 16 ? qRgb(10, 20, 30) : qRgb(240, 230, 220));
+        }
+    }
+
+    // The flow edge follows the image edge instead of being blurred across it
+    FlowField_sV *out = FlowTools_sV::upsampleJointBilateral(flow, guide);
+    for (int y = 0; y < out->height(); y++) {
+        for (int x = 0; x < out->width(); x++) {
+            QVERIFY(fabs(out->x(x,y) - (x < 16 ? 4 : -4)) < 1e-3);
+            QVERIFY(fabs(out->y(x,y)) < 1e-3);
+        }
+    }
+    delete out;
+}
+
 void TestFlowField_sV::initFlowField(FlowField_sV *field, int *values)
 {
     int c = 0;
@@ -12,6 +12,11 @@ private slots:
     void slotTestConstructorOpenGL();
     void slotTestGaussKernel();
     void slotTestMedian();
+    void slotTestMedianInPlace();
+    void slotTestMedianWindow();
+    void slotTestDifference();
+    void slotTestUpsampleConstant();
+    void slotTestUpsampleEdge();
 private:
     void initFlowField(FlowField_sV *field, int *values);
 };
@@ -0,0 +1,170 @@
+#include "testFrameQueue_sV.h"
+
+#include "../project/frameQueue_sV.h"
+#include "../project/frameConsumerThread_sV.h"
+
+#include <QtCore/QList>
+
+/// Records frame numbers, and fails at a given frame
+class RecordingConsumer : public FrameConsumerThread_sV::Consumer
+{
+public:
+    RecordingConsumer(int failAt = -1, bool failAtBegin = false) :
+        failAt(failAt), failAtBegin(failAtBegin), begun(0), ended(0), endedFailed(false) {}
+    void beginConsuming() throw(Error_sV) {
+        begun++;
+        if (failAtBegin) {
+            throw Error_sV("Cannot begin");
+        }
+    }
+    void consumeQueuedFrame(const QImage &image, int frameNumber) throw(Error_sV) {
+        Q_UNUSED(image);
+        if (frameNumber == failAt) {
+            throw Error_sV("Cannot consume frame");
+        }
+        frames << frameNumber;
+    }
+    void endConsuming(bool failed) throw(Error_sV) {
+        ended++;
+        endedFailed = failed;
+    }
+    int failAt;
+    bool failAtBegin;
+    int begun;
+    int ended;
+    bool endedFailed;
+    QList<int> frames;
+};
+
+void TestFrameQueue_sV::testOrder()
+{
+    FrameQueue_sV queue(3);
+    QImage img(4, 4, QImage::Format_ARGB32);
+    QVERIFY(queue.push(img, 1));
+    QVERIFY(queue.push(img, 2));
+    QVERIFY(queue.push(img, 3));
+    QCOMPARE(queue.size(), 3);
+
+    FrameQueue_sV::Item item;
+    QVERIFY(queue.pop(item));
+    QCOMPARE(item.frameNumber, 1);
+    QCOMPARE(item.image.size(), img.size());
+    QVERIFY(queue.pop(item));
+    QCOMPARE(item.frameNumber, 2);
+    QCOMPARE(queue.size(), 1);
+}
+
+void TestFrameQueue_sV::testClose()
+{
+    FrameQueue_sV queue(2);
+    QImage img(4, 4, QImage::Format_ARGB32);
+    QVERIFY(queue.push(img, 1));
+    queue.close();
+    QVERIFY(queue.isClosed());
+    QVERIFY(!queue.push(img, 2));
+
+    // Remaining frames are still delivered after closing
+    FrameQueue_sV::Item item;
+    QVERIFY(queue.pop(item));
+    QCOMPARE(item.frameNumber, 1);
+    QVERIFY(!queue.pop(item));
+}
+
+void TestFrameQueue_sV::testConsumerThread()
+{
+    FrameQueue_sV queue(2);
+    RecordingConsumer consumer;
+    FrameConsumerThread_sV thread(&queue, &consumer);
+    thread.start();
+
+    QImage img(16, 16, QImage::Format_ARGB32);
+    for (int i = 0; i < 100; i++) {
+        QVERIFY(queue.push(img, i));
+        QVERIFY(queue.size() <= 2);
+    }
+    queue.close();
+    QVERIFY(thread.wait(10000));
+
+    QVERIFY(!thread.failed());
+    QCOMPARE(thread.framesConsumed(), 100);
+    QCOMPARE(consumer.frames.size(), 100);
+    for (int i = 0; i < 100; i++) {
+        QCOMPARE(consumer.frames.at(i), i);
+    }
+}
+
+void TestFrameQueue_sV::testConsumerError()
+{
+    FrameQueue_sV queue(2);
+    RecordingConsumer consumer(10);
+    FrameConsumerThread_sV thread(&queue, &consumer);
+    thread.start();
+
+    QImage img(16, 16, QImage::Format_ARGB32);
+    int pushed = 0;
+    for (int i = 0; i < 100; i++) {
+        if (!queue.push(img, i)) {
+            break;
+        }
+        pushed++;
+    }
+    QVERIFY(thread.wait(10000));
+
+    // The producer is not blocked after the consumer failed
+    QVERIFY(pushed < 100);
+    QVERIFY(thread.failed());
+    QCOMPARE(thread.errorMessage(), QString("Cannot consume frame"));
+    QCOMPARE(consumer.frames.size(), 10);
+}
+
+void TestFrameQueue_sV::testConsumerHooks()
+{
+    FrameQueue_sV queue(2);
+    RecordingConsumer consumer;
+    FrameConsumerThread_sV thread(&queue, &consumer);
+    thread.start();
+
+    QImage img(16, 16, QImage::Format_ARGB32);
+    for (int i = 0; i < 5; i++) {
+        QVERIFY(queue.push(img, i));
+    }
+    queue.close();
+    QVERIFY(thread.wait(10000));
+
+    QCOMPARE(consumer.begun, 1);
+    QCOMPARE(consumer.ended, 1);
+    QVERIFY(!consumer.endedFailed);
+
+    // Ending is also called if consuming failed
+    FrameQueue_sV queue2(2);
+    RecordingConsumer failing(2);
+    FrameConsumerThread_sV thread2(&queue2, &failing);
+    thread2.start();
+    for (int i = 0; i < 5; i++) {
+        if (!queue2.push(img, i)) {
+            break;
+        }
+    }
+    queue2.close();
+    QVERIFY(thread2.wait(10000));
+    QVERIFY(thread2.failed());
+    QCOMPARE(failing.ended, 1);
+    QVERIFY(failing.endedFailed);
+}
+
+void TestFrameQueue_sV::testConsumerBeginError()
+{
+    FrameQueue_sV queue(2);
+    RecordingConsumer consumer(-1, true);
+    FrameConsumerThread_sV thread(&queue, &consumer);
+    thread.start();
+    QVERIFY(thread.wait(10000));
+
+    QImage img(16, 16, QImage::Format_ARGB32);
+    QVERIFY(!queue.push(img, 0));
+    QVERIFY(thread.failed());
+    QCOMPARE(thread.errorMessage(), QString("Cannot begin"));
+    QCOMPARE(thread.framesConsumed(), 0);
+    QCOMPARE(consumer.ended, 1);
+    QVERIFY(consumer.endedFailed);
+}
@@ -0,0 +1,19 @@
+#ifndef TESTFRAMEQUEUE_SV_H
+#define TESTFRAMEQUEUE_SV_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestFrameQueue_sV : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testOrder();
+    void testClose();
+    void testConsumerThread();
+    void testConsumerError();
+    void testConsumerHooks();
+    void testConsumerBeginError();
+};
+
+#endif // TESTFRAMEQUEUE_SV_H
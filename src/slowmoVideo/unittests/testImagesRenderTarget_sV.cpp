@@ -0,0 +1,144 @@
+#include "testImagesRenderTarget_sV.h"
+
+#include "../project/imagesRenderTarget_sV.h"
+#include "../project/rawRenderTarget_sV.h"
+#include "../lib/floatImage_sV.h"
+
+#include <cstring>
+
+void TestImagesRenderTarget_sV::testWrite()
+{
+    QDir dir(QDir::temp().absoluteFilePath("unittestImagesRenderTarget_sV"));
+    const int n = 20;
+    for (int i = 0; i < n; i++) {
+        QFile::remove(dir.absoluteFilePath(QString("frame-%1.png").arg(i+1, 5, 10, QChar::fromAscii('0'))));
+    }
+
+    ImagesRenderTarget_sV target(NULL);
+    target.setTargetDir(dir);
+    target.setFilenamePattern("frame-%1.png");
+    target.setWriterThreads(3);
+    target.openRenderTarget();
+
+    QImage img(64, 48, QImage::Format_ARGB32);
+    for (int i = 0; i < n; i++) {
+        img.fill(qRgb(i, 255-i, 0));
+        target.slotConsumeFrame(img, i);
+    }
+    target.closeRenderTarget();
+
+    // All frames are written when the target has been closed
+    for (int i = 0; i < n; i++) {
+        QImage saved(dir.absoluteFilePath(QString("frame-%1.png").arg(i+1, 5, 10, QChar::fromAscii('0'))));
+        QCOMPARE(saved.size(), img.size());
+        QCOMPARE(saved.pixel(10, 10), qRgb(i, 255-i, 0));
+    }
+}
+
+void TestImagesRenderTarget_sV::testWriteError()
+{
+    ImagesRenderTarget_sV target(NULL);
+    target.setTargetDir(QDir::temp().absoluteFilePath("unittestImagesRenderTarget_sV"));
+    // No image writer for this format
+    target.setFilenamePattern("frame-%1.unknownImageFormat");
+    target.setWriterThreads(2);
+    target.openRenderTarget();
+
+    QImage img(16, 16, QImage::Format_ARGB32);
+    bool thrown = false;
+    try {
+        for (int i = 0; i < 100; i++) {
+            target.slotConsumeFrame(img, i);
+        }
+        target.closeRenderTarget();
+    } catch (Error_sV &err) {
+        thrown = true;
+        QVERIFY(err.message().contains("frame-"));
+    }
+    QVERIFY(thrown);
+}
+
+void TestImagesRenderTarget_sV::testRawEncode()
+{
+    QImage img(2, 2, QImage::Format_ARGB32);
+    img.setPixel(0, 0, qRgba(255, 0, 0, 255));
+    img.setPixel(1, 0, qRgba(0, 255, 0, 128));
+    img.setPixel(0, 1, qRgba(0, 0, 255, 0));
+    img.setPixel(1, 1, qRgba(1, 2, 3, 4));
+
+    QByteArray ppm = RawRenderTarget_sV::encode(img, RawRenderTarget_sV::Format_PPM16);
+    QByteArray header("P6\n2 2\n65535\n");
+    QVERIFY(ppm.startsWith(header));
+    QCOMPARE(ppm.size(), header.size() + 2*2*3*2);
+    const uchar *data = (const uchar*) ppm.constData() + header.size();
+    // First pixel: red, big endian
+    QCOMPARE(int(data[0]), 0xff);
+    QCOMPARE(int(data[1]), 0xff);
+    QCOMPARE(int(data[2]), 0);
+    // Last pixel, blue channel: 3*257
+    QCOMPARE(int(data[3*6+4]), (3*257) >> 8);
+    QCOMPARE(int(data[3*6+5]), (3*257) & 0xff);
+
+    QByteArray pam = RawRenderTarget_sV::encode(img, RawRenderTarget_sV::Format_PAM16);
+    int pamHeader = pam.indexOf("ENDHDR\n") + 7;
+    QVERIFY(pam.startsWith("P7\n"));
+    QCOMPARE(pam.size(), pamHeader + 2*2*4*2);
+    data = (const uchar*) pam.constData() + pamHeader;
+    // Alpha of the second pixel: 128*257
+    QCOMPARE(int(data[8+6]), (128*257) >> 8);
+    QCOMPARE(int(data[8+7]), (128*257) & 0xff);
+
+    QByteArray pfm = RawRenderTarget_sV::encode(img, RawRenderTarget_sV::Format_PFM);
+    int pfmHeader = pfm.indexOf("1.0\n") + 4;
+    QVERIFY(pfm.startsWith("PF\n2 2\n"));
+    QCOMPARE(pfm.size(), pfmHeader + 2*2*3*int(sizeof(float)));
+    float rgb[3];
+    // The first row in the file is the bottom row
+    memcpy(rgb, pfm.constData() + pfmHeader, sizeof(rgb));
+    QCOMPARE(rgb[0], 0.0f);
+    QCOMPARE(rgb[1], 0.0f);
+    QCOMPARE(rgb[2], 1.0f);
+}
+
+void TestImagesRenderTarget_sV::testRawFloat()
+{
+    // Between the 8-bit steps 100 and 101
+    const float value = 100.25f/255;
+    FloatImage_sV img(4, 3);
+    img.fill(value, 0, 1, .5f);
+
+    QDir dir(QDir::temp().absoluteFilePath("unittestImagesRenderTarget_sV"));
+    QString path = dir.absoluteFilePath("raw-00001.ppm");
+    QFile::remove(path);
+
+    RawRenderTarget_sV target(NULL);
+    target.setTargetDir(dir);
+    target.setFilenamePattern("raw-%1.ppm");
+    target.setFormat(RawRenderTarget_sV::Format_PPM16);
+    target.setWriterThreads(1);
+    target.openRenderTarget();
+    // Called like the render task does, through the base class
+    AbstractRenderTarget_sV *abstractTarget = &target;
+    abstractTarget->slotConsumeFrame(img, 0);
+    target.closeRenderTarget();
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray ppm = file.readAll();
+    QByteArray header("P6\n4 3\n65535\n");
+    QVERIFY(ppm.startsWith(header));
+    QCOMPARE(ppm.size(), header.size() + 4*3*3*2);
+    const uchar *data = (const uchar*) ppm.constData() + header.size();
+    // 100.25*257, not 100*257 as it would be after rounding to 8 bits
+    const int expected = qRound(100.25*257);
+    QVERIFY(expected != 100*257);
+    QCOMPARE(int(data[0]), expected >> 8);
+    QCOMPARE(int(data[1]), expected & 0xff);
+
+    QByteArray pfm = RawRenderTarget_sV::encode(img, RawRenderTarget_sV::Format_PFM);
+    int pfmHeader = pfm.indexOf("1.0\n") + 4;
+    float rgb[3];
+    memcpy(rgb, pfm.constData() + pfmHeader, sizeof(rgb));
+    QCOMPARE(rgb[0], value);
+    QCOMPARE(rgb[2], 1.0f);
+}
@@ -0,0 +1,17 @@
+#ifndef TESTIMAGESRENDERTARGET_SV_H
+#define TESTIMAGESRENDERTARGET_SV_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestImagesRenderTarget_sV : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testWrite();
+    void testWriteError();
+    void testRawEncode();
+    void testRawFloat();
+};
+
+#endif // TESTIMAGESRENDERTARGET_SV_H
@@ -21,3 +21,96 @@ void TestNodeList_sV::testCurveType()
     QVERIFY(nodes.at(1).rightCurveType() == CurveType_Linear);
     QVERIFY(nodes.at(2).rightCurveType() == CurveType_Bezier);
 }
+
+void TestNodeList_sV::testFind()
+{
+    NodeList_sV nodes(.1);
+    for (int i = 0; i < 1000; i++) {
+        nodes.add(Node_sV(.5*i + 1, .01*i));
+    }
+    QCOMPARE(nodes.size(), 1000);
+
+    QCOMPARE(nodes.find(0), -1);
+    QCOMPARE(nodes.find(.99), -1);
+    QCOMPARE(nodes.find(1), 0);
+    QCOMPARE(nodes.find(1.2), 0);
+    QCOMPARE(nodes.find(1000), 999);
+
+    // Sequential access (uses the hint)
+    int hint = 0;
+    for (int i = 0; i < 999; i++) {
+        QCOMPARE(nodes.find(.5*i + 1, &hint), i);
+        QCOMPARE(nodes.find(.5*i + 1.25, &hint), i);
+        QCOMPARE(hint, i);
+    }
+    // Random access, with a hint that is mostly stale
+    for (int i = 998; i >= 0; i -= 37) {
+        QCOMPARE(nodes.find(.5*i + 1.49, &hint), i);
+        QCOMPARE(nodes.find(.5*(998-i) + 1.01, &hint), 998-i);
+        QCOMPARE(nodes.find(.5*i + 1.49), i);
+    }
+}
+
+void TestNodeList_sV::testFindBySegment()
+{
+    NodeList_sV nodes(.1);
+    for (int i = 0; i < 100; i++) {
+        nodes.add(Node_sV(i, .01*i));
+    }
+
+    int left, right;
+    nodes.findBySegment(-1, left, right);
+    QCOMPARE(left, -1);
+    QCOMPARE(right, 0);
+    nodes.findBySegment(42.5, left, right);
+    QCOMPARE(left, 42);
+    QCOMPARE(right, 43);
+    nodes.findBySegment(42, left, right);
+    QCOMPARE(left, 42);
+    QCOMPARE(right, 43);
+    nodes.findBySegment(200, left, right);
+    QCOMPARE(left, 99);
+    QCOMPARE(right, -1);
+}
+
+void TestNodeList_sV::testNodeAfter()
+{
+    NodeList_sV nodes(.1);
+    QCOMPARE(nodes.nodeAfter(0), -1);
+    for (int i = 0; i < 100; i++) {
+        nodes.add(Node_sV(i, .01*i));
+    }
+
+    QCOMPARE(nodes.nodeAfter(-5), 0);
+    QCOMPARE(nodes.nodeAfter(0), 0);
+    QCOMPARE(nodes.nodeAfter(.5), 1);
+    QCOMPARE(nodes.nodeAfter(42), 42);
+    QCOMPARE(nodes.nodeAfter(41.9), 42);
+    QCOMPARE(nodes.nodeAfter(99), 99);
+    QCOMPARE(nodes.nodeAfter(99.1), -1);
+}
+
+void TestNodeList_sV::testObjectsNear()
+{
+    NodeList_sV nodes(.1);
+    for (int i = 0; i < 500; i++) {
+        nodes.add(Node_sV(i, .01*i));
+    }
+
+    QList<NodeList_sV::PointerWithDistance> objects = nodes.objectsNear(QPointF(250, 2.5), .2);
+    QCOMPARE(objects.size(), 1);
+    QVERIFY(objects.at(0).ptr == &nodes.at(250));
+    QCOMPARE(objects.at(0).type, NodeList_sV::PointerWithDistance::Node);
+
+    objects = nodes.objectsNear(QPointF(250.5, 2.505), .2);
+    QCOMPARE(objects.size(), 1);
+    QCOMPARE(objects.at(0).type, NodeList_sV::PointerWithDistance::Segment);
+    QVERIFY(objects.at(0).ptr == &nodes.segments()->at(250));
+
+    // Larger radius: nodes 250 and 251 are within reach as well
+    objects = nodes.objectsNear(QPointF(250.5, 2.505), 1);
+    QCOMPARE(objects.size(), 3);
+    QCOMPARE(objects.at(0).type, NodeList_sV::PointerWithDistance::Node);
+    QCOMPARE(objects.at(1).type, NodeList_sV::PointerWithDistance::Node);
+    QCOMPARE(objects.at(2).type, NodeList_sV::PointerWithDistance::Segment);
+}
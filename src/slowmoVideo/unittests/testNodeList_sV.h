@@ -9,6 +9,10 @@ class TestNodeList_sV : public QObject
     Q_OBJECT
 private slots:
     void testCurveType();
+    void testFind();
+    void testFindBySegment();
+    void testNodeAfter();
+    void testObjectsNear();
 };
 
 #endif // TESTNODELIST_SV_H
@@ -0,0 +1,82 @@
+#include "testProfiler_sV.h"
+
+#include "../lib/profiler_sV.h"
+
+void TestProfiler_sV::testSummary()
+{
+    Profiler_sV profiler;
+    profiler.setEnabled(true);
+    for (int i = 20; i > 0; i--) {
+        profiler.add(Profiler_sV::Stage_Decode, i);
+        profiler.endFrame();
+    }
+    QList<Profiler_sV::StageSummary> summary = profiler.summary();
+    QCOMPARE(summary.size(), 1);
+    QCOMPARE(summary.at(0).stage, Profiler_sV::Stage_Decode);
+    QCOMPARE(summary.at(0).frames, 20);
+    QCOMPARE(summary.at(0).min, 1.0);
+    QCOMPARE(summary.at(0).max, 20.0);
+    QCOMPARE(summary.at(0).mean, 10.5);
+    QCOMPARE(summary.at(0).p95, 19.0);
+    QCOMPARE(summary.at(0).total, 210.0);
+}
+
+void TestProfiler_sV::testFrames()
+{
+    Profiler_sV profiler;
+    profiler.setEnabled(true);
+
+    // Calls within a frame are summed up
+    profiler.add(Profiler_sV::Stage_Inpaint, 1);
+    profiler.add(Profiler_sV::Stage_Inpaint, 2);
+    profiler.endFrame();
+    // Frames without the stage are not counted for it
+    profiler.add(Profiler_sV::Stage_Blur, 5);
+    profiler.endFrame();
+
+    QCOMPARE(profiler.frames(), 2);
+    QList<Profiler_sV::StageSummary> summary = profiler.summary();
+    QCOMPARE(summary.size(), 2);
+    QCOMPARE(summary.at(0).stage, Profiler_sV::Stage_Inpaint);
+    QCOMPARE(summary.at(0).frames, 1);
+    QCOMPARE(summary.at(0).calls, 2);
+    QCOMPARE(summary.at(0).mean, 3.0);
+    QCOMPARE(summary.at(1).stage, Profiler_sV::Stage_Blur);
+    QCOMPARE(summary.at(1).frames, 1);
+
+    profiler.reset();
+    QCOMPARE(profiler.frames(), 0);
+    QCOMPARE(profiler.summary().size(), 0);
+}
+
+void TestProfiler_sV::testDisabled()
+{
+    Profiler_sV profiler;
+    {
+        Profiler_sV::Timer timer(Profiler_sV::Stage_Frame, &profiler);
+    }
+    profiler.endFrame();
+    QCOMPARE(profiler.frames(), 0);
+    QCOMPARE(profiler.summary().size(), 0);
+
+    profiler.setEnabled(true);
+    {
+        Profiler_sV::Timer timer(Profiler_sV::Stage_Frame, &profiler);
+    }
+    profiler.endFrame();
+    QCOMPARE(profiler.summary().size(), 1);
+    QVERIFY(profiler.summary().at(0).min >= 0);
+}
+
+void TestProfiler_sV::testJson()
+{
+    Profiler_sV profiler;
+    profiler.setEnabled(true);
+    profiler.add(Profiler_sV::Stage_FlowLoad, 1.5);
+    profiler.endFrame();
+
+    QString json = profiler.toJson();
+    QVERIFY(json.contains("\"frames\": 1,"));
+    QVERIFY(json.contains("{\"stage\": \"flowLoad\", \"frames\": 1, \"calls\": 1, \"min_ms\": 1.500,"));
+    QVERIFY(json.contains("\"p95_ms\": 1.500"));
+}
@@ -0,0 +1,17 @@
+#ifndef TESTPROFILER_SV_H
+#define TESTPROFILER_SV_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class TestProfiler_sV : public QObject
+{
+    Q_OBJECT
+private slots:
+    void testSummary();
+    void testFrames();
+    void testDisabled();
+    void testJson();
+};
+
+#endif // TESTPROFILER_SV_H
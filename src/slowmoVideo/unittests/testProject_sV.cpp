@@ -24,6 +24,13 @@ void TestProject_sV::slotTestSnapInFrames()
     pos = Project_sV::snapToFrame(0.49, true, fps, &framesBefore);
     QVERIFY(pos == (float).5);
     QVERIFY(framesBefore == 5);
+
+    // Long time: no accumulated error
+    qreal exact = Project_sV::snapToFrame(36000.05, false, fps, &framesBefore);
+    QVERIFY(exact == 36000);
+    QVERIFY(framesBefore == 360000);
+    exact = Project_sV::snapToFrame(36000.1, true, fps, &framesBefore);
+    QVERIFY(framesBefore == 360001);
 }
 
 void TestProject_sV::init()
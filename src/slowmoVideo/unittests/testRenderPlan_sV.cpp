@@ -0,0 +1,67 @@
+#include "testRenderPlan_sV.h"
+
+#include "../project/project_sV.h"
+#include "../project/renderPlan_sV.h"
+#include "../project/shutterFunction_sV.h"
+#include "../project/shutterFunctionList_sV.h"
+
+#include <cmath>
+
+void TestRenderPlan_sV::init()
+{
+    m_project = new Project_sV();
+    m_project->nodes()->add(Node_sV(0, 0));
+    m_project->nodes()->add(Node_sV(2, 1));
+    m_project->nodes()->add(Node_sV(4, 3));
+}
+
+void TestRenderPlan_sV::cleanup()
+{
+    delete m_project;
+}
+
+void TestRenderPlan_sV::testRange()
+{
+    RenderPlan_sV plan(m_project, 0, 4, Fps_sV(10, 1));
+    QCOMPARE(plan.firstFrame(), 0);
+    QCOMPARE(plan.lastFrame(), 40);
+    QVERIFY(plan.frameAt(-1) == NULL);
+    QVERIFY(plan.frameAt(41) == NULL);
+
+    // Slope .5 in the first segment, 1 in the second one
+    QVERIFY(fabs(plan.frameAt(0)->dy - .05) < .0001);
+    QVERIFY(fabs(plan.frameAt(0)->replaySpeed - .5) < .0001);
+    QVERIFY(fabs(plan.frameAt(40)->dy - .1) < .0001);
+    QVERIFY(fabs(plan.frameAt(40)->sourceTime - 3) < .0001);
+    QCOMPARE(plan.frameAt(40)->leftNode, 1);
+
+    RenderPlan_sV part(m_project, 1.05, 2.5, Fps_sV(10, 1));
+    QCOMPARE(part.firstFrame(), 10);
+    QCOMPARE(part.lastFrame(), 25);
+}
+
+void TestRenderPlan_sV::testMatchesSingleFrames()
+{
+    Fps_sV fps(24, 1);
+    RenderPlan_sV plan(m_project, 0, 4, fps);
+    for (int i = plan.firstFrame(); i <= plan.lastFrame(); i++) {
+        const RenderPlan_sV::Frame *planned = plan.frameAt(i);
+        RenderPlan_sV::Frame single = RenderPlan_sV::planFrame(m_project, planned->outTime, fps);
+        QCOMPARE(single.frameNumber, i);
+        QVERIFY(fabs(single.sourceFrame - planned->sourceFrame) < .0001);
+        QVERIFY(fabs(single.dy - planned->dy) < .0001);
+        QCOMPARE(single.leftNode, planned->leftNode);
+    }
+}
+
+void TestRenderPlan_sV::testShutter()
+{
+    ShutterFunction_sV *function = m_project->shutterFunctions()->addFunction(ShutterFunction_sV("return dy;"), true);
+    (*m_project->nodes())[0].setShutterFunctionID(function->id());
+
+    RenderPlan_sV plan(m_project, 0, 4, Fps_sV(10, 1));
+    QVERIFY(plan.frameAt(5)->hasShutter);
+    QVERIFY(fabs(plan.frameAt(5)->shutter - plan.frameAt(5)->dy) < .0001);
+    QVERIFY(!plan.frameAt(30)->hasShutter);
+    QCOMPARE(plan.toCsv().count('\n'), plan.size()+1);
+}
@@ -0,0 +1,23 @@
+#ifndef TESTRENDERPLAN_SV_H
+#define TESTRENDERPLAN_SV_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+class Project_sV;
+
+class TestRenderPlan_sV : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+    void cleanup();
+    void testRange();
+    void testMatchesSingleFrames();
+    void testShutter();
+
+private:
+    Project_sV *m_project;
+};
+
+#endif // TESTRENDERPLAN_SV_H
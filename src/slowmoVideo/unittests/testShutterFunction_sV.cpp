@@ -62,3 +62,44 @@ void TestShutterFunction_sV::testWithVariables()
         QVERIFY(fabs(speed-qsc) < .0001);
     }
 }
+
+void TestShutterFunction_sV::testNativeCompilation()
+{
+    ShutterFunction_sV f;
+    QVERIFY(f.isNative());
+
+    f.updateFunction("var dx = 1/fps; \n"
+                     "var speed = dy/dx;\n"
+                     "if (speed < 1) { speed = 0; }\n"
+                     "return speed;");
+    QVERIFY(f.isNative());
+
+    f.updateFunction("var s = 0; for (var i = 0; i < 3; i++) { s += x; } return s;");
+    QVERIFY(!f.isNative());
+    QVERIFY(fabs(f.evaluate(.5, 0, 24, 0, 0) - 1.5) < .0001);
+
+    // QtScript would return "true", which is not a number
+    f.updateFunction("return x < 1;");
+    QVERIFY(!f.isNative());
+    QVERIFY(f.evaluate(.5, 0, 24, 0, 0) == 0);
+}
+
+void TestShutterFunction_sV::testNativeMatchesScript()
+{
+    QStringList functions;
+    functions << "return Math.sin(x*Math.PI);"
+              << "return Math.pow(x, 2)+t"
+              << "return x > .5 ? dy*fps : Math.max(x, t, .25) % .2;"
+              << "// comment\nvar a = x, b = -t; /* block\ncomment */ a *= 2; return (a && b) || Math.round(y);"
+              << "if (dy*fps < 1) return 0\nelse if (x == .5) { return 1; } else return Math.abs(Math.floor(-y)) / 3;"
+              << "return 1e39;";
+    for (int i = 0; i < functions.size(); i++) {
+        ShutterFunction_sV f(functions.at(i));
+        QVERIFY(f.isNative());
+        for (float x = 0; x <= 1; x += .125) {
+            float native = f.evaluate(x, x/2, 24, 10*x, x/24);
+            float script = f.evaluateScript(x, x/2, 24, 10*x, x/24);
+            QVERIFY(fabs(native - script) < .0001);
+        }
+    }
+}
@@ -15,6 +15,8 @@ private slots:
     void testZeroFunction();
     void testFunctions();
     void testWithVariables();
+    void testNativeCompilation();
+    void testNativeMatchesScript();
 
 private:
     QCoreApplication *app;